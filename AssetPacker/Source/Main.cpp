@@ -0,0 +1,96 @@
+#include <Engine/Core/Core.hpp>
+#include <Engine/Core/Logging.hpp>
+#include <Engine/Core/ThreadPool.hpp>
+#include <Engine/IO/AssetPack.hpp>
+
+#include <chrono>
+#include <filesystem>
+
+using namespace Yuki;
+
+// Already compressed, LZ4 won't get anything out of them
+static bool IsCompressedFormat(const std::filesystem::path& filepath)
+{
+	auto extension = AssetPack::NormalizePath(filepath.extension().string());
+	return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+}
+
+// Packs every file in the input directories, assets are named by their path relative to the directory they're in.
+// Usage: AssetPacker [--no-compress] <output pack> <input directory>...
+int main(int argc, char* argv[])
+{
+	bool compress = true;
+	std::vector<std::filesystem::path> arguments;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string_view(argv[i]) == "--no-compress")
+		{
+			compress = false;
+			continue;
+		}
+
+		arguments.emplace_back(argv[i]);
+	}
+
+	if (arguments.size() < 2)
+	{
+		WriteLine("Usage: AssetPacker [--no-compress] <output pack> <input directory>...", LogLevel::Error);
+		return 1;
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	const auto& outputPath = arguments[0];
+	AssetPackWriter writer;
+	uint64_t inputBytes = 0;
+
+	for (uint32_t i = 1; i < arguments.size(); i++)
+	{
+		const auto& directory = arguments[i];
+
+		std::error_code error;
+		std::filesystem::recursive_directory_iterator iterator(directory, error);
+
+		if (error)
+		{
+			WriteLine("Can't read input directory {}, {}.", LogLevel::Error, directory.string(), error.message());
+			return 1;
+		}
+
+		for (const auto& entry : iterator)
+		{
+			// NOTE(Peter): The pack may be written into one of the input directories
+			if (!entry.is_regular_file() || std::filesystem::equivalent(entry.path(), outputPath, error))
+			{
+				continue;
+			}
+
+			auto path = entry.path().lexically_relative(directory).generic_string();
+
+			if (!writer.AddFile(entry.path(), path, compress && !IsCompressedFormat(entry.path())))
+			{
+				WriteLine("Can't read {}.", LogLevel::Error, entry.path().string());
+				return 1;
+			}
+
+			inputBytes += entry.file_size(error);
+		}
+	}
+
+	ThreadPool threadPool;
+
+	if (!writer.Write(outputPath, &threadPool))
+	{
+		return 1;
+	}
+
+	std::error_code error;
+	auto outputBytes = std::filesystem::file_size(outputPath, error);
+	auto seconds = std::chrono::duration<float64_t>(std::chrono::steady_clock::now() - startTime).count();
+
+	WriteLine("Packed {} assets into {}, {:.1f} MB down to {:.1f} MB in {:.2f} s", writer.GetEntryCount(), outputPath.string(),
+		inputBytes / (1024.0 * 1024.0), outputBytes / (1024.0 * 1024.0), seconds);
+
+	return 0;
+}
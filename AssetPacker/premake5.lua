@@ -0,0 +1,35 @@
+local GRDK = os.getenv("GRDKLatest");
+
+project "AssetPacker"
+	kind "ConsoleApp"
+
+	warnings "Extra"
+
+	files {
+		"Source/**.cpp",
+		"Source/**.hpp",
+	}
+
+	externalincludedirs {
+		"../Yuki/Source/",
+		"../ThirdParty/Aura/Aura/Include/"
+	}
+
+	links {
+		"Yuki",
+	}
+
+	filter { "system:windows" }
+		defines {
+			"YUKI_PLATFORM_WINDOWS"
+		}
+
+		libdirs {
+			GRDK .. "/GameKit/Lib/amd64/",
+			"../ThirdParty/DXC/lib/x64/"
+		}
+
+		links {
+			"GameInput",
+			"xgameruntime",
+		}
@@ -0,0 +1,25 @@
+#version 460
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Fragment shader for BatchRenderer, textured quads ignore their vertex color
+
+layout(set = 0, binding = 0) uniform texture2D Textures[];
+layout(set = 0, binding = 1) uniform sampler Samplers[];
+
+layout(location = 0) in vec4 inColor;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) flat in uint inTexture;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	if (inTexture == ~0u)
+	{
+		outColor = inColor;
+		return;
+	}
+
+	outColor = texture(sampler2D(Textures[nonuniformEXT(inTexture)], Samplers[0]), inUV);
+}
@@ -0,0 +1,89 @@
+#version 460
+
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_scalar_block_layout : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+
+// Vertex shader for BatchRenderer, pulls the vertices through their buffer address and decodes them based on BatchVertexFormat
+
+#define VERTEX_FORMAT_FULL 0
+#define VERTEX_FORMAT_COMPACT_HALF 1
+#define VERTEX_FORMAT_COMPACT_FIXED 2
+
+// BatchedVertex, 28 bytes
+struct FullVertex
+{
+	vec2 Position;
+	float Depth;
+	vec2 UV;
+	uint Color;
+	uint Texture;
+};
+
+// CompactBatchedVertex, 16 bytes
+struct CompactVertex
+{
+	// 2x half-float or 2x signed 12.4 fixed-point
+	uint Position;
+	// Unorm16 depth in the low half, the texture index in the high half
+	uint DepthTexture;
+	// 2x Unorm16
+	uint UV;
+	uint Color;
+};
+
+layout(buffer_reference, scalar) readonly buffer FullVertices { FullVertex Vertices[]; };
+layout(buffer_reference, scalar) readonly buffer CompactVertices { CompactVertex Vertices[]; };
+
+layout(push_constant, scalar) uniform PushConstants
+{
+	mat4 ViewProjection;
+	uint64_t Vertices;
+	uint VertexFormat;
+} PC;
+
+layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec2 outUV;
+layout(location = 2) flat out uint outTexture;
+
+vec2 UnpackFixed12x4(uint value)
+{
+	// Shifting the signed value back down sign-extends each 16-bit half
+	int x = int(value << 16) >> 16;
+	int y = int(value) >> 16;
+	return vec2(x, y) / 16.0;
+}
+
+void main()
+{
+	vec2 position;
+	float depth;
+	uint color;
+
+	if (PC.VertexFormat == VERTEX_FORMAT_FULL)
+	{
+		FullVertex vertex = FullVertices(PC.Vertices).Vertices[gl_VertexIndex];
+		position = vertex.Position;
+		depth = vertex.Depth;
+		outUV = vertex.UV;
+		color = vertex.Color;
+		outTexture = vertex.Texture;
+	}
+	else
+	{
+		CompactVertex vertex = CompactVertices(PC.Vertices).Vertices[gl_VertexIndex];
+		position = PC.VertexFormat == VERTEX_FORMAT_COMPACT_HALF ? unpackHalf2x16(vertex.Position) : UnpackFixed12x4(vertex.Position);
+		depth = float(vertex.DepthTexture & 0xFFFF) / 65535.0;
+		outUV = unpackUnorm2x16(vertex.UV);
+		color = vertex.Color;
+
+		uint textureIndex = vertex.DepthTexture >> 16;
+		outTexture = textureIndex == 0xFFFF ? ~0u : textureIndex;
+	}
+
+	outColor = unpackUnorm4x8(color);
+
+	// Depth is written as is, it's [0, 1] with 0 being closest to the camera
+	gl_Position = PC.ViewProjection * vec4(position, 0.0, 1.0);
+	gl_Position.z = depth * gl_Position.w;
+}
@@ -17,9 +17,18 @@ project "EngineTester"
 
 	links {
 		"Yuki",
-        "Yuki-Vulkan"
 	}
 
+	filter { "options:rhi=vulkan" }
+		links {
+			"Yuki-Vulkan"
+		}
+
+	filter { "options:rhi=null" }
+		links {
+			"Yuki-Null"
+		}
+
 	filter { "system:windows" }
 		defines {
 			"YUKI_PLATFORM_WINDOWS"
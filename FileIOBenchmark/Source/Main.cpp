@@ -0,0 +1,183 @@
+#include <Engine/Core/Core.hpp>
+#include <Engine/Core/Logging.hpp>
+#include <Engine/IO/FileIO.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <unordered_set>
+
+using namespace Yuki;
+
+// Loads a generated tree of shader headers the way the shader compiler does: every #include loads the file again, but
+// include guards stop the same header from being expanded twice. Compares how the file is read, nothing else.
+// Usage: FileIOBenchmark [header count] [includes per header] [kilobytes per header] [iterations]
+
+struct TreeSettings
+{
+	uint32_t HeaderCount = 2000;
+	uint32_t IncludesPerHeader = 8;
+	uint32_t HeaderSize = 16 * 1024;
+	uint32_t Iterations = 10;
+};
+
+// Header i includes headers that come after it, so the tree has no cycles and the root reaches all of them
+static void GenerateTree(const std::filesystem::path& directory, const TreeSettings& settings)
+{
+	std::filesystem::create_directories(directory);
+
+	for (uint32_t i = 0; i < settings.HeaderCount; i++)
+	{
+		std::string text = std::format("#ifndef HEADER_{0}\n#define HEADER_{0}\n", i);
+
+		for (uint32_t j = 1; j <= settings.IncludesPerHeader; j++)
+		{
+			uint32_t include = i + j * (i % 7 + 1);
+
+			if (include < settings.HeaderCount)
+			{
+				text += std::format("#include \"Header{}.glsl\"\n", include);
+			}
+		}
+
+		while (text.size() < settings.HeaderSize)
+		{
+			text += std::format("vec4 Function{}_{}(vec4 value) {{ return value * {}.0 + vec4(0.5); }}\n", i, text.size(), i);
+		}
+
+		text += "#endif\n";
+		FileIO::WriteText(directory / std::format("Header{}.glsl", i), text);
+	}
+}
+
+// What FileIO::ReadText used to do, kept as the baseline
+static bool ReadTextStream(const std::filesystem::path& filepath, std::string& outString)
+{
+	std::ifstream stream(filepath);
+
+	if (!stream)
+	{
+		return false;
+	}
+
+	std::stringstream str;
+	str << stream.rdbuf();
+	outString = str.str();
+	return true;
+}
+
+// Calls load for every #include in the tree, load returns the text of the file
+static uint64_t WalkTree(const std::filesystem::path& directory, const std::function<std::string_view(const std::filesystem::path&)>& load)
+{
+	std::unordered_set<std::string> expanded;
+	std::vector<std::string> pending = { "Header0.glsl" };
+	uint64_t bytes = 0;
+
+	while (!pending.empty())
+	{
+		auto name = std::move(pending.back());
+		pending.pop_back();
+
+		auto text = load(directory / name);
+		bytes += text.size();
+
+		if (!expanded.insert(name).second)
+		{
+			continue;
+		}
+
+		for (size_t position = text.find("#include \""); position != std::string_view::npos; position = text.find("#include \"", position + 1))
+		{
+			size_t start = position + 10;
+			pending.emplace_back(text.substr(start, text.find('"', start) - start));
+		}
+	}
+
+	return bytes;
+}
+
+int main(int argc, char* argv[])
+{
+	TreeSettings settings;
+	uint32_t* values[] = { &settings.HeaderCount, &settings.IncludesPerHeader, &settings.HeaderSize, &settings.Iterations };
+
+	for (int i = 1; i < argc && i <= 4; i++)
+	{
+		*values[i - 1] = static_cast<uint32_t>(std::stoul(argv[i])) * (i == 3 ? 1024 : 1);
+	}
+
+	auto directory = std::filesystem::temp_directory_path() / "YukiFileIOBenchmark";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	GenerateTree(directory, settings);
+
+	auto run = [&](std::string_view name, const std::function<std::string_view(const std::filesystem::path&)>& load)
+	{
+		// Warms the OS file cache, the benchmark is about the copies after the data is in memory
+		uint64_t bytes = WalkTree(directory, load);
+
+		auto startTime = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < settings.Iterations; i++)
+		{
+			WalkTree(directory, load);
+		}
+
+		auto seconds = std::chrono::duration<float64_t>(std::chrono::steady_clock::now() - startTime).count() / settings.Iterations;
+		WriteLine("{:<28} {:8.2f} ms {:10.1f} MB/s", name, seconds * 1000.0, bytes / (1024.0 * 1024.0) / seconds);
+	};
+
+	WriteLine("{} headers, {} includes each, {} KB each", settings.HeaderCount, settings.IncludesPerHeader, settings.HeaderSize / 1024);
+
+	std::string text;
+	std::vector<std::byte> binary;
+	FileIO::MappedFile mappedFile;
+	std::unordered_map<std::string, FileIO::MappedFile> mappedFiles;
+
+	run("ifstream + stringstream", [&](const std::filesystem::path& filepath)
+	{
+		ReadTextStream(filepath, text);
+		return std::string_view(text);
+	});
+
+	run("FileIO::ReadText", [&](const std::filesystem::path& filepath)
+	{
+		FileIO::ReadText(filepath, text);
+		return std::string_view(text);
+	});
+
+	run("FileIO::ReadBinary", [&](const std::filesystem::path& filepath)
+	{
+		FileIO::ReadBinary(filepath, binary);
+		return std::string_view(reinterpret_cast<const char*>(binary.data()), binary.size());
+	});
+
+	run("FileIO::MapFile", [&](const std::filesystem::path& filepath)
+	{
+		mappedFile = FileIO::MapFile(filepath);
+		return mappedFile.GetText();
+	});
+
+	// What the shader compiler's includer does, each header is mapped once per shader
+	run("FileIO::MapFile, cached", [&](const std::filesystem::path& filepath)
+	{
+		// Nothing includes the root, so loading it means a new shader is being compiled
+		if (filepath.filename() == "Header0.glsl")
+		{
+			mappedFiles.clear();
+		}
+
+		auto [it, inserted] = mappedFiles.try_emplace(filepath.string());
+
+		if (inserted)
+		{
+			it->second = FileIO::MapFile(filepath);
+		}
+
+		return it->second.GetText();
+	});
+
+	std::filesystem::remove_all(directory, error);
+	return 0;
+}
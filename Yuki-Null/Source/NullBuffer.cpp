@@ -0,0 +1,59 @@
+#include "NullRHI.hpp"
+
+#include <cstring>
+
+namespace Yuki {
+
+	// Matches the strictest alignment any of the GPU backends hand out for buffers
+	static constexpr std::align_val_t s_BufferAlignment{ 256 };
+
+	Buffer Buffer::Create(RHIContext context, uint64_t size, BufferUsage usage, MemoryCategory category)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->Memory = static_cast<std::byte*>(::operator new(size, s_BufferAlignment));
+		impl->Size = size;
+		impl->Category = category;
+
+		context->TrackMemory(category, size);
+		context->AddStatistics({ .BuffersCreated = 1 });
+		return { impl };
+	}
+
+	void Buffer::Destroy()
+	{
+		::operator delete(m_Impl->Memory, s_BufferAlignment);
+		m_Impl->Context->UntrackMemory(m_Impl->Category, m_Impl->Size);
+		m_Impl->Context->AddStatistics({ .BuffersDestroyed = 1 });
+		delete m_Impl;
+	}
+
+	uint64_t Buffer::GetAddress() const { return reinterpret_cast<uint64_t>(m_Impl->Memory); }
+
+	void Buffer::SetData(const std::byte* data, uint32_t offset, uint32_t size) const
+	{
+		YukiAssert(offset + size <= m_Impl->Size);
+		memcpy(m_Impl->Memory + offset, data, size);
+	}
+
+	MemoryDefragmenter MemoryDefragmenter::Create(RHIContext context, Queue queue, uint64_t maxBytesPerFrame)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->CopyFence = Fence::Create(context);
+		return { impl };
+	}
+
+	void MemoryDefragmenter::Destroy()
+	{
+		m_Impl->CopyFence.Destroy();
+		delete m_Impl;
+	}
+
+	void MemoryDefragmenter::Update(Fence frameFence) {}
+
+	Fence MemoryDefragmenter::GetFence() const { return m_Impl->CopyFence; }
+
+	DefragmentationStatistics MemoryDefragmenter::GetStatistics() const { return {}; }
+
+}
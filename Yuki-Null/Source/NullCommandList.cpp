@@ -0,0 +1,363 @@
+#include "NullRHI.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace Yuki {
+
+	void CommandList::End() const
+	{
+		YukiAssert(m_Impl->IsRecording && !m_Impl->IsRendering);
+		m_Impl->IsRecording = false;
+	}
+
+	void CommandList::Impl::ResetState()
+	{
+		BoundPipeline = 0;
+		BoundHeap = 0;
+		BoundIndexBuffer = 0;
+		BoundIndexType = IndexType::UInt32;
+		BoundIndexOffset = 0;
+		BoundViewports.clear();
+		PushConstantPipeline = 0;
+		PushConstantSize = 0;
+	}
+
+	void CommandList::BeginRendering(Aura::Span<RenderingAttachment> colorAttachments, RenderingAttachment depthAttachment, RenderingContents contents) const
+	{
+		YukiAssert(!m_Impl->IsSecondary);
+		YukiAssert(!m_Impl->IsRendering);
+		m_Impl->IsRendering = true;
+		m_Impl->Counts.BeginRendering++;
+	}
+
+	void CommandList::EndRendering() const
+	{
+		YukiAssert(m_Impl->IsRendering && !m_Impl->IsSecondary);
+		m_Impl->IsRendering = false;
+	}
+
+	void CommandList::SetViewports(Aura::Span<Viewport> viewports) const
+	{
+		bool changed = m_Impl->BoundViewports.size() != viewports.Count();
+
+		for (uint32_t i = 0; !changed && i < viewports.Count(); i++)
+		{
+			const auto& bound = m_Impl->BoundViewports[i];
+			changed = bound.Width != viewports[i].Width || bound.Height != viewports[i].Height;
+		}
+
+		if (!changed)
+		{
+			m_Impl->Statistics.ElidedViewportChanges++;
+			return;
+		}
+
+		m_Impl->BoundViewports.assign(viewports.Begin(), viewports.End());
+		m_Impl->Counts.SetViewports++;
+	}
+
+	void CommandList::BindPipeline(GraphicsPipeline pipeline) const
+	{
+		if (m_Impl->BoundPipeline == pipeline.GetID())
+		{
+			m_Impl->Statistics.ElidedPipelineBinds++;
+			return;
+		}
+
+		m_Impl->BoundPipeline = pipeline.GetID();
+		m_Impl->Counts.BindPipeline++;
+	}
+
+	static ImageLayout ResourceAccessToImageLayout(ResourceAccess access)
+	{
+		switch (access)
+		{
+		case ResourceAccess::ColorAttachmentWrite:
+		case ResourceAccess::DepthAttachmentWrite: return ImageLayout::AttachmentOptimal;
+		case ResourceAccess::TransferRead: return ImageLayout::TransferSrc;
+		case ResourceAccess::TransferWrite: return ImageLayout::TransferDst;
+		case ResourceAccess::ShaderRead: return ImageLayout::ShaderReadOnlyOptimal;
+		case ResourceAccess::Present: return ImageLayout::Present;
+		case ResourceAccess::General: return ImageLayout::General;
+		default: return ImageLayout::Undefined;
+		}
+	}
+
+	static bool IsReadOnlyAccess(ResourceAccess access)
+	{
+		return access == ResourceAccess::TransferRead || access == ResourceAccess::ShaderRead || access == ResourceAccess::IndexRead;
+	}
+
+	void CommandList::Barrier(Aura::Span<ImageBarrier> images, Aura::Span<BufferBarrier> buffers) const
+	{
+		// NOTE(Peter): Same skipping rules as the Vulkan backend
+		uint64_t imageBarriers = 0;
+		for (const auto& barrier : images)
+		{
+			auto image = barrier.Target;
+
+			if (!barrier.Discard && image->LastAccess == barrier.Access && IsReadOnlyAccess(barrier.Access))
+			{
+				continue;
+			}
+
+			image->Layout = ResourceAccessToImageLayout(barrier.Access);
+			image->LastAccess = barrier.Access;
+			imageBarriers++;
+		}
+
+		uint64_t bufferBarriers = 0;
+		for (const auto& barrier : buffers)
+		{
+			auto lastAccess = std::exchange(barrier.Target->LastAccess, barrier.Access);
+
+			if (lastAccess == ResourceAccess::None || (lastAccess == barrier.Access && IsReadOnlyAccess(barrier.Access)))
+			{
+				continue;
+			}
+
+			bufferBarriers++;
+		}
+
+		if (imageBarriers == 0 && bufferBarriers == 0)
+		{
+			return;
+		}
+
+		m_Impl->Counts.Barrier++;
+		m_Impl->Counts.ImageBarriers += imageBarriers;
+		m_Impl->Counts.BufferBarriers += bufferBarriers;
+	}
+
+	void CommandList::TransitionImage(Image image, ImageLayout layout) const
+	{
+		ResourceAccess access = ResourceAccess::General;
+
+		switch (layout)
+		{
+		case ImageLayout::Undefined: access = ResourceAccess::None; break;
+		case ImageLayout::General: access = ResourceAccess::General; break;
+		case ImageLayout::AttachmentOptimal:
+		{
+			bool isDepth = image->Format == ImageFormat::D32SFloat || image->Format == ImageFormat::D24UnormS8UInt;
+			access = isDepth ? ResourceAccess::DepthAttachmentWrite : ResourceAccess::ColorAttachmentWrite;
+			break;
+		}
+		case ImageLayout::TransferSrc: access = ResourceAccess::TransferRead; break;
+		case ImageLayout::TransferDst: access = ResourceAccess::TransferWrite; break;
+		case ImageLayout::ShaderReadOnlyOptimal: access = ResourceAccess::ShaderRead; break;
+		case ImageLayout::Present: access = ResourceAccess::Present; break;
+		}
+
+		Barrier({ { image, access } });
+	}
+
+	void CommandList::BlitImage(Image dest, Image src) const
+	{
+		m_Impl->Counts.BlitImage++;
+	}
+
+	void CommandList::BindDescriptorHeap(DescriptorHeap heap, GraphicsPipeline pipeline) const
+	{
+		// NOTE(Peter): Every pipeline shares the heap layout, so unlike Vulkan we don't have to key on the pipeline
+		if (m_Impl->BoundHeap == heap.GetID())
+		{
+			m_Impl->Statistics.ElidedDescriptorHeapBinds++;
+			return;
+		}
+
+		m_Impl->BoundHeap = heap.GetID();
+		m_Impl->Counts.BindDescriptorHeap++;
+	}
+
+	void CommandList::BindVertexBuffer(Buffer buffer, uint32_t stride) const
+	{
+		m_Impl->Counts.BindVertexBuffer++;
+	}
+
+	void CommandList::BindIndexBuffer(Buffer buffer, IndexType type, uint64_t offset) const
+	{
+		YukiAssert(offset < buffer->Size);
+
+		if (m_Impl->BoundIndexBuffer == buffer.GetID() && m_Impl->BoundIndexType == type && m_Impl->BoundIndexOffset == offset)
+		{
+			m_Impl->Statistics.ElidedIndexBufferBinds++;
+			return;
+		}
+
+		m_Impl->BoundIndexBuffer = buffer.GetID();
+		m_Impl->BoundIndexType = type;
+		m_Impl->BoundIndexOffset = offset;
+		m_Impl->Counts.BindIndexBuffer++;
+	}
+
+	void CommandList::CopyBuffer(Buffer dest, Buffer src, uint32_t size, uint32_t srcOffset, uint32_t destOffset) const
+	{
+		YukiAssert(srcOffset + size <= src->Size && destOffset + size <= dest->Size);
+
+		m_Impl->Counts.CopyBuffer++;
+		m_Impl->Counts.CopiedBytes += size;
+	}
+
+	void CommandList::CopyBufferToImage(Image dest, Buffer src, uint32_t size, uint32_t srcOffset, uint32_t mipLevel) const
+	{
+		YukiAssert(srcOffset + size <= src->Size);
+		YukiAssert(mipLevel < dest->MipLevels);
+		YukiAssert(size >= CalculateImageSize(dest->Format, CalculateMipExtent(dest->Width, mipLevel), CalculateMipExtent(dest->Height, mipLevel)));
+
+		m_Impl->Counts.CopyBufferToImage++;
+		m_Impl->Counts.CopiedBytes += size;
+	}
+
+	void CommandList::SetPushConstants(GraphicsPipeline pipeline, const void* data, uint32_t size) const
+	{
+		YukiAssert(size <= pipeline->PushConstantSize && size <= m_Impl->PushConstants.size());
+
+		if (m_Impl->PushConstantPipeline != pipeline.GetID())
+		{
+			m_Impl->PushConstantPipeline = pipeline.GetID();
+			m_Impl->PushConstantSize = 0;
+		}
+
+		const auto* bytes = static_cast<const std::byte*>(data);
+		uint32_t unchangedBytes = 0;
+
+		for (uint32_t offset = 0; offset < std::min(size, m_Impl->PushConstantSize); offset += 4)
+		{
+			if (memcmp(&m_Impl->PushConstants[offset], bytes + offset, std::min(4u, size - offset)) == 0)
+			{
+				unchangedBytes += std::min(4u, size - offset);
+			}
+		}
+
+		memcpy(m_Impl->PushConstants.data(), bytes, size);
+		m_Impl->PushConstantSize = std::max(m_Impl->PushConstantSize, size);
+		m_Impl->Statistics.ElidedPushConstantBytes += unchangedBytes;
+
+		if (unchangedBytes == size)
+		{
+			m_Impl->Statistics.ElidedPushConstantUploads++;
+			return;
+		}
+
+		m_Impl->Counts.SetPushConstants++;
+		m_Impl->Counts.PushConstantBytes += size - unchangedBytes;
+	}
+
+	void CommandList::Draw(uint32_t vertexCount) const
+	{
+		YukiAssert(m_Impl->IsRendering);
+
+		m_Impl->Counts.Draw++;
+		m_Impl->Counts.Vertices += vertexCount;
+	}
+
+	void CommandList::DrawIndexed(uint32_t indexCount, uint32_t instanceIndex, uint32_t firstIndex) const
+	{
+		YukiAssert(m_Impl->IsRendering);
+
+		m_Impl->Counts.DrawIndexed++;
+		m_Impl->Counts.Indices += indexCount;
+	}
+
+	void CommandList::ExecuteSecondaries(Aura::Span<CommandList> secondaries) const
+	{
+		YukiAssert(m_Impl->IsRendering && !m_Impl->IsSecondary);
+
+		for (auto secondary : secondaries)
+		{
+			YukiAssert(secondary->IsSecondary && secondary->IsRecording);
+			secondary->IsRecording = false;
+
+			m_Impl->Counts += secondary->Counts;
+			m_Impl->Statistics += secondary->Statistics;
+			secondary->Counts = {};
+			secondary->Statistics = {};
+		}
+
+		m_Impl->Counts.ExecuteSecondaries++;
+		m_Impl->ResetState();
+	}
+
+	void CommandList::WriteTimestamp(TimestampQueryPool pool, uint32_t index) const
+	{
+		YukiAssert(m_Impl->IsRecording);
+
+		auto now = std::chrono::steady_clock::now().time_since_epoch();
+		pool->Timestamps[index] = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+		m_Impl->Counts.WriteTimestamp++;
+	}
+
+	CommandPool CommandPool::Create(RHIContext context, Queue queue)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		return { impl };
+	}
+
+	void CommandPool::Destroy()
+	{
+		delete m_Impl;
+	}
+
+	void CommandPool::Reset() const
+	{
+		m_Impl->NextList = 0;
+		m_Impl->NextSecondaryList = 0;
+	}
+
+	StateCacheStatistics CommandPool::GetStateCacheStatistics() const
+	{
+		StateCacheStatistics result;
+
+		for (uint32_t i = 0; i < m_Impl->NextList; i++)
+		{
+			result += m_Impl->AllocatedLists[i]->Statistics;
+		}
+
+		for (uint32_t i = 0; i < m_Impl->NextSecondaryList; i++)
+		{
+			result += m_Impl->AllocatedSecondaryLists[i]->Statistics;
+		}
+
+		return result;
+	}
+
+	CommandList CommandPool::NewList() const
+	{
+		if (m_Impl->NextList >= m_Impl->AllocatedLists.size())
+		{
+			m_Impl->AllocatedLists.push_back({ new CommandList::Impl() });
+		}
+
+		auto cmd = m_Impl->AllocatedLists[m_Impl->NextList++];
+		cmd->ResetState();
+		cmd->Counts = {};
+		cmd->Statistics = {};
+		cmd->IsRecording = true;
+		cmd->IsRendering = false;
+		return cmd;
+	}
+
+	CommandList CommandPool::NewSecondaryList(Aura::Span<ImageFormat> colorAttachmentFormats, ImageFormat depthAttachmentFormat) const
+	{
+		if (m_Impl->NextSecondaryList >= m_Impl->AllocatedSecondaryLists.size())
+		{
+			auto* cmd = new CommandList::Impl();
+			cmd->IsSecondary = true;
+			m_Impl->AllocatedSecondaryLists.push_back({ cmd });
+		}
+
+		// NOTE(Peter): Secondaries always continue a rendering scope, so draws are allowed right away
+		auto cmd = m_Impl->AllocatedSecondaryLists[m_Impl->NextSecondaryList++];
+		cmd->ResetState();
+		cmd->Counts = {};
+		cmd->Statistics = {};
+		cmd->IsRecording = true;
+		cmd->IsRendering = true;
+		return cmd;
+	}
+
+}
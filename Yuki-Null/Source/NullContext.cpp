@@ -0,0 +1,120 @@
+#include "NullRHI.hpp"
+
+namespace Yuki {
+
+	NullCommandCounts& NullCommandCounts::operator+=(const NullCommandCounts& other)
+	{
+		BeginRendering += other.BeginRendering;
+		SetViewports += other.SetViewports;
+		BindPipeline += other.BindPipeline;
+		Barrier += other.Barrier;
+		BlitImage += other.BlitImage;
+		BindDescriptorHeap += other.BindDescriptorHeap;
+		BindVertexBuffer += other.BindVertexBuffer;
+		BindIndexBuffer += other.BindIndexBuffer;
+		CopyBuffer += other.CopyBuffer;
+		CopyBufferToImage += other.CopyBufferToImage;
+		SetPushConstants += other.SetPushConstants;
+		Draw += other.Draw;
+		DrawIndexed += other.DrawIndexed;
+		ExecuteSecondaries += other.ExecuteSecondaries;
+		WriteTimestamp += other.WriteTimestamp;
+
+		Vertices += other.Vertices;
+		Indices += other.Indices;
+		CopiedBytes += other.CopiedBytes;
+		ImageBarriers += other.ImageBarriers;
+		BufferBarriers += other.BufferBarriers;
+		PushConstantBytes += other.PushConstantBytes;
+		return *this;
+	}
+
+	RHIContext RHIContext::Create()
+	{
+		auto* impl = new Impl();
+
+		WriteLine("GPU: Null");
+
+		for (auto type : { QueueType::Graphics, QueueType::Compute, QueueType::Transfer })
+		{
+			auto* queue = new Queue::Impl();
+			queue->Context = { impl };
+			queue->Type = type;
+			impl->Queues.push_back({ queue });
+		}
+
+		return { impl };
+	}
+
+	void RHIContext::Destroy()
+	{
+		for (uint32_t i = 0; i < MemoryCategoryCount; i++)
+		{
+			const auto& report = m_Impl->MemoryCategories[i];
+
+			if (report.Allocations > 0)
+			{
+				WriteLine("{} allocations ({} bytes) in {} were never freed", LogLevel::Warn, report.Allocations, report.Bytes, MemoryCategoryToString(static_cast<MemoryCategory>(i)));
+			}
+		}
+
+		delete m_Impl;
+	}
+
+	RHIStatistics RHIContext::GetStatistics() const
+	{
+		std::scoped_lock lock(m_Impl->StatisticsMutex);
+		return m_Impl->Statistics;
+	}
+
+	RHIStatistics RHIContext::ResetStatistics() const
+	{
+		std::scoped_lock lock(m_Impl->StatisticsMutex);
+		return std::exchange(m_Impl->Statistics, {});
+	}
+
+	MemoryReport RHIContext::GetMemoryReport() const
+	{
+		std::scoped_lock lock(m_Impl->MemoryMutex);
+
+		uint64_t allocatedBytes = 0;
+		for (const auto& category : m_Impl->MemoryCategories)
+		{
+			allocatedBytes += category.Bytes;
+		}
+
+		// NOTE(Peter): A single heap that everything comes out of, there's no budget to run out of
+		return {
+			.Heaps = { { allocatedBytes, std::numeric_limits<uint64_t>::max(), allocatedBytes, false } },
+			.Categories = m_Impl->MemoryCategories,
+		};
+	}
+
+	void RHIContext::SetAssetPack(const AssetPack* pack) const {}
+
+	bool RHIContext::IsHostImageCopySupported(ImageFormat format) const
+	{
+		return true;
+	}
+
+	bool RHIContext::IsImageFormatSupported(ImageFormat format) const
+	{
+		return format != ImageFormat::None;
+	}
+
+	namespace Null {
+
+		NullCommandCounts GetSubmittedCommands(RHIContext context)
+		{
+			return context->SubmittedCommands;
+		}
+
+		void ResetSubmittedCommands(RHIContext context)
+		{
+			context->SubmittedCommands = {};
+			context->SubmitCount = 0;
+		}
+
+	}
+
+}
@@ -0,0 +1,36 @@
+#include "NullRHI.hpp"
+
+namespace Yuki {
+
+	// Same capacity as the descriptor set layout of the Vulkan backend
+	static constexpr uint32_t s_MaxDescriptors = 1000;
+
+	DescriptorHeap DescriptorHeap::Create(RHIContext context)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->SampledImages.resize(s_MaxDescriptors);
+		impl->Samplers.resize(s_MaxDescriptors);
+		return { impl };
+	}
+
+	void DescriptorHeap::Destroy()
+	{
+		delete m_Impl;
+	}
+
+	void DescriptorHeap::WriteSampledImage(uint32_t index, ImageView imageView)
+	{
+		YukiAssert(index < s_MaxDescriptors);
+		m_Impl->SampledImages[index] = imageView;
+		m_Impl->Context->AddStatistics({ .DescriptorWrites = 1 });
+	}
+
+	void DescriptorHeap::WriteSampler(uint32_t index, Sampler sampler)
+	{
+		YukiAssert(index < s_MaxDescriptors);
+		m_Impl->Samplers[index] = sampler;
+		m_Impl->Context->AddStatistics({ .DescriptorWrites = 1 });
+	}
+
+}
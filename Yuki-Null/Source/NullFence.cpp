@@ -0,0 +1,60 @@
+#include "NullRHI.hpp"
+
+namespace Yuki {
+
+	Fence Fence::Create(RHIContext context)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->Value = 0;
+		return { impl };
+	}
+
+	void Fence::Destroy()
+	{
+		delete m_Impl;
+	}
+
+	uint64_t Fence::GetValue() const { return m_Impl->Value; }
+	uint64_t Fence::GetCurrentValue() const { return m_Impl->Value; }
+
+	void Fence::Wait(uint64_t value) const
+	{
+		// Waiting for a value that's never been signalled would hang forever on a real device
+		YukiAssert(value <= m_Impl->Value);
+	}
+
+	TimestampQueryPool TimestampQueryPool::Create(RHIContext context, uint32_t count)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->Timestamps.resize(count, 0);
+		return { impl };
+	}
+
+	void TimestampQueryPool::Destroy()
+	{
+		delete m_Impl;
+	}
+
+	void TimestampQueryPool::Reset(uint32_t first, uint32_t count) const
+	{
+		std::fill_n(m_Impl->Timestamps.begin() + first, count, 0);
+	}
+
+	bool TimestampQueryPool::GetResults(uint32_t first, Aura::Span<uint64_t> timestamps) const
+	{
+		for (uint32_t i = 0; i < timestamps.Count(); i++)
+		{
+			if (m_Impl->Timestamps[first + i] == 0)
+			{
+				return false;
+			}
+
+			timestamps[i] = m_Impl->Timestamps[first + i];
+		}
+
+		return true;
+	}
+
+}
@@ -0,0 +1,129 @@
+#include "NullRHI.hpp"
+
+namespace Yuki {
+
+	static Image::Impl* NewImageImpl(RHIContext context, const ImageConfig& config)
+	{
+		auto* impl = new Image::Impl();
+		impl->Context = context;
+		impl->Width = config.Width;
+		impl->Height = config.Height;
+		impl->MipLevels = config.MipLevels;
+		impl->Format = config.Format;
+		impl->Usage = config.Usage;
+		impl->Layout = ImageLayout::Undefined;
+		impl->Category = config.Category;
+
+		if (config.CreateDefaultView)
+		{
+			impl->DefaultView = ImageView::Create(context, { impl });
+		}
+
+		context->AddStatistics({ .ImagesCreated = 1 });
+		return impl;
+	}
+
+	Image Image::Create(RHIContext context, const ImageConfig& config)
+	{
+		auto* impl = NewImageImpl(context, config);
+		impl->AllocatedBytes = GetMemoryRequirements(context, config).Size;
+		context->TrackMemory(impl->Category, impl->AllocatedBytes);
+		return { impl };
+	}
+
+	Image Image::CreateAliased(RHIContext context, const ImageConfig& config, AliasingMemory memory, uint64_t offset)
+	{
+		YukiAssert(offset + GetMemoryRequirements(context, config).Size <= memory->Size);
+		return { NewImageImpl(context, config) };
+	}
+
+	void Image::Destroy()
+	{
+		if (m_Impl->DefaultView)
+		{
+			m_Impl->DefaultView.Destroy();
+		}
+
+		if (m_Impl->AllocatedBytes > 0)
+		{
+			m_Impl->Context->UntrackMemory(m_Impl->Category, m_Impl->AllocatedBytes);
+		}
+
+		m_Impl->Context->AddStatistics({ .ImagesDestroyed = 1 });
+		delete m_Impl;
+	}
+
+	ImageMemoryRequirements Image::GetMemoryRequirements(RHIContext context, const ImageConfig& config)
+	{
+		YukiAssert(config.MipLevels > 0 && config.MipLevels <= CalculateMipLevelCount(config.Width, config.Height));
+
+		uint64_t size = 0;
+		for (uint32_t mip = 0; mip < config.MipLevels; mip++)
+		{
+			size += CalculateImageSize(config.Format, CalculateMipExtent(config.Width, mip), CalculateMipExtent(config.Height, mip));
+		}
+
+		// NOTE(Peter): Tightly packed levels, the alignment matches what desktop drivers report for render targets
+		return {
+			.Size = size,
+			.Alignment = 64 * 1024,
+			.MemoryTypeBits = ~0u,
+		};
+	}
+
+	AliasingMemory AliasingMemory::Create(RHIContext context, uint64_t size, uint32_t memoryTypeBits, MemoryCategory category)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->Size = size;
+		impl->Category = category;
+		context->TrackMemory(category, size);
+		return { impl };
+	}
+
+	void AliasingMemory::Destroy()
+	{
+		m_Impl->Context->UntrackMemory(m_Impl->Category, m_Impl->Size);
+		delete m_Impl;
+	}
+
+	ImageView Image::GetDefaultView() const { return m_Impl->DefaultView; }
+
+	void Image::WriteFromHost(const void* data, uint64_t size, uint32_t mipLevel) const
+	{
+		YukiAssert(m_Impl->Usage & ImageUsage::HostTransfer);
+		YukiAssert(mipLevel < m_Impl->MipLevels);
+		YukiAssert(size >= CalculateImageSize(m_Impl->Format, CalculateMipExtent(m_Impl->Width, mipLevel), CalculateMipExtent(m_Impl->Height, mipLevel)));
+
+		m_Impl->Layout = ImageLayout::ShaderReadOnlyOptimal;
+		m_Impl->LastAccess = ResourceAccess::ShaderRead;
+		m_Impl->Context->AddStatistics({ .HostCopiedBytes = size });
+	}
+
+	ImageView ImageView::Create(RHIContext context, Image image)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->Source = image;
+		return { impl };
+	}
+
+	void ImageView::Destroy()
+	{
+		delete m_Impl;
+	}
+
+	Sampler Sampler::Create(RHIContext context, const SamplerConfig& config)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->Config = config;
+		return { impl };
+	}
+
+	void Sampler::Destroy()
+	{
+		delete m_Impl;
+	}
+
+}
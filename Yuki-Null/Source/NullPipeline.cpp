@@ -0,0 +1,19 @@
+#include "NullRHI.hpp"
+
+namespace Yuki {
+
+	GraphicsPipeline GraphicsPipeline::Create(RHIContext context, const GraphicsPipelineConfig& config, DescriptorHeap heap)
+	{
+		// NOTE(Peter): Shaders aren't compiled, so pipeline creation cost is excluded from measurements
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->PushConstantSize = config.PushConstantSize;
+		return { impl };
+	}
+
+	void GraphicsPipeline::Destroy()
+	{
+		delete m_Impl;
+	}
+
+}
@@ -0,0 +1,132 @@
+#include "NullRHI.hpp"
+
+#include <algorithm>
+
+namespace Yuki {
+
+	Aura::Span<Queue> RHIContext::RequestQueues(QueueType type, uint32_t count) const
+	{
+		for (uint32_t i = 0; i < m_Impl->Queues.size(); i++)
+		{
+			if (m_Impl->Queues[i]->Type == type)
+			{
+				// NOTE(Peter): Like on hardware with a single queue per family we may return fewer queues than requested
+				return { &m_Impl->Queues[i], 1 };
+			}
+		}
+
+		YukiAssert(false);
+		return {};
+	}
+
+	Queue RHIContext::RequestQueue(QueueType type) const
+	{
+		return RequestQueues(type, 1)[0];
+	}
+
+	static void SignalFences(Aura::Span<Fence> signals)
+	{
+		for (auto fence : signals)
+		{
+			fence->Value++;
+		}
+	}
+
+	void Queue::AcquireImages(Aura::Span<Swapchain> swapchains, Aura::Span<Fence> signals) const
+	{
+		for (auto swapchain : swapchains)
+		{
+			swapchain->CurrentImageIndex = (swapchain->CurrentImageIndex + 1) % static_cast<uint32_t>(swapchain->Images.size());
+		}
+
+		SignalFences(signals);
+	}
+
+	void Queue::SubmitCommandLists(Aura::Span<CommandList> commandLists, Aura::Span<Fence> waits, Aura::Span<Fence> signals) const
+	{
+		SubmitBatch batch;
+		batch.Add(*this, commandLists, waits, signals);
+		batch.Flush();
+	}
+
+	void SubmitBatch::Add(Queue queue, Aura::Span<CommandList> commandLists, Aura::Span<Fence> waits, Aura::Span<Fence> signals)
+	{
+		Submits.push_back({
+			.Target = queue,
+			.CommandListOffset = static_cast<uint32_t>(CommandLists.size()),
+			.CommandListCount = commandLists.Count(),
+			.WaitOffset = static_cast<uint32_t>(Waits.size()),
+			.WaitCount = waits.Count(),
+			.SignalOffset = static_cast<uint32_t>(Signals.size()),
+			.SignalCount = signals.Count(),
+		});
+
+		CommandLists.insert(CommandLists.end(), commandLists.Begin(), commandLists.End());
+
+		for (auto fence : waits)
+		{
+			Waits.push_back({ fence, fence->Value });
+		}
+
+		// NOTE(Peter): Unlike a real device the fences are signalled right away
+		for (auto fence : signals)
+		{
+			Signals.push_back({ fence, ++fence->Value });
+		}
+	}
+
+	void SubmitBatch::Flush()
+	{
+		if (Submits.empty())
+		{
+			return;
+		}
+
+		auto context = Submits[0].Target->Context;
+		RHIStatistics statistics;
+
+		for (auto commandList : CommandLists)
+		{
+			YukiAssert(!commandList->IsRecording && !commandList->IsSecondary);
+
+			const auto& counts = commandList->Counts;
+			statistics.DrawCalls += counts.Draw + counts.DrawIndexed;
+			statistics.IndicesDrawn += counts.Indices;
+			statistics.PipelineBinds += counts.BindPipeline;
+			statistics.Barriers += counts.ImageBarriers + counts.BufferBarriers;
+			statistics.CopiedBytes += counts.CopiedBytes;
+
+			context->SubmittedCommands += commandList->Counts;
+			commandList->Counts = {};
+		}
+
+		// One submit call per distinct queue
+		for (uint32_t i = 0; i < Submits.size(); i++)
+		{
+			bool firstUse = std::ranges::none_of(Submits.begin(), Submits.begin() + i, [&](const Submit& submit)
+			{
+				return submit.Target == Submits[i].Target;
+			});
+
+			context->SubmitCount += firstUse;
+			statistics.Submits += firstUse;
+		}
+
+		context->AddStatistics(statistics);
+
+		Submits.clear();
+		CommandLists.clear();
+		Waits.clear();
+		Signals.clear();
+	}
+
+	bool Queue::SupportsTimestamps() const
+	{
+		return true;
+	}
+
+	void Queue::Present(Aura::Span<Swapchain> swapchains, Aura::Span<Fence> waits) const
+	{
+	}
+
+}
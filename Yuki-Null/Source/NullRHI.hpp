@@ -0,0 +1,235 @@
+#pragma once
+
+#include <Engine/Core/Window.hpp>
+#include <Engine/RHI/RHI.hpp>
+
+#include <array>
+#include <mutex>
+
+namespace Yuki {
+
+	// NOTE(Peter): The null backend never talks to a driver, command lists only record how many
+	//              of each command they would've issued so we can measure pure engine CPU overhead
+	struct NullCommandCounts
+	{
+		uint64_t BeginRendering = 0;
+		uint64_t SetViewports = 0;
+		uint64_t BindPipeline = 0;
+		uint64_t Barrier = 0;
+		uint64_t BlitImage = 0;
+		uint64_t BindDescriptorHeap = 0;
+		uint64_t BindVertexBuffer = 0;
+		uint64_t BindIndexBuffer = 0;
+		uint64_t CopyBuffer = 0;
+		uint64_t CopyBufferToImage = 0;
+		uint64_t SetPushConstants = 0;
+		uint64_t Draw = 0;
+		uint64_t DrawIndexed = 0;
+		uint64_t ExecuteSecondaries = 0;
+		uint64_t WriteTimestamp = 0;
+
+		uint64_t Vertices = 0;
+		uint64_t Indices = 0;
+		uint64_t CopiedBytes = 0;
+		uint64_t ImageBarriers = 0;
+		uint64_t BufferBarriers = 0;
+		uint64_t PushConstantBytes = 0;
+
+		NullCommandCounts& operator+=(const NullCommandCounts& other);
+	};
+
+	namespace Null {
+
+		// Counts of all commands submitted to any queue of the context since the last reset
+		NullCommandCounts GetSubmittedCommands(RHIContext context);
+		void ResetSubmittedCommands(RHIContext context);
+
+	}
+
+	template<>
+	struct Handle<RHIContext>::Impl
+	{
+		std::vector<Queue> Queues;
+
+		NullCommandCounts SubmittedCommands;
+		uint64_t SubmitCount = 0;
+
+		std::mutex StatisticsMutex;
+		RHIStatistics Statistics;
+
+		// NOTE(Peter): Resources report the bytes a GPU backend would've allocated for them
+		std::mutex MemoryMutex;
+		std::array<MemoryCategoryReport, MemoryCategoryCount> MemoryCategories;
+
+		void AddStatistics(const RHIStatistics& statistics)
+		{
+			std::scoped_lock lock(StatisticsMutex);
+			Statistics += statistics;
+		}
+
+		void TrackMemory(MemoryCategory category, uint64_t bytes)
+		{
+			std::scoped_lock lock(MemoryMutex);
+			MemoryCategories[std::to_underlying(category)].Bytes += bytes;
+			MemoryCategories[std::to_underlying(category)].Allocations++;
+		}
+
+		void UntrackMemory(MemoryCategory category, uint64_t bytes)
+		{
+			std::scoped_lock lock(MemoryMutex);
+			MemoryCategories[std::to_underlying(category)].Bytes -= bytes;
+			MemoryCategories[std::to_underlying(category)].Allocations--;
+		}
+	};
+
+	template<>
+	struct Handle<Queue>::Impl
+	{
+		RHIContext Context;
+		QueueType Type;
+	};
+
+	template<>
+	struct Handle<Image>::Impl
+	{
+		RHIContext Context;
+
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t MipLevels;
+		ImageFormat Format;
+		ImageUsage Usage;
+		ImageLayout Layout;
+		ResourceAccess LastAccess = ResourceAccess::None;
+
+		MemoryCategory Category;
+		// Zero for aliased images, their memory belongs to the AliasingMemory
+		uint64_t AllocatedBytes = 0;
+
+		ImageView DefaultView;
+	};
+
+	template<>
+	struct Handle<AliasingMemory>::Impl
+	{
+		RHIContext Context;
+		uint64_t Size;
+		MemoryCategory Category;
+	};
+
+	template<>
+	struct Handle<ImageView>::Impl
+	{
+		RHIContext Context;
+		Image Source;
+	};
+
+	template<>
+	struct Handle<Swapchain>::Impl
+	{
+		RHIContext Context;
+		Window Target;
+
+		std::vector<Image> Images;
+		std::vector<ImageView> ImageViews;
+		uint32_t CurrentImageIndex;
+	};
+
+	template<>
+	struct Handle<Fence>::Impl
+	{
+		RHIContext Context;
+
+		// NOTE(Peter): Every signal completes immediately, so the current value is always the last signalled value
+		uint64_t Value;
+	};
+
+	template<>
+	struct Handle<TimestampQueryPool>::Impl
+	{
+		RHIContext Context;
+
+		// NOTE(Peter): Timestamps are taken from the CPU clock when they're recorded, zero means the query hasn't been written
+		std::vector<uint64_t> Timestamps;
+	};
+
+	template<>
+	struct Handle<Sampler>::Impl
+	{
+		RHIContext Context;
+		SamplerConfig Config;
+	};
+
+	template<>
+	struct Handle<DescriptorHeap>::Impl
+	{
+		RHIContext Context;
+
+		std::vector<ImageView> SampledImages;
+		std::vector<Sampler> Samplers;
+	};
+
+	template<>
+	struct Handle<GraphicsPipeline>::Impl
+	{
+		RHIContext Context;
+		uint32_t PushConstantSize;
+	};
+
+	template<>
+	struct Handle<Buffer>::Impl
+	{
+		RHIContext Context;
+		std::byte* Memory;
+		uint64_t Size;
+		MemoryCategory Category;
+		ResourceAccess LastAccess = ResourceAccess::None;
+	};
+
+	// NOTE(Peter): Buffers live in their own allocations, so there's never anything to move
+	template<>
+	struct Handle<MemoryDefragmenter>::Impl
+	{
+		RHIContext Context;
+		Fence CopyFence;
+	};
+
+	template<>
+	struct Handle<CommandList>::Impl
+	{
+		NullCommandCounts Counts;
+		bool IsRecording = false;
+		bool IsRendering = false;
+		bool IsSecondary = false;
+
+		// NOTE(Peter): Same caching rules as the Vulkan backend so the counts match what a driver would see
+		GraphicsPipeline::ID BoundPipeline = 0;
+		DescriptorHeap::ID BoundHeap = 0;
+		Buffer::ID BoundIndexBuffer = 0;
+		IndexType BoundIndexType = IndexType::UInt32;
+		uint64_t BoundIndexOffset = 0;
+		std::vector<Viewport> BoundViewports;
+
+		std::array<std::byte, 128> PushConstants;
+		GraphicsPipeline::ID PushConstantPipeline = 0;
+		uint32_t PushConstantSize = 0;
+
+		StateCacheStatistics Statistics;
+
+		// Forgets all bound state, same as Vulkan does after executing secondaries
+		void ResetState();
+	};
+
+	template<>
+	struct Handle<CommandPool>::Impl
+	{
+		RHIContext Context;
+
+		std::vector<CommandList> AllocatedLists;
+		uint32_t NextList = 0;
+
+		std::vector<CommandList> AllocatedSecondaryLists;
+		uint32_t NextSecondaryList = 0;
+	};
+
+}
@@ -0,0 +1,45 @@
+#include "NullRHI.hpp"
+
+namespace Yuki {
+
+	// NOTE(Peter): Same image count as we'd get from a mailbox swapchain on most drivers
+	static constexpr uint32_t s_SwapchainImageCount = 3;
+
+	Swapchain Swapchain::Create(RHIContext context, Window window)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->Target = window;
+		impl->CurrentImageIndex = 0;
+
+		for (uint32_t i = 0; i < s_SwapchainImageCount; i++)
+		{
+			auto image = Image::Create(context, {
+				.Width = window.GetWidth(),
+				.Height = window.GetHeight(),
+				.Format = ImageFormat::BGRA8Unorm,
+				.Usage = ImageUsage::ColorAttachment | ImageUsage::TransferDst,
+				.CreateDefaultView = true,
+			});
+
+			impl->Images.push_back(image);
+			impl->ImageViews.push_back(image.GetDefaultView());
+		}
+
+		return { impl };
+	}
+
+	void Swapchain::Destroy()
+	{
+		for (auto image : m_Impl->Images)
+		{
+			image.Destroy();
+		}
+
+		delete m_Impl;
+	}
+
+	Image Swapchain::GetCurrentImage() const { return m_Impl->Images[m_Impl->CurrentImageIndex]; }
+	ImageView Swapchain::GetCurrentImageView() const { return m_Impl->ImageViews[m_Impl->CurrentImageIndex]; }
+
+}
@@ -0,0 +1,18 @@
+project "Yuki-Null"
+    kind "StaticLib"
+	warnings "Extra"
+
+    files {
+        "Source/**.cpp",
+        "Source/**.hpp",
+    }
+
+    externalincludedirs {
+        "../Yuki/Source/",
+		"../ThirdParty/Aura/Aura/Include/",
+    }
+
+	filter { "system:windows" }
+		defines {
+			"YUKI_PLATFORM_WINDOWS",
+		}
@@ -1,7 +1,7 @@
 #include "ShaderCompiler.hpp"
 #include "VulkanRHI.hpp"
 
-#include <Engine/IO/FileIO.hpp>
+#include <Engine/IO/AssetPack.hpp>
 
 #include <glslang/Public/ShaderLang.h>
 #include <glslang/Public/ResourceLimits.h>
@@ -36,10 +36,17 @@ namespace Yuki {
 		struct UserData
 		{
 			std::string Name;
-			std::string Content;
+
+			// Owned by m_Files
+			const PackedAsset* File = nullptr;
 		};
 
 	public:
+		explicit GlslIncluder(const AssetPack* pack)
+			: m_Pack(pack)
+		{
+		}
+
 		IncludeResult* includeSystem(const char* headerName, const char* includerName, size_t inclusionDepth) override
 		{
 			return include(headerName, includerName, false);
@@ -57,59 +64,81 @@ namespace Yuki {
 		}
 
 	private:
+		// Headers are usually included many times, they're only loaded once per shader
+		const PackedAsset* LoadCached(const std::filesystem::path& filepath)
+		{
+			auto key = filepath.string();
+
+			if (auto it = m_Files.find(key); it != m_Files.end())
+			{
+				return &it->second;
+			}
+
+			auto file = LoadAsset(m_Pack, filepath);
+
+			if (!file.IsValid())
+			{
+				return nullptr;
+			}
+
+			return &m_Files.emplace(std::move(key), std::move(file)).first->second;
+		}
+
 		IncludeResult* include(const char* headerName, const char* includerName, bool isRelative)
 		{
 			std::filesystem::path requested = headerName;
-			std::filesystem::path current = includerName;
-
-			std::filesystem::path target;
-			bool exists = false;
+			auto userData = new UserData();
 
+			// NOTE(Peter): Loading the file doubles as the check whether it exists, glslang reads the mapped or decompressed text directly
 			if (isRelative)
 			{
-				target = current.parent_path() / requested;
-				exists = std::filesystem::exists(target);
+				auto target = std::filesystem::path(includerName).parent_path() / requested;
+				userData->File = LoadCached(target);
+				userData->Name = target.string();
 			}
 
-			if (!exists)
+			if (!userData->File)
 			{
-				target = requested;
-				exists = std::filesystem::exists(target);
+				userData->File = LoadCached(requested);
+				userData->Name = requested.string();
 			}
 
-			YukiAssert(exists);
+			YukiAssert(userData->File);
 
-			auto userData = new UserData();
-			userData->Name = target.string();
-			FileIO::ReadText(target, userData->Content);
-
-			return new IncludeResult(userData->Name, userData->Content.c_str(), userData->Content.length(), userData);
+			auto text = userData->File->GetText();
+			return new IncludeResult(userData->Name, text.empty() ? "" : text.data(), text.size(), userData);
 		}
+
+	private:
+		const AssetPack* m_Pack;
+		std::unordered_map<std::string, PackedAsset> m_Files;
 	};
 
 	VkShaderModule ShaderCompiler::CompileShader(RHIContext context, const std::filesystem::path& filepath, ShaderStage stage)
 	{
-		std::string source;
 		auto filepathStr = filepath.string();
+		auto file = LoadAsset(m_AssetPack, filepath);
 
-		if (!FileIO::ReadText(filepath, source))
+		if (!file.IsValid())
 		{
 			WriteLine("Failed to load shader {}, file doesn't exist.", LogLevel::Error, filepathStr);
 			return nullptr;
 		}
 
+		auto source = file.GetText();
+
 		auto lang = ShaderStageToEShLanguage(stage);
 		glslang::TShader shader{ lang };
 		shader.setEnvInput(glslang::EShSourceGlsl, lang, glslang::EShClientVulkan, glslang::EShTargetVulkan_1_3);
 		shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_3);
 		shader.setEnvTarget(glslang::EshTargetSpv, glslang::EShTargetSpv_1_6);
 
-		const char* sourceStr = source.c_str();
+		const char* sourceStr = source.empty() ? "" : source.data();
 		int32_t sourceLength = static_cast<int32_t>(source.length());
 		const char* filepathRawStr = filepathStr.c_str();
 		shader.setStringsWithLengthsAndNames(&sourceStr, &sourceLength, &filepathRawStr, 1);
 
-		GlslIncluder includer;
+		GlslIncluder includer(m_AssetPack);
 
 		const auto* defaultResources = GetDefaultResources();
 
@@ -3,6 +3,7 @@
 #include "VulkanCommon.hpp"
 
 #include <Engine/RHI/RHI.hpp>
+#include <Engine/IO/AssetPack.hpp>
 
 #include <filesystem>
 
@@ -16,7 +17,11 @@ namespace Yuki {
 
 		VkShaderModule CompileShader(RHIContext context, const std::filesystem::path& filepath, ShaderStage stage);
 
+		// Shaders and the files they include are read from pack before the filesystem
+		void SetAssetPack(const AssetPack* pack) { m_AssetPack = pack; }
+
 	private:
+		const AssetPack* m_AssetPack = nullptr;
 	};
 
 }
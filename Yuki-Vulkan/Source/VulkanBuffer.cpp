@@ -2,20 +2,31 @@
 
 namespace Yuki {
 
-	Buffer Buffer::Create(RHIContext context, uint64_t size, BufferUsage usage)
+	Buffer Buffer::Create(RHIContext context, uint64_t size, BufferUsage usage, MemoryCategory category)
 	{
 		auto* impl = new Impl();
 		impl->Context = context;
 		
+		impl->Usage = BufferUsageToVkBufferUsage(usage);
+
+		// NOTE(Peter): Only buffers whose users wait for the defragmenter's fence can be copied to a new place, the CPU may be
+		//              writing mapped buffers at any time so they always stay where they are
+		YukiAssert(!(usage & BufferUsage::Movable) || !(usage & BufferUsage::Mapped));
+		bool isMovable = usage & BufferUsage::Movable;
+		if (isMovable)
+		{
+			impl->Usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		}
+
 		VkBufferCreateInfo bufferInfo =
 		{
 			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
 			.size = size,
-			.usage = BufferUsageToVkBufferUsage(usage),
+			.usage = impl->Usage,
 			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 		};
 
-		impl->Allocation = context->Allocator.CreateBuffer(bufferInfo, usage);
+		impl->Allocation = context->Allocator.CreateBuffer(bufferInfo, usage, category, isMovable ? impl : nullptr);
 		impl->Size = size;
 
 		VkBufferDeviceAddressInfo addressInfo =
@@ -25,12 +36,22 @@ namespace Yuki {
 		};
 		impl->Address = vkGetBufferDeviceAddress(context->Device, &addressInfo);
 
+		context->AddStatistics({ .BuffersCreated = 1 });
 		return { impl };
 	}
 
 	void Buffer::Destroy()
 	{
-		m_Impl->Context->Allocator.DestroyBuffer(m_Impl->Allocation);
+		if (m_Impl->Context->Defragmenter)
+		{
+			m_Impl->Context->Defragmenter->DestroyBuffer(m_Impl);
+		}
+		else
+		{
+			m_Impl->Context->Allocator.DestroyBuffer(m_Impl->Allocation);
+		}
+
+		m_Impl->Context->AddStatistics({ .BuffersDestroyed = 1 });
 		delete m_Impl;
 	}
 
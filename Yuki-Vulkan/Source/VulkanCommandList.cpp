@@ -4,7 +4,7 @@
 
 namespace Yuki {
 
-	void CommandList::BeginRendering(Aura::Span<RenderingAttachment> colorAttachments) const
+	void CommandList::BeginRendering(Aura::Span<RenderingAttachment> colorAttachments, RenderingAttachment depthAttachment, RenderingContents contents) const
 	{
 		AuraStackPoint();
 
@@ -39,9 +39,33 @@ namespace Yuki {
 			};
 		}
 
+		VkRenderingAttachmentInfo depthAttachmentInfo = { .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
+		bool hasDepth = depthAttachment.Target.IsValid();
+		bool hasStencil = false;
+
+		if (hasDepth)
+		{
+			auto imageView = depthAttachment.Target;
+
+			renderWidth = std::min(renderWidth, static_cast<uint32_t>(imageView->Source->Width));
+			renderHeight = std::min(renderHeight, static_cast<uint32_t>(imageView->Source->Height));
+
+			// NOTE(Peter): Depth is never read back after the pass, so we let the driver discard it
+			depthAttachmentInfo.imageView = imageView->Resource;
+			depthAttachmentInfo.imageLayout = imageView->Source->Layout;
+			depthAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			depthAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			depthAttachmentInfo.clearValue = {
+				.depthStencil = { 1.0f, 0 }
+			};
+
+			hasStencil = imageView->Source->AspectFlags & VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+
 		VkRenderingInfo renderingInfo =
 		{
 			.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+			.flags = contents == RenderingContents::SecondaryLists ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0u,
 			.renderArea = {
 				{ 0, 0 },
 				{ renderWidth, renderHeight }
@@ -49,6 +73,8 @@ namespace Yuki {
 			.layerCount = 1,
 			.colorAttachmentCount = attachments.Count(),
 			.pColorAttachments = attachments.Data(),
+			.pDepthAttachment = hasDepth ? &depthAttachmentInfo : nullptr,
+			.pStencilAttachment = hasStencil ? &depthAttachmentInfo : nullptr,
 		};
 
 		vkCmdBeginRendering(m_Impl->Resource, &renderingInfo);
@@ -59,10 +85,61 @@ namespace Yuki {
 		vkCmdEndRendering(m_Impl->Resource);
 	}
 
+	void CommandList::End() const
+	{
+		Vulkan::CheckResult(vkEndCommandBuffer(m_Impl->Resource));
+	}
+
+	void CommandList::Impl::ResetState()
+	{
+		BoundPipeline = VK_NULL_HANDLE;
+		BoundDescriptorSet = VK_NULL_HANDLE;
+		BoundDescriptorSetLayout = VK_NULL_HANDLE;
+		BoundIndexBuffer = VK_NULL_HANDLE;
+		BoundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+		BoundIndexOffset = 0;
+		BoundViewportCount = 0;
+		PushConstantLayout = VK_NULL_HANDLE;
+		PushConstantSize = 0;
+	}
+
 	void CommandList::SetViewports(Aura::Span<Viewport> viewports) const
 	{
 		AuraStackPoint();
 
+		bool cacheable = viewports.Count() <= MaxCachedViewports;
+
+		if (cacheable && viewports.Count() == m_Impl->BoundViewportCount)
+		{
+			bool changed = false;
+
+			for (uint32_t i = 0; i < viewports.Count(); i++)
+			{
+				const auto& bound = m_Impl->BoundViewports[i];
+				changed |= bound.Width != viewports[i].Width || bound.Height != viewports[i].Height;
+			}
+
+			if (!changed)
+			{
+				m_Impl->Statistics.ElidedViewportChanges++;
+				return;
+			}
+		}
+
+		if (cacheable)
+		{
+			for (uint32_t i = 0; i < viewports.Count(); i++)
+			{
+				m_Impl->BoundViewports[i] = viewports[i];
+			}
+
+			m_Impl->BoundViewportCount = viewports.Count();
+		}
+		else
+		{
+			m_Impl->BoundViewportCount = 0;
+		}
+
 		auto viewportList = Aura::StackAlloc<VkViewport>(viewports.Count());
 		auto scissorList = Aura::StackAlloc<VkRect2D>(viewports.Count());
 		for (uint32_t i = 0; i < viewports.Count(); i++)
@@ -84,50 +161,150 @@ namespace Yuki {
 
 	void CommandList::BindPipeline(GraphicsPipeline pipeline) const
 	{
+		if (m_Impl->BoundPipeline == pipeline->Resource)
+		{
+			m_Impl->Statistics.ElidedPipelineBinds++;
+			return;
+		}
+
+		m_Impl->BoundPipeline = pipeline->Resource;
+		m_Impl->Commands.PipelineBinds++;
 		vkCmdBindPipeline(m_Impl->Resource, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->Resource);
 	}
 
-	void CommandList::TransitionImage(Image image, ImageLayout layout) const
+	// Only writes have to be made available, previous reads just need the execution dependency
+	static constexpr VkAccessFlags2 s_ReadAccessMask =
+		VK_ACCESS_2_SHADER_SAMPLED_READ_BIT |
+		VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+		VK_ACCESS_2_TRANSFER_READ_BIT |
+		VK_ACCESS_2_INDEX_READ_BIT |
+		VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT |
+		VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+		VK_ACCESS_2_MEMORY_READ_BIT;
+
+	void CommandList::Barrier(Aura::Span<ImageBarrier> images, Aura::Span<BufferBarrier> buffers) const
 	{
-		auto newLayout = ImageLayoutToVkImageLayout(layout);
+		AuraStackPoint();
+
+		auto imageBarriers = Aura::StackAlloc<VkImageMemoryBarrier2>(images.Count());
+		uint32_t imageBarrierCount = 0;
 
-		if (image->Layout == newLayout)
+		for (const auto& barrier : images)
+		{
+			auto image = barrier.Target;
+
+			// Consecutive reads of the same kind don't depend on each other
+			if (!barrier.Discard && image->LastAccess == barrier.Access && IsReadOnlyAccess(barrier.Access))
+			{
+				continue;
+			}
+
+			auto src = ResourceAccessToVulkanAccess(image->LastAccess);
+			auto dst = ResourceAccessToVulkanAccess(barrier.Access);
+
+			if (barrier.AliasedFrom)
+			{
+				auto aliased = ResourceAccessToVulkanAccess(barrier.AliasedFrom->LastAccess);
+				src.Stages |= aliased.Stages;
+				src.Access |= aliased.Access;
+			}
+
+			image->OldLayout = barrier.Discard ? VK_IMAGE_LAYOUT_UNDEFINED : image->Layout;
+			image->Layout = dst.Layout;
+			image->LastAccess = barrier.Access;
+
+			imageBarriers[imageBarrierCount++] =
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = src.Stages,
+				.srcAccessMask = src.Access & ~s_ReadAccessMask,
+				.dstStageMask = dst.Stages,
+				.dstAccessMask = dst.Access,
+				.oldLayout = image->OldLayout,
+				.newLayout = image->Layout,
+				.image = image->Allocation.Resource,
+				.subresourceRange = {
+					.aspectMask = image->AspectFlags,
+					.baseMipLevel = 0,
+					.levelCount = image->MipLevels,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+			};
+		}
+
+		auto bufferBarriers = Aura::StackAlloc<VkBufferMemoryBarrier2>(buffers.Count());
+		uint32_t bufferBarrierCount = 0;
+
+		for (const auto& barrier : buffers)
+		{
+			auto buffer = barrier.Target;
+			auto lastAccess = std::exchange(buffer->LastAccess, barrier.Access);
+
+			// Buffers have no layout, so there's nothing to do unless a previous command touched them
+			if (lastAccess == ResourceAccess::None || (lastAccess == barrier.Access && IsReadOnlyAccess(barrier.Access)))
+			{
+				continue;
+			}
+
+			auto src = ResourceAccessToVulkanAccess(lastAccess);
+			auto dst = ResourceAccessToVulkanAccess(barrier.Access);
+
+			bufferBarriers[bufferBarrierCount++] =
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				.srcStageMask = src.Stages,
+				.srcAccessMask = src.Access & ~s_ReadAccessMask,
+				.dstStageMask = dst.Stages,
+				.dstAccessMask = dst.Access,
+				.buffer = buffer->Allocation.Resource,
+				.offset = 0,
+				.size = VK_WHOLE_SIZE,
+			};
+		}
+
+		if (imageBarrierCount == 0 && bufferBarrierCount == 0)
 		{
 			return;
 		}
 
-		image->OldLayout = image->Layout;
-		image->Layout = newLayout;
-
-		VkImageMemoryBarrier2 imageBarrier =
-		{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-			.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
-			.srcAccessMask = 0,
-			.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
-			.dstAccessMask = 0,
-			.oldLayout = image->OldLayout,
-			.newLayout = image->Layout,
-			.image = image->Allocation.Resource,
-			.subresourceRange = {
-				.aspectMask = image->AspectFlags,
-				.baseMipLevel = 0,
-				.levelCount = 1,
-				.baseArrayLayer = 0,
-				.layerCount = 1,
-			},
-		};
+		m_Impl->Commands.Barriers += imageBarrierCount + bufferBarrierCount;
 
 		VkDependencyInfo dependencyInfo =
 		{
 			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-			.imageMemoryBarrierCount = 1,
-			.pImageMemoryBarriers = &imageBarrier,
+			.bufferMemoryBarrierCount = bufferBarrierCount,
+			.pBufferMemoryBarriers = bufferBarriers.Data(),
+			.imageMemoryBarrierCount = imageBarrierCount,
+			.pImageMemoryBarriers = imageBarriers.Data(),
 		};
 
 		vkCmdPipelineBarrier2(m_Impl->Resource, &dependencyInfo);
 	}
 
+	void CommandList::TransitionImage(Image image, ImageLayout layout) const
+	{
+		// NOTE(Peter): Images can't be transitioned to UNDEFINED, discard their contents with a Discard barrier instead
+		YukiAssert(layout != ImageLayout::Undefined);
+
+		ResourceAccess access = ResourceAccess::General;
+
+		switch (layout)
+		{
+		case ImageLayout::Undefined: break;
+		case ImageLayout::General: access = ResourceAccess::General; break;
+		case ImageLayout::AttachmentOptimal:
+			access = image->AspectFlags & VK_IMAGE_ASPECT_DEPTH_BIT ? ResourceAccess::DepthAttachmentWrite : ResourceAccess::ColorAttachmentWrite;
+			break;
+		case ImageLayout::TransferSrc: access = ResourceAccess::TransferRead; break;
+		case ImageLayout::TransferDst: access = ResourceAccess::TransferWrite; break;
+		case ImageLayout::ShaderReadOnlyOptimal: access = ResourceAccess::ShaderRead; break;
+		case ImageLayout::Present: access = ResourceAccess::Present; break;
+		}
+
+		Barrier({ { image, access } });
+	}
+
 	void CommandList::BlitImage(Image dest, Image src) const
 	{
 		VkImageBlit2 imageBlit =
@@ -172,6 +349,15 @@ namespace Yuki {
 
 	void CommandList::BindDescriptorHeap(DescriptorHeap heap, GraphicsPipeline pipeline) const
 	{
+		if (m_Impl->BoundDescriptorSet == heap->Set && m_Impl->BoundDescriptorSetLayout == pipeline->Layout)
+		{
+			m_Impl->Statistics.ElidedDescriptorHeapBinds++;
+			return;
+		}
+
+		m_Impl->BoundDescriptorSet = heap->Set;
+		m_Impl->BoundDescriptorSetLayout = pipeline->Layout;
+
 		vkCmdBindDescriptorSets(
 			m_Impl->Resource,
 			VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -192,9 +378,21 @@ namespace Yuki {
 		vkCmdBindVertexBuffers2(m_Impl->Resource, 0, 1, &buffer->Allocation.Resource, &offset, &size, &stride64);
 	}
 
-	void CommandList::BindIndexBuffer(Buffer buffer) const
+	void CommandList::BindIndexBuffer(Buffer buffer, IndexType type, uint64_t offset) const
 	{
-		vkCmdBindIndexBuffer(m_Impl->Resource, buffer->Allocation.Resource, 0, VK_INDEX_TYPE_UINT32);
+		auto indexType = IndexTypeToVkIndexType(type);
+
+		if (m_Impl->BoundIndexBuffer == buffer->Allocation.Resource && m_Impl->BoundIndexType == indexType && m_Impl->BoundIndexOffset == offset)
+		{
+			m_Impl->Statistics.ElidedIndexBufferBinds++;
+			return;
+		}
+
+		m_Impl->BoundIndexBuffer = buffer->Allocation.Resource;
+		m_Impl->BoundIndexType = indexType;
+		m_Impl->BoundIndexOffset = offset;
+
+		vkCmdBindIndexBuffer(m_Impl->Resource, buffer->Allocation.Resource, offset, indexType);
 	}
 
 	void CommandList::CopyBuffer(Buffer dest, Buffer src, uint32_t size, uint32_t srcOffset, uint32_t destOffset) const
@@ -217,10 +415,23 @@ namespace Yuki {
 		};
 
 		vkCmdCopyBuffer2(m_Impl->Resource, &copyInfo);
+		m_Impl->Commands.CopiedBytes += size;
+
+		// The next barrier on dest has to wait for the copy, even if dest had never been used before
+		dest->LastAccess = ResourceAccess::TransferWrite;
+
+		// NOTE(Peter): The copy targets the buffer's current VkBuffer, so it can't be moved until the copy has been submitted and is done
+		if (auto defragmenter = dest->Context->Defragmenter)
+		{
+			defragmenter->RecordWrite(dest);
+			m_Impl->WrittenBuffers.push_back(dest);
+		}
 	}
 
-	void CommandList::CopyBufferToImage(Image dest, Buffer src, uint32_t size, uint32_t srcOffset) const
+	void CommandList::CopyBufferToImage(Image dest, Buffer src, uint32_t size, uint32_t srcOffset, uint32_t mipLevel) const
 	{
+		YukiAssert(mipLevel < dest->MipLevels);
+
 		VkBufferImageCopy2 bufferImageCopy =
 		{
 			.sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
@@ -229,12 +440,18 @@ namespace Yuki {
 			.bufferImageHeight = 0,
 			.imageSubresource = {
 				.aspectMask = dest->AspectFlags,
-				.mipLevel = 0,
+				.mipLevel = mipLevel,
 				.baseArrayLayer = 0,
 				.layerCount = 1,
 			},
 			.imageOffset = { 0, 0, 0 },
-			.imageExtent = { static_cast<uint32_t>(dest->Width), static_cast<uint32_t>(dest->Height), 1 },
+
+			// Block compressed levels don't have to be a multiple of the block size, the buffer holds whole blocks regardless
+			.imageExtent = {
+				CalculateMipExtent(static_cast<uint32_t>(dest->Width), mipLevel),
+				CalculateMipExtent(static_cast<uint32_t>(dest->Height), mipLevel),
+				1
+			},
 		};
 
 		VkCopyBufferToImageInfo2 copyInfo =
@@ -248,21 +465,110 @@ namespace Yuki {
 		};
 
 		vkCmdCopyBufferToImage2(m_Impl->Resource, &copyInfo);
+		m_Impl->Commands.CopiedBytes += size;
+
+		dest->LastAccess = ResourceAccess::TransferWrite;
 	}
 
 	void CommandList::SetPushConstants(GraphicsPipeline pipeline, const void* data, uint32_t size) const
 	{
-		vkCmdPushConstants(m_Impl->Resource, pipeline->Layout, VK_SHADER_STAGE_ALL, 0, size, data);
+		YukiAssert(size <= MaxPushConstantSize && size % 4 == 0);
+
+		// Push constants of a different layout aren't guaranteed to still be valid
+		if (m_Impl->PushConstantLayout != pipeline->Layout)
+		{
+			m_Impl->PushConstantLayout = pipeline->Layout;
+			m_Impl->PushConstantSize = 0;
+		}
+
+		const auto* bytes = static_cast<const std::byte*>(data);
+		auto& shadow = m_Impl->PushConstants;
+		uint32_t uploadedBytes = 0;
+
+		// Walk the data one word at a time and upload each run of changed words with a single command,
+		// vkCmdPushConstants requires both the offset and the size to be a multiple of 4
+		auto wordChanged = [&](uint32_t wordOffset)
+		{
+			return wordOffset >= m_Impl->PushConstantSize || memcmp(&shadow[wordOffset], bytes + wordOffset, 4) != 0;
+		};
+
+		uint32_t offset = 0;
+		while (offset < size)
+		{
+			if (!wordChanged(offset))
+			{
+				offset += 4;
+				continue;
+			}
+
+			uint32_t rangeEnd = offset + 4;
+			while (rangeEnd < size && wordChanged(rangeEnd))
+			{
+				rangeEnd += 4;
+			}
+
+			uint32_t rangeSize = rangeEnd - offset;
+			vkCmdPushConstants(m_Impl->Resource, pipeline->Layout, VK_SHADER_STAGE_ALL, offset, rangeSize, bytes + offset);
+			memcpy(&shadow[offset], bytes + offset, rangeSize);
+			uploadedBytes += rangeSize;
+			offset = rangeEnd;
+		}
+
+		m_Impl->PushConstantSize = std::max(m_Impl->PushConstantSize, size);
+
+		if (uploadedBytes == 0)
+		{
+			m_Impl->Statistics.ElidedPushConstantUploads++;
+		}
+
+		m_Impl->Statistics.ElidedPushConstantBytes += size - uploadedBytes;
 	}
 
 	void CommandList::Draw(uint32_t vertexCount) const
 	{
 		vkCmdDraw(m_Impl->Resource, vertexCount, 1, 0, 0);
+		m_Impl->Commands.DrawCalls++;
+	}
+
+	void CommandList::DrawIndexed(uint32_t indexCount, uint32_t instanceIndex, uint32_t firstIndex) const
+	{
+		vkCmdDrawIndexed(m_Impl->Resource, indexCount, 1, firstIndex, 0, instanceIndex);
+		m_Impl->Commands.DrawCalls++;
+		m_Impl->Commands.IndicesDrawn += indexCount;
+	}
+
+	void CommandList::ExecuteSecondaries(Aura::Span<CommandList> secondaries) const
+	{
+		AuraStackPoint();
+
+		if (secondaries.IsEmpty())
+		{
+			return;
+		}
+
+		auto commandBuffers = Aura::StackAlloc<VkCommandBuffer>(secondaries.Count());
+		for (uint32_t i = 0; i < secondaries.Count(); i++)
+		{
+			Vulkan::CheckResult(vkEndCommandBuffer(secondaries[i]->Resource));
+			commandBuffers[i] = secondaries[i]->Resource;
+
+			m_Impl->Statistics += secondaries[i]->Statistics;
+			m_Impl->Commands += secondaries[i]->Commands;
+			secondaries[i]->Statistics = {};
+			secondaries[i]->Commands = {};
+		}
+
+		vkCmdExecuteCommands(m_Impl->Resource, commandBuffers.Count(), commandBuffers.Data());
+
+		m_Impl->ResetState();
 	}
 
-	void CommandList::DrawIndexed(uint32_t indexCount, uint32_t instanceIndex) const
+	void CommandList::WriteTimestamp(TimestampQueryPool pool, uint32_t index) const
 	{
-		vkCmdDrawIndexed(m_Impl->Resource, indexCount, 1, 0, 0, instanceIndex);
+		YukiAssert(m_Impl->TimestampMask != 0);
+
+		pool->ValidBitMasks[index] = m_Impl->TimestampMask;
+		vkCmdWriteTimestamp2(m_Impl->Resource, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pool->Resource, index);
 	}
 
 	CommandPool CommandPool::Create(RHIContext context, Queue queue)
@@ -270,6 +576,9 @@ namespace Yuki {
 		auto* impl = new Impl();
 		impl->Context = context;
 
+		uint32_t validBits = queue->TimestampValidBits;
+		impl->TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
 		VkCommandPoolCreateInfo poolInfo =
 		{
 			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
@@ -292,32 +601,112 @@ namespace Yuki {
 	{
 		vkResetCommandPool(m_Impl->Context->Device, m_Impl->Resource, 0);
 		m_Impl->NextList = 0;
+		m_Impl->NextSecondaryList = 0;
 	}
 
-	CommandList CommandPool::NewList() const
+	StateCacheStatistics CommandPool::GetStateCacheStatistics() const
 	{
-		if (m_Impl->NextList >= m_Impl->AllocatedLists.size())
+		StateCacheStatistics result;
+
+		for (uint32_t i = 0; i < m_Impl->NextList; i++)
 		{
-			auto* cmd = new CommandList::Impl();
+			result += m_Impl->AllocatedLists[i]->Statistics;
+		}
 
-			VkCommandBufferAllocateInfo bufferInfo =
-			{
-				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-				.pNext = nullptr,
-				.commandPool = m_Impl->Resource,
-				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-				.commandBufferCount = 1,
-			};
+		// Executed secondaries have been folded into their primary already, this only picks up unexecuted ones
+		for (uint32_t i = 0; i < m_Impl->NextSecondaryList; i++)
+		{
+			result += m_Impl->AllocatedSecondaryLists[i]->Statistics;
+		}
+
+		return result;
+	}
 
-			Vulkan::CheckResult(vkAllocateCommandBuffers(m_Impl->Context->Device, &bufferInfo, &cmd->Resource));
+	CommandList CommandPool::Impl::AllocateList(VkCommandBufferLevel level)
+	{
+		auto* cmd = new CommandList::Impl();
 
-			m_Impl->AllocatedLists.push_back({ cmd });
+		VkCommandBufferAllocateInfo bufferInfo =
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.pNext = nullptr,
+			.commandPool = Resource,
+			.level = level,
+			.commandBufferCount = 1,
+		};
+
+		Vulkan::CheckResult(vkAllocateCommandBuffers(Context->Device, &bufferInfo, &cmd->Resource));
+		cmd->TimestampMask = TimestampMask;
+
+		return { cmd };
+	}
+
+	CommandList CommandPool::NewList() const
+	{
+		if (m_Impl->NextList >= m_Impl->AllocatedLists.size())
+		{
+			m_Impl->AllocatedLists.push_back(m_Impl->AllocateList(VK_COMMAND_BUFFER_LEVEL_PRIMARY));
 		}
 
 		auto cmd = m_Impl->AllocatedLists[m_Impl->NextList++];
+		cmd->ResetState();
+		cmd->Statistics = {};
+		cmd->Commands = {};
+		cmd->WrittenBuffers.clear();
+
 		VkCommandBufferBeginInfo beginInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, };
 		Vulkan::CheckResult(vkBeginCommandBuffer(cmd->Resource, &beginInfo));
 		return cmd;
 	}
 
+	CommandList CommandPool::NewSecondaryList(Aura::Span<ImageFormat> colorAttachmentFormats, ImageFormat depthAttachmentFormat) const
+	{
+		AuraStackPoint();
+
+		if (m_Impl->NextSecondaryList >= m_Impl->AllocatedSecondaryLists.size())
+		{
+			m_Impl->AllocatedSecondaryLists.push_back(m_Impl->AllocateList(VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+		}
+
+		auto cmd = m_Impl->AllocatedSecondaryLists[m_Impl->NextSecondaryList++];
+		cmd->ResetState();
+		cmd->Statistics = {};
+		cmd->Commands = {};
+		cmd->WrittenBuffers.clear();
+
+		auto formats = Aura::StackAlloc<VkFormat>(colorAttachmentFormats.Count());
+		for (uint32_t i = 0; i < colorAttachmentFormats.Count(); i++)
+		{
+			formats[i] = ImageFormatToVkFormat(colorAttachmentFormats[i]);
+		}
+
+		VkFormat depthFormat = ImageFormatToVkFormat(depthAttachmentFormat);
+		bool hasStencil = depthFormat != VK_FORMAT_UNDEFINED && (VkFormatToVkImageAspect(depthFormat) & VK_IMAGE_ASPECT_STENCIL_BIT);
+
+		VkCommandBufferInheritanceRenderingInfo renderingInfo =
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+			.colorAttachmentCount = formats.Count(),
+			.pColorAttachmentFormats = formats.Data(),
+			.depthAttachmentFormat = depthFormat,
+			.stencilAttachmentFormat = hasStencil ? depthFormat : VK_FORMAT_UNDEFINED,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+		};
+
+		VkCommandBufferInheritanceInfo inheritanceInfo =
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.pNext = &renderingInfo,
+		};
+
+		VkCommandBufferBeginInfo beginInfo =
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+			.pInheritanceInfo = &inheritanceInfo,
+		};
+		Vulkan::CheckResult(vkBeginCommandBuffer(cmd->Resource, &beginInfo));
+		return cmd;
+	}
+
 }
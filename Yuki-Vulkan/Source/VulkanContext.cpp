@@ -89,6 +89,7 @@ namespace Yuki {
 			queue->Index = i;
 			queue->Flags = bestFamily.queueFlags;
 			queue->Priority = 1.0f;
+			queue->TimestampValidBits = bestFamily.timestampValidBits;
 			result.push_back({ queue });
 		}
 
@@ -186,6 +187,8 @@ namespace Yuki {
 		vkGetPhysicalDeviceProperties(impl->PhysicalDevice, &physicalDeviceProperties);
 		WriteLine("GPU: {}", physicalDeviceProperties.deviceName);
 
+		impl->TimestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+
 		// Create a logical device
 		impl->Queues.append_range(RequestVulkanQueues({ impl }, VK_QUEUE_GRAPHICS_BIT, 1));
 
@@ -207,19 +210,79 @@ namespace Yuki {
 
 		std::vector<const char*> deviceExtensions = {
 			VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-			//VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME
 		};
 
-		/*VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures =
+		std::vector<VkExtensionProperties> supportedDeviceExtensions;
+		Vulkan::Enumerate(vkEnumerateDeviceExtensionProperties, supportedDeviceExtensions, impl->PhysicalDevice, static_cast<const char*>(nullptr));
+
+		auto isExtensionSupported = [&](std::string_view name)
+		{
+			return std::ranges::any_of(supportedDeviceExtensions, [name](const VkExtensionProperties& extension)
+			{
+				return std::string_view(extension.extensionName) == name;
+			});
+		};
+
+		// Lets VMA report the actual usage and budget of every heap instead of estimating them
+		bool memoryBudgetSupported = isExtensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+		if (memoryBudgetSupported)
+		{
+			deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		}
+
+		// Lets textures be written straight from the CPU, without staging buffers or queue submissions
+		VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures =
 		{
 			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
-			.hostImageCopy = VK_TRUE
-		};*/
+		};
+
+		if (isExtensionSupported(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME))
+		{
+			VkPhysicalDeviceFeatures2 supportedFeatures2 =
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &hostImageCopyFeatures,
+			};
+
+			vkGetPhysicalDeviceFeatures2(impl->PhysicalDevice, &supportedFeatures2);
+			impl->HostImageCopySupported = hostImageCopyFeatures.hostImageCopy;
+		}
+
+		if (impl->HostImageCopySupported)
+		{
+			deviceExtensions.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+
+			VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties =
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT,
+			};
+
+			VkPhysicalDeviceProperties2 properties2 =
+			{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+				.pNext = &hostImageCopyProperties,
+			};
+
+			vkGetPhysicalDeviceProperties2(impl->PhysicalDevice, &properties2);
+
+			std::vector<VkImageLayout> copyDstLayouts(hostImageCopyProperties.copyDstLayoutCount);
+			hostImageCopyProperties.pCopyDstLayouts = copyDstLayouts.data();
+			vkGetPhysicalDeviceProperties2(impl->PhysicalDevice, &properties2);
+
+			// NOTE(Peter): Writing in the layout the image is sampled in saves a transition, general is always supported
+			if (std::ranges::contains(copyDstLayouts, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL))
+			{
+				impl->HostImageCopyLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			}
+		}
+
+		WriteLine("Host image copy: {}", impl->HostImageCopySupported ? "supported" : "not supported");
 
 		VkPhysicalDeviceVulkan13Features features13 =
 		{
 			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
-			//.pNext = &hostImageCopyFeatures,
+			.pNext = impl->HostImageCopySupported ? &hostImageCopyFeatures : nullptr,
 			.synchronization2 = VK_TRUE,
 			.dynamicRendering = VK_TRUE,
 		};
@@ -241,15 +304,20 @@ namespace Yuki {
 			.runtimeDescriptorArray = VK_TRUE,
 			.scalarBlockLayout = VK_TRUE,
 			.imagelessFramebuffer = VK_TRUE,
+			.hostQueryReset = VK_TRUE,
 			.timelineSemaphore = VK_TRUE,
 			.bufferDeviceAddress = VK_TRUE,
 		};
 
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(impl->PhysicalDevice, &supportedFeatures);
+
 		VkPhysicalDeviceFeatures2 features =
 		{
 			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
 			.pNext = &features12,
 			.features = {
+				.textureCompressionBC = supportedFeatures.textureCompressionBC,
 				.shaderInt64 = VK_TRUE		
 			}
 		};
@@ -283,7 +351,7 @@ namespace Yuki {
 			vkGetDeviceQueue2(impl->Device, &queueInfo, &queue->Queue);
 		}
 
-		impl->Allocator = VulkanMemoryAllocator::Create(impl->Instance, impl->PhysicalDevice, impl->Device);
+		impl->Allocator = VulkanMemoryAllocator::Create(impl->Instance, impl->PhysicalDevice, impl->Device, memoryBudgetSupported);
 		impl->Compiler = Aura::Unique<ShaderCompiler>::New();
 
 		return { impl };
@@ -303,4 +371,46 @@ namespace Yuki {
 		vkDestroyInstance(m_Impl->Instance, nullptr);
 	}
 
+	RHIStatistics RHIContext::GetStatistics() const
+	{
+		std::scoped_lock lock(m_Impl->StatisticsMutex);
+		return m_Impl->Statistics;
+	}
+
+	RHIStatistics RHIContext::ResetStatistics() const
+	{
+		std::scoped_lock lock(m_Impl->StatisticsMutex);
+		return std::exchange(m_Impl->Statistics, {});
+	}
+
+	MemoryReport RHIContext::GetMemoryReport() const
+	{
+		return m_Impl->Allocator.GetMemoryReport();
+	}
+
+	void RHIContext::SetAssetPack(const AssetPack* pack) const
+	{
+		m_Impl->Compiler->SetAssetPack(pack);
+	}
+
+	bool RHIContext::IsHostImageCopySupported(ImageFormat format) const
+	{
+		if (!m_Impl->HostImageCopySupported)
+		{
+			return false;
+		}
+
+		VkFormatProperties3 properties3 = { .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3 };
+		VkFormatProperties2 properties = { .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2, .pNext = &properties3 };
+		vkGetPhysicalDeviceFormatProperties2(m_Impl->PhysicalDevice, ImageFormatToVkFormat(format), &properties);
+		return properties3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT;
+	}
+
+	bool RHIContext::IsImageFormatSupported(ImageFormat format) const
+	{
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(m_Impl->PhysicalDevice, ImageFormatToVkFormat(format), &properties);
+		return properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+	}
+
 }
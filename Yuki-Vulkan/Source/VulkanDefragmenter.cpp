@@ -0,0 +1,311 @@
+#include "VulkanRHI.hpp"
+
+namespace Yuki {
+
+	MemoryDefragmenter MemoryDefragmenter::Create(RHIContext context, Queue queue, uint64_t maxBytesPerFrame)
+	{
+		YukiAssert(!context->Defragmenter);
+
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->TargetQueue = queue;
+		impl->Pool = CommandPool::Create(context, queue);
+		impl->CopyFence = Fence::Create(context);
+		impl->MaxBytesPerPass = maxBytesPerFrame;
+		impl->UnusedBytesBaseline = context->Allocator.GetUnusedBlockBytes();
+
+		context->Defragmenter = { impl };
+		return { impl };
+	}
+
+	void MemoryDefragmenter::Destroy()
+	{
+		if (m_Impl->IsPassPending)
+		{
+			m_Impl->CopyFence.Wait(m_Impl->PassFenceValue);
+			m_Impl->EndPass();
+		}
+
+		if (m_Impl->Defragmentation)
+		{
+			vmaEndDefragmentation(m_Impl->Context->Allocator.GetVmaAllocator(), m_Impl->Defragmentation, nullptr);
+		}
+
+		m_Impl->Context->Defragmenter = {};
+
+		m_Impl->CopyFence.Destroy();
+		m_Impl->Pool.Destroy();
+		delete m_Impl;
+	}
+
+	void MemoryDefragmenter::Update(Fence frameFence)
+	{
+		if (m_Impl->IsPassPending)
+		{
+			// The copies are usually done by the next frame, if not we'll just try again
+			if (m_Impl->CopyFence.GetCurrentValue() < m_Impl->PassFenceValue)
+			{
+				return;
+			}
+
+			m_Impl->EndPass();
+		}
+
+		if (!m_Impl->Defragmentation)
+		{
+			uint64_t unusedBytes = m_Impl->Context->Allocator.GetUnusedBlockBytes();
+			m_Impl->UnusedBytesBaseline = std::min(m_Impl->UnusedBytesBaseline, unusedBytes);
+
+			// NOTE(Peter): Blocks are rarely full even right after defragmenting, so we only start over once
+			//              freeing and allocating has left at least another pass worth of holes behind
+			if (unusedBytes < m_Impl->UnusedBytesBaseline + m_Impl->MaxBytesPerPass)
+			{
+				return;
+			}
+
+			VmaDefragmentationInfo defragmentationInfo =
+			{
+				.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+				.maxBytesPerPass = m_Impl->MaxBytesPerPass,
+			};
+
+			Vulkan::CheckResult(vmaBeginDefragmentation(m_Impl->Context->Allocator.GetVmaAllocator(), &defragmentationInfo, &m_Impl->Defragmentation));
+		}
+
+		m_Impl->BeginPass(frameFence);
+	}
+
+	Fence MemoryDefragmenter::GetFence() const { return m_Impl->CopyFence; }
+
+	DefragmentationStatistics MemoryDefragmenter::GetStatistics() const { return m_Impl->Statistics; }
+
+	void Handle<MemoryDefragmenter>::Impl::BeginPass(Fence frameFence)
+	{
+		auto allocator = Context->Allocator.GetVmaAllocator();
+
+		std::unique_lock lock(MovesMutex);
+
+		VkResult result = vmaBeginDefragmentationPass(allocator, Defragmentation, &PassInfo);
+
+		if (result == VK_SUCCESS)
+		{
+			VmaDefragmentationStats stats;
+			vmaEndDefragmentation(allocator, Defragmentation, &stats);
+			Defragmentation = VK_NULL_HANDLE;
+
+			Statistics.BytesFreed += stats.bytesFreed;
+			Statistics.BlocksFreed += stats.deviceMemoryBlocksFreed;
+			UnusedBytesBaseline = Context->Allocator.GetUnusedBlockBytes();
+			return;
+		}
+
+		YukiAssert(result == VK_INCOMPLETE);
+
+		Pool.Reset();
+		auto commandList = Pool.NewList();
+
+		for (uint32_t i = 0; i < PassInfo.moveCount; i++)
+		{
+			auto& move = PassInfo.pMoves[i];
+
+			VmaAllocationInfo allocationInfo;
+			vmaGetAllocationInfo(allocator, move.srcAllocation, &allocationInfo);
+
+			// Images, aliasing memory and mapped buffers don't have user data
+			auto* buffer = static_cast<Buffer::Impl*>(allocationInfo.pUserData);
+
+			if (!buffer || HasPendingWrite(buffer))
+			{
+				move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+				continue;
+			}
+
+			VkBufferCreateInfo bufferInfo =
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+				.size = buffer->Size,
+				.usage = buffer->Usage,
+				.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			};
+
+			VkBuffer newBuffer;
+			Vulkan::CheckResult(vkCreateBuffer(Context->Device, &bufferInfo, nullptr, &newBuffer));
+			Vulkan::CheckResult(vmaBindBufferMemory(allocator, move.dstTmpAllocation, newBuffer));
+
+			VkBufferCopy region =
+			{
+				.srcOffset = 0,
+				.dstOffset = 0,
+				.size = buffer->Size,
+			};
+
+			vkCmdCopyBuffer(commandList->Resource, buffer->Allocation.Resource, newBuffer, 1, &region);
+			commandList->Commands.CopiedBytes += buffer->Size;
+
+			Moves.push_back({ buffer, buffer->Allocation.Resource, VK_NULL_HANDLE, i });
+
+			// NOTE(Peter): Anything recorded from now on uses the new buffer, which is why later submits have to wait for the copies
+			buffer->Allocation.Resource = newBuffer;
+
+			VkBufferDeviceAddressInfo addressInfo =
+			{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+				.buffer = newBuffer
+			};
+			buffer->Address = vkGetBufferDeviceAddress(Context->Device, &addressInfo);
+
+			Statistics.BytesMoved += buffer->Size;
+			Statistics.AllocationsMoved++;
+		}
+
+		commandList.End();
+
+		if (Moves.empty())
+		{
+			// Nothing VMA wanted to move can be moved, ending the pass lets it pick other allocations or give up
+			result = vmaEndDefragmentationPass(allocator, Defragmentation, &PassInfo);
+
+			if (result == VK_SUCCESS)
+			{
+				vmaEndDefragmentation(allocator, Defragmentation, nullptr);
+				Defragmentation = VK_NULL_HANDLE;
+				UnusedBytesBaseline = Context->Allocator.GetUnusedBlockBytes();
+			}
+
+			return;
+		}
+
+		// NOTE(Peter): Submitting tracks writes, which takes the lock again
+		lock.unlock();
+
+		// The previous frame may still be writing the buffers we're copying from
+		TargetQueue.SubmitCommandLists({ commandList }, { frameFence }, { CopyFence });
+		PassFenceValue = CopyFence.GetValue();
+		IsPassPending = true;
+	}
+
+	void Handle<MemoryDefragmenter>::Impl::EndPass()
+	{
+		auto allocator = Context->Allocator.GetVmaAllocator();
+
+		std::scoped_lock lock(MovesMutex);
+
+		// The copies waited for every frame that could've used the old buffers, so nothing on the GPU references them anymore
+		for (const auto& move : Moves)
+		{
+			vkDestroyBuffer(Context->Device, move.OldResource, nullptr);
+
+			if (move.NewResource)
+			{
+				vkDestroyBuffer(Context->Device, move.NewResource, nullptr);
+			}
+		}
+
+		VkResult result = vmaEndDefragmentationPass(allocator, Defragmentation, &PassInfo);
+
+		for (const auto& move : Moves)
+		{
+			if (move.Target)
+			{
+				vmaGetAllocationInfo(allocator, move.Target->Allocation.Allocation, &move.Target->Allocation.AllocationInfo);
+			}
+		}
+
+		Moves.clear();
+		IsPassPending = false;
+
+		if (result == VK_SUCCESS)
+		{
+			VmaDefragmentationStats stats;
+			vmaEndDefragmentation(allocator, Defragmentation, &stats);
+			Defragmentation = VK_NULL_HANDLE;
+
+			Statistics.BytesFreed += stats.bytesFreed;
+			Statistics.BlocksFreed += stats.deviceMemoryBlocksFreed;
+			UnusedBytesBaseline = Context->Allocator.GetUnusedBlockBytes();
+		}
+	}
+
+	void Handle<MemoryDefragmenter>::Impl::DestroyBuffer(Buffer::Impl* buffer)
+	{
+		std::scoped_lock lock(MovesMutex);
+
+		PendingWrites.erase(Buffer{ buffer }.GetID());
+
+		auto it = std::ranges::find(Moves, buffer, &BufferMove::Target);
+
+		if (it == Moves.end())
+		{
+			Context->Allocator.DestroyBuffer(buffer->Allocation);
+			return;
+		}
+
+		// NOTE(Peter): VMA frees both the old and the new place of the allocation when the pass ends. The copy may still be
+		//              writing the new buffer, so it's destroyed along with the old one once the pass ends.
+		PassInfo.pMoves[it->MoveIndex].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+		it->Target = nullptr;
+		it->NewResource = buffer->Allocation.Resource;
+
+		Context->Allocator.ForgetAllocation(buffer->Allocation.Allocation);
+	}
+
+	void Handle<MemoryDefragmenter>::Impl::RecordWrite(Buffer::Impl* buffer)
+	{
+		std::scoped_lock lock(MovesMutex);
+		PendingWrites[Buffer{ buffer }.GetID()] = {};
+	}
+
+	void Handle<MemoryDefragmenter>::Impl::TrackWrites(Aura::Span<CommandList> commandLists, SubmitBatch::FenceValue completion)
+	{
+		std::scoped_lock lock(MovesMutex);
+
+		for (auto commandList : commandLists)
+		{
+			for (auto buffer : commandList->WrittenBuffers)
+			{
+				if (completion.Target)
+				{
+					PendingWrites[buffer.GetID()] = completion;
+				}
+				else
+				{
+					PendingWrites.erase(buffer.GetID());
+				}
+			}
+		}
+	}
+
+	void Handle<MemoryDefragmenter>::Impl::ForgetFence(Fence fence)
+	{
+		std::scoped_lock lock(MovesMutex);
+
+		// A fence can only be destroyed once nothing is going to signal it anymore, so its writes are done
+		std::erase_if(PendingWrites, [&](const auto& entry) { return entry.second.Target == fence; });
+	}
+
+	// NOTE(Peter): Only called from BeginPass, with MovesMutex held
+	bool Handle<MemoryDefragmenter>::Impl::HasPendingWrite(Buffer::Impl* buffer)
+	{
+		auto it = PendingWrites.find(Buffer{ buffer }.GetID());
+
+		if (it == PendingWrites.end())
+		{
+			return false;
+		}
+
+		// Recorded but not submitted yet
+		if (!it->second.Target)
+		{
+			return true;
+		}
+
+		if (it->second.Target.GetCurrentValue() < it->second.Value)
+		{
+			return true;
+		}
+
+		PendingWrites.erase(it);
+		return false;
+	}
+
+}
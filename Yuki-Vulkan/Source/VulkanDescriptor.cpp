@@ -104,6 +104,7 @@ namespace Yuki {
 		};
 
 		vkUpdateDescriptorSets(m_Impl->Context->Device, 1, &writeDescriptor, 0, nullptr);
+		m_Impl->Context->AddStatistics({ .DescriptorWrites = 1 });
 	}
 
 	void DescriptorHeap::WriteSampler(uint32_t index, Sampler sampler)
@@ -125,5 +126,6 @@ namespace Yuki {
 		};
 
 		vkUpdateDescriptorSets(m_Impl->Context->Device, 1, &writeDescriptor, 0, nullptr);
+		m_Impl->Context->AddStatistics({ .DescriptorWrites = 1 });
 	}
 }
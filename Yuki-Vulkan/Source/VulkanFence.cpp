@@ -28,6 +28,11 @@ namespace Yuki {
 
 	void Fence::Destroy()
 	{
+		if (m_Impl->Context->Defragmenter)
+		{
+			m_Impl->Context->Defragmenter->ForgetFence(*this);
+		}
+
 		vkDestroySemaphore(m_Impl->Context->Device, m_Impl->Resource, nullptr);
 		delete m_Impl;
 	}
@@ -2,28 +2,18 @@
 
 namespace Yuki {
 
-	Image Image::Create(RHIContext context, const ImageConfig& config)
+	static VkImageCreateInfo MakeImageCreateInfo(const ImageConfig& config)
 	{
-		auto* impl = new Impl();
-		impl->Context = context;
-		impl->Width = config.Width;
-		impl->Height = config.Height;
-		impl->Format = ImageFormatToVkFormat(config.Format);
-		impl->OldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		impl->Layout = VK_IMAGE_LAYOUT_UNDEFINED;
-		impl->AspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
-
-		VkImageCreateInfo imageInfo =
-		{
+		return {
 			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
 			.imageType = VK_IMAGE_TYPE_2D,
-			.format = impl->Format,
+			.format = ImageFormatToVkFormat(config.Format),
 			.extent = {
-				.width = static_cast<uint32_t>(impl->Width),
-				.height = static_cast<uint32_t>(impl->Height),
+				.width = config.Width,
+				.height = config.Height,
 				.depth = 1
 			},
-			.mipLevels = 1,
+			.mipLevels = config.MipLevels,
 			.arrayLayers = 1,
 			.samples = VK_SAMPLE_COUNT_1_BIT,
 			.tiling = VK_IMAGE_TILING_OPTIMAL,
@@ -31,8 +21,44 @@ namespace Yuki {
 			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
 		};
+	}
+
+	static Image::Impl* NewImageImpl(RHIContext context, const ImageConfig& config)
+	{
+		YukiAssert(!(config.Usage & ImageUsage::HostTransfer) || context.IsHostImageCopySupported(config.Format));
+
+		auto* impl = new Image::Impl();
+		impl->Context = context;
+		impl->Width = config.Width;
+		impl->Height = config.Height;
+		impl->MipLevels = config.MipLevels;
+		impl->Format = ImageFormatToVkFormat(config.Format);
+		impl->OldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		impl->Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		impl->AspectFlags = VkFormatToVkImageAspect(impl->Format);
+
+		context->AddStatistics({ .ImagesCreated = 1 });
+		return impl;
+	}
 
-		impl->Allocation = context->Allocator.CreateImage(imageInfo);
+	Image Image::Create(RHIContext context, const ImageConfig& config)
+	{
+		auto* impl = NewImageImpl(context, config);
+		impl->Allocation = context->Allocator.CreateImage(MakeImageCreateInfo(config), config.Category);
+
+		if (config.CreateDefaultView)
+		{
+			impl->DefaultView = ImageView::Create(context, { impl });
+		}
+
+		return { impl };
+	}
+
+	Image Image::CreateAliased(RHIContext context, const ImageConfig& config, AliasingMemory memory, uint64_t offset)
+	{
+		auto* impl = NewImageImpl(context, config);
+		impl->Allocation = context->Allocator.CreateAliasingImage(MakeImageCreateInfo(config), memory->Allocation, offset);
+		impl->OwnsMemory = false;
 
 		if (config.CreateDefaultView)
 		{
@@ -49,12 +75,131 @@ namespace Yuki {
 			m_Impl->DefaultView.Destroy();
 		}
 
-		m_Impl->Context->Allocator.DestroyImage(m_Impl->Allocation);
+		if (m_Impl->OwnsMemory)
+		{
+			m_Impl->Context->Allocator.DestroyImage(m_Impl->Allocation);
+		}
+		else
+		{
+			vkDestroyImage(m_Impl->Context->Device, m_Impl->Allocation.Resource, nullptr);
+		}
+
+		m_Impl->Context->AddStatistics({ .ImagesDestroyed = 1 });
+		delete m_Impl;
+	}
+
+	ImageMemoryRequirements Image::GetMemoryRequirements(RHIContext context, const ImageConfig& config)
+	{
+		auto imageInfo = MakeImageCreateInfo(config);
+
+		VkDeviceImageMemoryRequirements requirementsInfo =
+		{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+			.pCreateInfo = &imageInfo,
+		};
+
+		VkMemoryRequirements2 requirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+		vkGetDeviceImageMemoryRequirements(context->Device, &requirementsInfo, &requirements);
+
+		return {
+			.Size = requirements.memoryRequirements.size,
+			.Alignment = requirements.memoryRequirements.alignment,
+			.MemoryTypeBits = requirements.memoryRequirements.memoryTypeBits,
+		};
+	}
+
+	AliasingMemory AliasingMemory::Create(RHIContext context, uint64_t size, uint32_t memoryTypeBits, MemoryCategory category)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+
+		// NOTE(Peter): Images are placed at offsets aligned to their own requirements, so the block itself only needs the largest alignment we'd ever hand out
+		VkMemoryRequirements requirements =
+		{
+			.size = size,
+			.alignment = 64 * 1024,
+			.memoryTypeBits = memoryTypeBits,
+		};
+
+		impl->Allocation = context->Allocator.AllocateMemory(requirements, category);
+		return { impl };
+	}
+
+	void AliasingMemory::Destroy()
+	{
+		m_Impl->Context->Allocator.FreeMemory(m_Impl->Allocation);
 		delete m_Impl;
 	}
 
 	ImageView Image::GetDefaultView() const { return m_Impl->DefaultView; }
 
+	void Image::WriteFromHost(const void* data, uint64_t size, uint32_t mipLevel) const
+	{
+		YukiAssert(mipLevel < m_Impl->MipLevels);
+
+		auto context = m_Impl->Context;
+		auto layout = context->HostImageCopyLayout;
+
+		// NOTE(Peter): Host transitions happen immediately, so the first write moves every level into the layout the copies need
+		if (m_Impl->Layout != layout)
+		{
+			VkHostImageLayoutTransitionInfoEXT transitionInfo =
+			{
+				.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+				.image = m_Impl->Allocation.Resource,
+				.oldLayout = m_Impl->Layout,
+				.newLayout = layout,
+				.subresourceRange = {
+					.aspectMask = m_Impl->AspectFlags,
+					.baseMipLevel = 0,
+					.levelCount = m_Impl->MipLevels,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+			};
+
+			Vulkan::CheckResult(vkTransitionImageLayoutEXT(context->Device, 1, &transitionInfo));
+
+			m_Impl->OldLayout = m_Impl->Layout;
+			m_Impl->Layout = layout;
+
+			// Submitting work is enough to make host writes visible to it, the first read doesn't need a barrier
+			m_Impl->LastAccess = layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ? ResourceAccess::ShaderRead : ResourceAccess::General;
+		}
+
+		VkMemoryToImageCopyEXT region =
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+			.pHostPointer = data,
+			.memoryRowLength = 0,
+			.memoryImageHeight = 0,
+			.imageSubresource = {
+				.aspectMask = m_Impl->AspectFlags,
+				.mipLevel = mipLevel,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+			.imageOffset = { 0, 0, 0 },
+			.imageExtent = {
+				CalculateMipExtent(static_cast<uint32_t>(m_Impl->Width), mipLevel),
+				CalculateMipExtent(static_cast<uint32_t>(m_Impl->Height), mipLevel),
+				1
+			},
+		};
+
+		VkCopyMemoryToImageInfoEXT copyInfo =
+		{
+			.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+			.dstImage = m_Impl->Allocation.Resource,
+			.dstImageLayout = layout,
+			.regionCount = 1,
+			.pRegions = &region,
+		};
+
+		Vulkan::CheckResult(vkCopyMemoryToImageEXT(context->Device, &copyInfo));
+		context->AddStatistics({ .HostCopiedBytes = size });
+	}
+
 	ImageView ImageView::Create(RHIContext context, Image image)
 	{
 		auto* impl = new Impl();
@@ -70,7 +215,7 @@ namespace Yuki {
 			.subresourceRange = {
 				.aspectMask = image->AspectFlags,
 				.baseMipLevel = 0,
-				.levelCount = 1,
+				.levelCount = image->MipLevels,
 				.baseArrayLayer = 0,
 				.layerCount = 1,
 			},
@@ -107,7 +252,7 @@ namespace Yuki {
 			.compareEnable = VK_FALSE,
 			.compareOp = VK_COMPARE_OP_GREATER,
 			.minLod = 0,
-			.maxLod = 1,
+			.maxLod = VK_LOD_CLAMP_NONE,
 		};
 
 		Vulkan::CheckResult(vkCreateSampler(context->Device, &samplerInfo, nullptr, &impl->Resource));
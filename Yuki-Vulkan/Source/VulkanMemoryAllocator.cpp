@@ -5,15 +5,54 @@
 
 #include "VulkanCommon.hpp"
 
+#include <mutex>
+
 namespace Yuki {
 
+	struct AllocationRecord
+	{
+		MemoryCategory Category;
+		uint64_t Size;
+	};
+
 	template<>
 	struct Handle<VulkanMemoryAllocator>::Impl
 	{
 		VmaAllocator Allocator;
+
+		// NOTE(Peter): Every live allocation is tracked so we can report usage per category and dump leaks on shutdown
+		std::mutex AllocationsMutex;
+		std::unordered_map<VmaAllocation, AllocationRecord> Allocations;
+		std::array<MemoryCategoryReport, MemoryCategoryCount> Categories;
+
+		void Track(VmaAllocation allocation, const VmaAllocationInfo& info, MemoryCategory category)
+		{
+			vmaSetAllocationName(Allocator, allocation, MemoryCategoryToString(category).data());
+
+			std::scoped_lock lock(AllocationsMutex);
+			Allocations[allocation] = { category, info.size };
+
+			auto& report = Categories[std::to_underlying(category)];
+			report.Bytes += info.size;
+			report.Allocations++;
+		}
+
+		void Untrack(VmaAllocation allocation)
+		{
+			std::scoped_lock lock(AllocationsMutex);
+
+			auto it = Allocations.find(allocation);
+			YukiAssert(it != Allocations.end());
+
+			auto& report = Categories[std::to_underlying(it->second.Category)];
+			report.Bytes -= it->second.Size;
+			report.Allocations--;
+
+			Allocations.erase(it);
+		}
 	};
 
-	VulkanMemoryAllocator VulkanMemoryAllocator::Create(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device)
+	VulkanMemoryAllocator VulkanMemoryAllocator::Create(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, bool memoryBudgetSupported)
 	{
 		auto* impl = new Impl();
 
@@ -31,6 +70,11 @@ namespace Yuki {
 			.vulkanApiVersion = VK_API_VERSION_1_3,
 		};
 
+		if (memoryBudgetSupported)
+		{
+			allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+		}
+
 		Vulkan::CheckResult(vmaCreateAllocator(&allocatorInfo, &impl->Allocator));
 
 		return { impl };
@@ -38,11 +82,29 @@ namespace Yuki {
 
 	void VulkanMemoryAllocator::Destroy()
 	{
+		if (!m_Impl->Allocations.empty())
+		{
+			WriteLine("{} GPU allocations were never freed:", LogLevel::Warn, m_Impl->Allocations.size());
+
+			for (uint32_t i = 0; i < MemoryCategoryCount; i++)
+			{
+				const auto& report = m_Impl->Categories[i];
+
+				if (report.Allocations > 0)
+				{
+					WriteLine("    {}: {} allocations, {} bytes", LogLevel::Warn, MemoryCategoryToString(static_cast<MemoryCategory>(i)), report.Allocations, report.Bytes);
+				}
+			}
+		}
+
+		// NOTE(Peter): VMA asserts on the leaked allocations below, they're deliberately not freed here since the buffers
+		//              and images bound to them are still alive, freeing the memory under them trips the validation layers
+
 		vmaDestroyAllocator(m_Impl->Allocator);
 		delete m_Impl;
 	}
 
-	GPUAllocation<VkImage> VulkanMemoryAllocator::CreateImage(const VkImageCreateInfo& createInfo) const
+	GPUAllocation<VkImage> VulkanMemoryAllocator::CreateImage(const VkImageCreateInfo& createInfo, MemoryCategory category) const
 	{
 		VmaAllocationCreateInfo allocationInfo =
 		{
@@ -58,19 +120,53 @@ namespace Yuki {
 			&allocation.Allocation,
 			&allocation.AllocationInfo
 		));
+
+		m_Impl->Track(allocation.Allocation, allocation.AllocationInfo, category);
 		return allocation;
 	}
 
 	void VulkanMemoryAllocator::DestroyImage(const GPUAllocation<VkImage>& allocation) const
 	{
+		m_Impl->Untrack(allocation.Allocation);
 		vmaDestroyImage(m_Impl->Allocator, allocation.Resource, allocation.Allocation);
 	}
 
-	GPUAllocation<VkBuffer> VulkanMemoryAllocator::CreateBuffer(const VkBufferCreateInfo& createInfo, BufferUsage usage) const
+	VmaAllocation VulkanMemoryAllocator::AllocateMemory(const VkMemoryRequirements& requirements, MemoryCategory category) const
+	{
+		VmaAllocationCreateInfo allocationInfo =
+		{
+			.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		};
+
+		VmaAllocation allocation;
+		VmaAllocationInfo info;
+		Vulkan::CheckResult(vmaAllocateMemory(m_Impl->Allocator, &requirements, &allocationInfo, &allocation, &info));
+
+		m_Impl->Track(allocation, info, category);
+		return allocation;
+	}
+
+	void VulkanMemoryAllocator::FreeMemory(VmaAllocation allocation) const
+	{
+		m_Impl->Untrack(allocation);
+		vmaFreeMemory(m_Impl->Allocator, allocation);
+	}
+
+	GPUAllocation<VkImage> VulkanMemoryAllocator::CreateAliasingImage(const VkImageCreateInfo& createInfo, VmaAllocation memory, uint64_t offset) const
+	{
+		GPUAllocation<VkImage> allocation{};
+		allocation.Allocation = memory;
+		vmaGetAllocationInfo(m_Impl->Allocator, memory, &allocation.AllocationInfo);
+		Vulkan::CheckResult(vmaCreateAliasingImage2(m_Impl->Allocator, memory, offset, &createInfo, &allocation.Resource));
+		return allocation;
+	}
+
+	GPUAllocation<VkBuffer> VulkanMemoryAllocator::CreateBuffer(const VkBufferCreateInfo& createInfo, BufferUsage usage, MemoryCategory category, void* userData) const
 	{
 		VmaAllocationCreateInfo allocationInfo =
 		{
 			.usage = VMA_MEMORY_USAGE_AUTO,
+			.pUserData = userData,
 		};
 
 		if (usage & BufferUsage::Mapped)
@@ -102,13 +198,65 @@ namespace Yuki {
 			&allocation.Allocation,
 			&allocation.AllocationInfo
 		));
+
+		m_Impl->Track(allocation.Allocation, allocation.AllocationInfo, category);
 		return allocation;
 	}
 
 	void VulkanMemoryAllocator::DestroyBuffer(const GPUAllocation<VkBuffer>& allocation) const
 	{
+		m_Impl->Untrack(allocation.Allocation);
 		vmaDestroyBuffer(m_Impl->Allocator, allocation.Resource, allocation.Allocation);
 	}
 
+	void VulkanMemoryAllocator::ForgetAllocation(VmaAllocation allocation) const
+	{
+		m_Impl->Untrack(allocation);
+	}
+
+	MemoryReport VulkanMemoryAllocator::GetMemoryReport() const
+	{
+		const VkPhysicalDeviceMemoryProperties* memoryProperties;
+		vmaGetMemoryProperties(m_Impl->Allocator, &memoryProperties);
+
+		// Without VK_EXT_memory_budget VMA estimates the budget from the heap sizes and only knows about its own usage
+		std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets;
+		vmaGetHeapBudgets(m_Impl->Allocator, budgets.data());
+
+		MemoryReport report;
+
+		for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++)
+		{
+			report.Heaps.push_back({
+				.Usage = budgets[i].usage,
+				.Budget = budgets[i].budget,
+				.AllocatedBytes = budgets[i].statistics.allocationBytes,
+				.DeviceLocal = (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0,
+			});
+		}
+
+		std::scoped_lock lock(m_Impl->AllocationsMutex);
+		report.Categories = m_Impl->Categories;
+		return report;
+	}
+
+	uint64_t VulkanMemoryAllocator::GetUnusedBlockBytes() const
+	{
+		const VkPhysicalDeviceMemoryProperties* memoryProperties;
+		vmaGetMemoryProperties(m_Impl->Allocator, &memoryProperties);
+
+		std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets;
+		vmaGetHeapBudgets(m_Impl->Allocator, budgets.data());
+
+		uint64_t unusedBytes = 0;
+		for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++)
+		{
+			unusedBytes += budgets[i].statistics.blockBytes - budgets[i].statistics.allocationBytes;
+		}
+		return unusedBytes;
+	}
+
+	VmaAllocator VulkanMemoryAllocator::GetVmaAllocator() const { return m_Impl->Allocator; }
+
 
 }
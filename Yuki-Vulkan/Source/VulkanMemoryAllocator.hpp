@@ -16,14 +16,33 @@ namespace Yuki {
 
 	struct VulkanMemoryAllocator : Handle<VulkanMemoryAllocator>
 	{
-		static VulkanMemoryAllocator Create(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device);
+		static VulkanMemoryAllocator Create(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, bool memoryBudgetSupported);
+
+		// Logs every allocation that's still alive
 		void Destroy();
 
-		GPUAllocation<VkImage> CreateImage(const VkImageCreateInfo& createInfo) const;
+		GPUAllocation<VkImage> CreateImage(const VkImageCreateInfo& createInfo, MemoryCategory category) const;
 		void DestroyImage(const GPUAllocation<VkImage>& allocation) const;
 
-		GPUAllocation<VkBuffer> CreateBuffer(const VkBufferCreateInfo& createInfo, BufferUsage usage) const;
+		VmaAllocation AllocateMemory(const VkMemoryRequirements& requirements, MemoryCategory category) const;
+		void FreeMemory(VmaAllocation allocation) const;
+
+		// NOTE(Peter): The returned allocation is the memory the image was placed in, it's still owned by the caller
+		GPUAllocation<VkImage> CreateAliasingImage(const VkImageCreateInfo& createInfo, VmaAllocation memory, uint64_t offset) const;
+
+		// Allocations with user data can be moved by the defragmenter, the user data is the owning Buffer::Impl
+		GPUAllocation<VkBuffer> CreateBuffer(const VkBufferCreateInfo& createInfo, BufferUsage usage, MemoryCategory category, void* userData = nullptr) const;
 		void DestroyBuffer(const GPUAllocation<VkBuffer>& allocation) const;
+
+		// Stops reporting an allocation that VMA frees by itself, like one abandoned during defragmentation
+		void ForgetAllocation(VmaAllocation allocation) const;
+
+		MemoryReport GetMemoryReport() const;
+
+		// Bytes in allocated memory blocks that no allocation is using
+		uint64_t GetUnusedBlockBytes() const;
+
+		VmaAllocator GetVmaAllocator() const;
 	};
 
 }
@@ -38,11 +38,17 @@ namespace Yuki {
 			colorAttachmentBlendStates[i].colorWriteMask = 0xF;
 		}
 
+		VkFormat depthAttachmentFormat = ImageFormatToVkFormat(config.DepthAttachmentFormat);
+		bool hasDepth = depthAttachmentFormat != VK_FORMAT_UNDEFINED;
+		bool hasStencil = VkFormatToVkImageAspect(depthAttachmentFormat) & VK_IMAGE_ASPECT_STENCIL_BIT;
+
 		VkPipelineRenderingCreateInfo renderingInfo =
 		{
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
 			.colorAttachmentCount = colorAttachmentFormats.Count(),
 			.pColorAttachmentFormats = colorAttachmentFormats.Data(),
+			.depthAttachmentFormat = depthAttachmentFormat,
+			.stencilAttachmentFormat = hasStencil ? depthAttachmentFormat : VK_FORMAT_UNDEFINED,
 		};
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
@@ -80,7 +86,14 @@ namespace Yuki {
 
 		VkPipelineDepthStencilStateCreateInfo depthStencilInfo =
 		{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+			.depthTestEnable = hasDepth && config.DepthTest,
+			.depthWriteEnable = hasDepth && config.DepthWrite,
+			.depthCompareOp = CompareOpToVkCompareOp(config.DepthCompareOp),
+			.depthBoundsTestEnable = VK_FALSE,
+			.stencilTestEnable = VK_FALSE,
+			.minDepthBounds = 0.0f,
+			.maxDepthBounds = 1.0f,
 		};
 
 		VkPipelineColorBlendStateCreateInfo colorBlendInfo =
@@ -0,0 +1,85 @@
+#include "VulkanRHI.hpp"
+
+#include <Aura/Stack.hpp>
+
+namespace Yuki {
+
+	TimestampQueryPool TimestampQueryPool::Create(RHIContext context, uint32_t count)
+	{
+		auto* impl = new Impl();
+		impl->Context = context;
+		impl->Count = count;
+		impl->ValidBitMasks.resize(count, ~0ull);
+
+		VkQueryPoolCreateInfo poolInfo =
+		{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = count,
+		};
+
+		Vulkan::CheckResult(vkCreateQueryPool(context->Device, &poolInfo, nullptr, &impl->Resource));
+
+		// Queries start out in an undefined state and can't be written before they've been reset
+		vkResetQueryPool(context->Device, impl->Resource, 0, count);
+
+		return { impl };
+	}
+
+	void TimestampQueryPool::Destroy()
+	{
+		vkDestroyQueryPool(m_Impl->Context->Device, m_Impl->Resource, nullptr);
+		delete m_Impl;
+	}
+
+	void TimestampQueryPool::Reset(uint32_t first, uint32_t count) const
+	{
+		vkResetQueryPool(m_Impl->Context->Device, m_Impl->Resource, first, count);
+	}
+
+	bool TimestampQueryPool::GetResults(uint32_t first, Aura::Span<uint64_t> timestamps) const
+	{
+		AuraStackPoint();
+
+		// NOTE(Peter): Every query is followed by its availability, which lets us check them without VK_QUERY_RESULT_WAIT_BIT
+		uint32_t count = timestamps.Count();
+		auto results = Aura::StackAlloc<uint64_t>(count * 2);
+
+		VkResult result = vkGetQueryPoolResults(
+			m_Impl->Context->Device,
+			m_Impl->Resource,
+			first,
+			count,
+			count * 2 * sizeof(uint64_t),
+			results.Data(),
+			2 * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+		);
+
+		if (result == VK_NOT_READY)
+		{
+			return false;
+		}
+
+		Vulkan::CheckResult(result);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (results[i * 2 + 1] == 0)
+			{
+				return false;
+			}
+		}
+
+		double period = m_Impl->Context->TimestampPeriod;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint64_t ticks = results[i * 2] & m_Impl->ValidBitMasks[first + i];
+			timestamps[i] = static_cast<uint64_t>(static_cast<double>(ticks) * period);
+		}
+
+		return true;
+	}
+
+}
@@ -133,54 +133,155 @@ namespace Yuki {
 			};
 
 			Vulkan::CheckResult(vkQueueSubmit2(m_Impl->Queue, 1, &submitInfo, nullptr));
+			m_Impl->Context->AddStatistics({ .Submits = 1 });
 		}
 	}
 
 	void Queue::SubmitCommandLists(Aura::Span<CommandList> commandLists, Aura::Span<Fence> waits, Aura::Span<Fence> signals) const
 	{
-		AuraStackPoint();
+		SubmitBatch batch;
+		batch.Add(*this, commandLists, waits, signals);
+		batch.Flush();
+	}
 
-		auto commandListSubmits = Aura::StackAlloc<VkCommandBufferSubmitInfo>(commandLists.Count());
-		for (uint32_t i = 0; i < commandLists.Count(); i++)
+	void SubmitBatch::Add(Queue queue, Aura::Span<CommandList> commandLists, Aura::Span<Fence> waits, Aura::Span<Fence> signals)
+	{
+		Submits.push_back({
+			.Target = queue,
+			.CommandListOffset = static_cast<uint32_t>(CommandLists.size()),
+			.CommandListCount = commandLists.Count(),
+			.WaitOffset = static_cast<uint32_t>(Waits.size()),
+			.WaitCount = waits.Count(),
+			.SignalOffset = static_cast<uint32_t>(Signals.size()),
+			.SignalCount = signals.Count(),
+		});
+
+		CommandLists.insert(CommandLists.end(), commandLists.Begin(), commandLists.End());
+
+		// Waits have to be resolved before the signals, otherwise waiting and signalling
+		// the same fence would wait for the value we're about to signal
+		for (auto fence : waits)
 		{
-			vkEndCommandBuffer(commandLists[i]->Resource);
+			Waits.push_back({ fence, fence->Value });
+		}
 
-			commandListSubmits[i].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
-			commandListSubmits[i].commandBuffer = commandLists[i]->Resource;
+		for (auto fence : signals)
+		{
+			Signals.push_back({ fence, ++fence->Value });
 		}
 
-		auto waitSubmits = Aura::StackAlloc<VkSemaphoreSubmitInfo>(waits.Count());
-		for (uint32_t i = 0; i < waits.Count(); i++)
+		// NOTE(Peter): Writes submitted without a signal can't be tracked, they're assumed to be ordered before the frame fence
+		if (auto defragmenter = queue->Context->Defragmenter)
 		{
-			waitSubmits[i].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
-			waitSubmits[i].semaphore = waits[i]->Resource;
-			waitSubmits[i].value = waits[i]->Value;
-			waitSubmits[i].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			defragmenter->TrackWrites(commandLists, signals.IsEmpty() ? FenceValue{} : Signals[Signals.size() - signals.Count()]);
 		}
+	}
 
-		auto signalSubmits = Aura::StackAlloc<VkSemaphoreSubmitInfo>(signals.Count());
-		for (uint32_t i = 0; i < signals.Count(); i++)
+	void SubmitBatch::Flush()
+	{
+		AuraStackPoint();
+
+		if (Submits.empty())
 		{
-			signalSubmits[i].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
-			signalSubmits[i].semaphore = signals[i]->Resource;
-			signalSubmits[i].value = ++signals[i]->Value;
-			signalSubmits[i].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			return;
 		}
 
-		VkSubmitInfo2 submitInfo =
+		RHIStatistics statistics;
+
+		auto commandListSubmits = Aura::StackAlloc<VkCommandBufferSubmitInfo>(static_cast<uint32_t>(CommandLists.size()));
+		for (uint32_t i = 0; i < CommandLists.size(); i++)
 		{
-			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
-			.pNext = nullptr,
-			.flags = 0,
-			.waitSemaphoreInfoCount = waitSubmits.Count(),
-			.pWaitSemaphoreInfos = waitSubmits.Data(),
-			.commandBufferInfoCount = commandListSubmits.Count(),
-			.pCommandBufferInfos = commandListSubmits.Data(),
-			.signalSemaphoreInfoCount = signalSubmits.Count(),
-			.pSignalSemaphoreInfos = signalSubmits.Data(),
+			commandListSubmits[i] =
+			{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+				.commandBuffer = CommandLists[i]->Resource,
+			};
+
+			statistics += std::exchange(CommandLists[i]->Commands, {});
+		}
+
+		auto toSemaphoreSubmit = [](const FenceValue& fenceValue)
+		{
+			return VkSemaphoreSubmitInfo
+			{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.semaphore = fenceValue.Target->Resource,
+				.value = fenceValue.Value,
+				.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			};
 		};
 
-		Vulkan::CheckResult(vkQueueSubmit2(m_Impl->Queue, 1, &submitInfo, nullptr));
+		auto waitSubmits = Aura::StackAlloc<VkSemaphoreSubmitInfo>(static_cast<uint32_t>(Waits.size()));
+		for (uint32_t i = 0; i < Waits.size(); i++)
+		{
+			waitSubmits[i] = toSemaphoreSubmit(Waits[i]);
+		}
+
+		auto signalSubmits = Aura::StackAlloc<VkSemaphoreSubmitInfo>(static_cast<uint32_t>(Signals.size()));
+		for (uint32_t i = 0; i < Signals.size(); i++)
+		{
+			signalSubmits[i] = toSemaphoreSubmit(Signals[i]);
+		}
+
+		auto submitInfos = Aura::StackAlloc<VkSubmitInfo2>(static_cast<uint32_t>(Submits.size()));
+		auto submitted = Aura::StackAlloc<bool>(static_cast<uint32_t>(Submits.size()));
+
+		for (uint32_t i = 0; i < Submits.size(); i++)
+		{
+			submitted[i] = false;
+		}
+
+		for (uint32_t i = 0; i < Submits.size(); i++)
+		{
+			if (submitted[i])
+			{
+				continue;
+			}
+
+			auto queue = Submits[i].Target;
+			uint32_t submitCount = 0;
+
+			// Gather every submit for this queue, keeping the order they were added in
+			for (uint32_t j = i; j < Submits.size(); j++)
+			{
+				const auto& submit = Submits[j];
+
+				if (submitted[j] || submit.Target != queue)
+				{
+					continue;
+				}
+
+				submitInfos[submitCount++] =
+				{
+					.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+					.pNext = nullptr,
+					.flags = 0,
+					.waitSemaphoreInfoCount = submit.WaitCount,
+					.pWaitSemaphoreInfos = waitSubmits.Data() + submit.WaitOffset,
+					.commandBufferInfoCount = submit.CommandListCount,
+					.pCommandBufferInfos = commandListSubmits.Data() + submit.CommandListOffset,
+					.signalSemaphoreInfoCount = submit.SignalCount,
+					.pSignalSemaphoreInfos = signalSubmits.Data() + submit.SignalOffset,
+				};
+
+				submitted[j] = true;
+			}
+
+			Vulkan::CheckResult(vkQueueSubmit2(queue->Queue, submitCount, submitInfos.Data(), nullptr));
+			statistics.Submits++;
+		}
+
+		Submits[0].Target->Context->AddStatistics(statistics);
+
+		Submits.clear();
+		CommandLists.clear();
+		Waits.clear();
+		Signals.clear();
+	}
+
+	bool Queue::SupportsTimestamps() const
+	{
+		return m_Impl->TimestampValidBits > 0;
 	}
 
 	void Queue::Present(Aura::Span<Swapchain> swapchains, Aura::Span<Fence> waits) const
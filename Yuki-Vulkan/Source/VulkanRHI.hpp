@@ -7,6 +7,10 @@
 #include <Engine/Core/Window.hpp>
 #include <Engine/RHI/RHI.hpp>
 
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
 namespace Yuki {
 
 	template<>
@@ -18,11 +22,28 @@ namespace Yuki {
 		VkPhysicalDevice PhysicalDevice;
 		VkDevice Device;
 
+		// Nanoseconds per timestamp tick
+		float TimestampPeriod;
+
+		// VK_EXT_host_image_copy, images written from the host are left in HostImageCopyLayout
+		bool HostImageCopySupported = false;
+		VkImageLayout HostImageCopyLayout = VK_IMAGE_LAYOUT_GENERAL;
+
 		std::vector<Queue> Queues;
 
 		VulkanMemoryAllocator Allocator;
+		MemoryDefragmenter Defragmenter;
 
 		Aura::Unique<ShaderCompiler> Compiler;
+
+		std::mutex StatisticsMutex;
+		RHIStatistics Statistics;
+
+		void AddStatistics(const RHIStatistics& statistics)
+		{
+			std::scoped_lock lock(StatisticsMutex);
+			Statistics += statistics;
+		}
 	};
 
 	template<>
@@ -65,14 +86,55 @@ namespace Yuki {
 	{
 		switch (format)
 		{
+		case ImageFormat::None: return VK_FORMAT_UNDEFINED;
 		case ImageFormat::RGBA8Unorm: return VK_FORMAT_R8G8B8A8_UNORM;
 		case ImageFormat::BGRA8Unorm: return VK_FORMAT_B8G8R8A8_UNORM;
+		case ImageFormat::RGBA8Srgb: return VK_FORMAT_R8G8B8A8_SRGB;
+		case ImageFormat::BGRA8Srgb: return VK_FORMAT_B8G8R8A8_SRGB;
+		case ImageFormat::D32SFloat: return VK_FORMAT_D32_SFLOAT;
+		case ImageFormat::D24UnormS8UInt: return VK_FORMAT_D24_UNORM_S8_UINT;
+		case ImageFormat::BC1RGBAUnorm: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case ImageFormat::BC3RGBAUnorm: return VK_FORMAT_BC3_UNORM_BLOCK;
+		case ImageFormat::BC4RUnorm: return VK_FORMAT_BC4_UNORM_BLOCK;
+		case ImageFormat::BC5RGUnorm: return VK_FORMAT_BC5_UNORM_BLOCK;
+		case ImageFormat::BC7RGBAUnorm: return VK_FORMAT_BC7_UNORM_BLOCK;
+		case ImageFormat::BC1RGBASrgb: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+		case ImageFormat::BC3RGBASrgb: return VK_FORMAT_BC3_SRGB_BLOCK;
+		case ImageFormat::BC7RGBASrgb: return VK_FORMAT_BC7_SRGB_BLOCK;
 		}
 
 		YukiAssert(false);
 		return VK_FORMAT_UNDEFINED;
 	}
 
+	inline VkImageAspectFlags VkFormatToVkImageAspect(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_D32_SFLOAT: return VK_IMAGE_ASPECT_DEPTH_BIT;
+		case VK_FORMAT_D24_UNORM_S8_UINT: return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		default: return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
+	inline VkCompareOp CompareOpToVkCompareOp(CompareOp op)
+	{
+		switch (op)
+		{
+		case CompareOp::Never: return VK_COMPARE_OP_NEVER;
+		case CompareOp::Less: return VK_COMPARE_OP_LESS;
+		case CompareOp::Equal: return VK_COMPARE_OP_EQUAL;
+		case CompareOp::LessOrEqual: return VK_COMPARE_OP_LESS_OR_EQUAL;
+		case CompareOp::Greater: return VK_COMPARE_OP_GREATER;
+		case CompareOp::NotEqual: return VK_COMPARE_OP_NOT_EQUAL;
+		case CompareOp::GreaterOrEqual: return VK_COMPARE_OP_GREATER_OR_EQUAL;
+		case CompareOp::Always: return VK_COMPARE_OP_ALWAYS;
+		}
+
+		YukiAssert(false);
+		return VK_COMPARE_OP_MAX_ENUM;
+	}
+
 	inline VkImageUsageFlags ImageUsageToVkImageUsage(ImageUsage usage)
 	{
 		VkImageUsageFlags result = 0;
@@ -82,10 +144,66 @@ namespace Yuki {
 		if (usage & ImageUsage::TransferSrc) result |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 		if (usage & ImageUsage::TransferDst) result |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 		if (usage & ImageUsage::Sampled) result |= VK_IMAGE_USAGE_SAMPLED_BIT;
+		if (usage & ImageUsage::HostTransfer) result |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
 
 		return result;
 	}
 
+	struct VulkanAccess
+	{
+		VkPipelineStageFlags2 Stages;
+		VkAccessFlags2 Access;
+		VkImageLayout Layout;
+	};
+
+	inline VulkanAccess ResourceAccessToVulkanAccess(ResourceAccess access)
+	{
+		switch (access)
+		{
+		case ResourceAccess::None:
+			return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED };
+		case ResourceAccess::ColorAttachmentWrite:
+			return {
+				VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+				VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+				VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL
+			};
+		case ResourceAccess::DepthAttachmentWrite:
+			return {
+				VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+				VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL
+			};
+		case ResourceAccess::TransferRead:
+			return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+		case ResourceAccess::TransferWrite:
+			return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+		case ResourceAccess::ShaderRead:
+			return {
+				VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+			};
+		case ResourceAccess::IndexRead:
+			return { VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+		case ResourceAccess::Present:
+			// NOTE(Peter): Presentation is synchronized by the semaphores passed to Queue::Present
+			return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+		case ResourceAccess::General:
+			return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL };
+		}
+
+		YukiAssert(false);
+		return {};
+	}
+
+	inline bool IsReadOnlyAccess(ResourceAccess access)
+	{
+		return access == ResourceAccess::TransferRead ||
+			   access == ResourceAccess::ShaderRead ||
+			   access == ResourceAccess::IndexRead;
+	}
+
 	template<>
 	struct Handle<Image>::Impl
 	{
@@ -95,13 +213,25 @@ namespace Yuki {
 		VkFormat Format;
 		int32_t Width;
 		int32_t Height;
+		uint32_t MipLevels = 1;
 		VkImageLayout OldLayout;
 		VkImageLayout Layout;
 		VkImageAspectFlags AspectFlags;
+		ResourceAccess LastAccess = ResourceAccess::None;
+
+		// Aliased images are placed in an AliasingMemory and don't free the memory when destroyed
+		bool OwnsMemory = true;
 
 		ImageView DefaultView;
 	};
 
+	template<>
+	struct Handle<AliasingMemory>::Impl
+	{
+		RHIContext Context;
+		VmaAllocation Allocation;
+	};
+
 	template<>
 	struct Handle<ImageView>::Impl
 	{
@@ -118,6 +248,17 @@ namespace Yuki {
 		uint64_t Value;
 	};
 
+	template<>
+	struct Handle<TimestampQueryPool>::Impl
+	{
+		RHIContext Context;
+		VkQueryPool Resource;
+		uint32_t Count;
+
+		// The valid bits of the queue each query was last written on, the rest of a timestamp is undefined
+		std::vector<uint64_t> ValidBitMasks;
+	};
+
 	template<>
 	struct Handle<Queue>::Impl
 	{
@@ -127,6 +268,9 @@ namespace Yuki {
 		uint32_t Index;
 		VkQueueFlags Flags;
 		float Priority;
+
+		// 0 if the queue family can't write timestamps
+		uint32_t TimestampValidBits;
 	};
 
 	inline VkShaderStageFlagBits ShaderStageToVkShaderStage(ShaderStage stage)
@@ -168,14 +312,117 @@ namespace Yuki {
 	{
 		RHIContext Context;
 		GPUAllocation<VkBuffer> Allocation;
+		VkBufferUsageFlags Usage;
 		uint32_t Size;
 		uint64_t Address;
+		ResourceAccess LastAccess = ResourceAccess::None;
 	};
 
+	template<>
+	struct Handle<MemoryDefragmenter>::Impl
+	{
+		RHIContext Context;
+		Queue TargetQueue;
+		CommandPool Pool;
+		Fence CopyFence;
+		uint64_t MaxBytesPerPass;
+
+		VmaDefragmentationContext Defragmentation = VK_NULL_HANDLE;
+		VmaDefragmentationPassMoveInfo PassInfo;
+		uint64_t PassFenceValue = 0;
+		bool IsPassPending = false;
+
+		// Unused bytes in the memory blocks when the last defragmentation finished, a new one
+		// starts once there's at least a pass worth more of them
+		uint64_t UnusedBytesBaseline = 0;
+
+		struct BufferMove
+		{
+			// Null if the buffer was destroyed before the pass ended
+			Buffer::Impl* Target;
+			VkBuffer OldResource;
+
+			// Only set once the buffer has been destroyed, the copy may still be writing it until the pass ends
+			VkBuffer NewResource;
+
+			uint32_t MoveIndex;
+		};
+
+		// NOTE(Peter): Held while a pass begins or ends and while buffers are destroyed, VMA doesn't allow freeing an allocation that's being moved
+		std::mutex MovesMutex;
+		std::vector<BufferMove> Moves;
+
+		// Buffers written by lists that haven't been submitted yet (null fence) or by submits that may not have finished,
+		// e.g. uploads on a transfer queue. Their writes aren't ordered with the copies, which only wait for the frame fence,
+		// so they aren't moved until the fence reaches the value.
+		std::unordered_map<Buffer::ID, SubmitBatch::FenceValue> PendingWrites;
+
+		DefragmentationStatistics Statistics;
+
+		void BeginPass(Fence frameFence);
+		void EndPass();
+
+		// Buffers have to be destroyed through the defragmenter while it exists
+		void DestroyBuffer(Buffer::Impl* buffer);
+
+		// RecordWrite is called when a write is recorded, TrackWrites when it's submitted and ForgetFence before a fence is destroyed
+		void RecordWrite(Buffer::Impl* buffer);
+		void TrackWrites(Aura::Span<CommandList> commandLists, SubmitBatch::FenceValue completion);
+		void ForgetFence(Fence fence);
+
+		bool HasPendingWrite(Buffer::Impl* buffer);
+	};
+
+	inline VkIndexType IndexTypeToVkIndexType(IndexType type)
+	{
+		switch (type)
+		{
+		case IndexType::UInt16: return VK_INDEX_TYPE_UINT16;
+		case IndexType::UInt32: return VK_INDEX_TYPE_UINT32;
+		}
+
+		YukiAssert(false);
+		return VK_INDEX_TYPE_MAX_ENUM;
+	}
+
+	// NOTE(Peter): maxPushConstantsSize is guaranteed to be at least 128 bytes, we never need more than that
+	inline constexpr uint32_t MaxPushConstantSize = 128;
+	inline constexpr uint32_t MaxCachedViewports = 8;
+
 	template<>
 	struct Handle<CommandList>::Impl
 	{
 		VkCommandBuffer Resource;
+
+		// State cache, reset every time the list is handed out by the pool
+		VkPipeline BoundPipeline;
+		VkDescriptorSet BoundDescriptorSet;
+		VkPipelineLayout BoundDescriptorSetLayout;
+		VkBuffer BoundIndexBuffer;
+		VkIndexType BoundIndexType;
+		uint64_t BoundIndexOffset;
+
+		std::array<Viewport, MaxCachedViewports> BoundViewports;
+		uint32_t BoundViewportCount;
+
+		std::array<std::byte, MaxPushConstantSize> PushConstants;
+		VkPipelineLayout PushConstantLayout;
+		// Bytes past this haven't been uploaded yet and can't be compared against
+		uint32_t PushConstantSize;
+
+		StateCacheStatistics Statistics;
+
+		// Added to the context when the list is submitted
+		RHIStatistics Commands;
+
+		// Valid bits of the timestamps this list's queue writes, 0 if it can't write them
+		uint64_t TimestampMask;
+
+		// Buffers this list copies into while a defragmenter exists, so it doesn't move them while the copies are in flight
+		std::vector<Buffer> WrittenBuffers;
+
+		// Forgets all bound state, needed whenever Vulkan considers the command buffer state undefined
+		void ResetState();
 	};
 
 	template<>
@@ -183,9 +430,15 @@ namespace Yuki {
 	{
 		RHIContext Context;
 		VkCommandPool Resource;
+		uint64_t TimestampMask;
 
 		std::vector<CommandList> AllocatedLists;
 		uint32_t NextList = 0;
+
+		std::vector<CommandList> AllocatedSecondaryLists;
+		uint32_t NextSecondaryList = 0;
+
+		CommandList AllocateList(VkCommandBufferLevel level);
 	};
 
 	inline VkFilter ImageFilterToVkFilter(ImageFilter filter)
@@ -15,6 +15,8 @@ namespace Yuki {
 
 		m_InputSystem = { new InputSystem::Impl() };
 		m_InputSystem->Init();
+
+		m_IOService = Aura::Unique<IOService>::New();
 	}
 
 	void Application::Run()
@@ -41,12 +43,22 @@ namespace Yuki {
 
 			m_WindowSystem->PollEvents();
 			m_InputSystem->Update();
+			m_IOService->DispatchCompletions();
 
 			OnUpdate();
 		}
 
+		// NOTE(Peter): Reads in flight write into memory the application owns, so they have to be done before it starts tearing
+		//              things down. Their callbacks still run, with IOStatus::Cancelled, and may issue reads that are cancelled as well.
+		do
+		{
+			m_IOService->CancelAll();
+			m_IOService->WaitIdle();
+		} while (m_IOService->DispatchCompletions() > 0);
+
 		OnShutdown();
 
+		m_IOService = nullptr;
 		m_InputSystem->Shutdown();
 	}
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Engine/Input/InputSystem.hpp"
+#include "Engine/IO/IOService.hpp"
 
 #include <Aura/Unique.hpp>
 
@@ -38,6 +39,10 @@ namespace Yuki {
 		Aura::Unique<WindowSystem> m_WindowSystem = nullptr;
 		InputSystem m_InputSystem;
 
+		// Completion callbacks run every frame before OnUpdate. Every request is cancelled and its callback called before
+		// OnShutdown, the service is destroyed right after it.
+		Aura::Unique<IOService> m_IOService = nullptr;
+
 		Clock::time_point m_LastTime;
 		uint64_t m_AccumulatedFrames = 0;
 		Duration m_AccumulatedTime = Duration::zero();
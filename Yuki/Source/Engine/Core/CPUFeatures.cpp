@@ -0,0 +1,48 @@
+#include "CPUFeatures.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+namespace Yuki {
+
+	static bool QueryAVX2Support()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+	#if defined(_MSC_VER)
+		int32_t info[4];
+		__cpuid(info, 1);
+
+		bool hasOSXSave = info[2] & (1 << 27);
+		bool hasAVX = info[2] & (1 << 28);
+
+		if (!hasOSXSave || !hasAVX)
+		{
+			return false;
+		}
+
+		// Make sure the OS actually saves the YMM registers
+		if ((_xgetbv(0) & 0x6) != 0x6)
+		{
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return info[1] & (1 << 5);
+	#else
+		return __builtin_cpu_supports("avx2");
+	#endif
+#else
+		return false;
+#endif
+	}
+
+	bool IsAVX2Supported()
+	{
+		static const bool s_Supported = QueryAVX2Support();
+		return s_Supported;
+	}
+
+}
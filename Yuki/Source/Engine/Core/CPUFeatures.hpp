@@ -0,0 +1,8 @@
+#pragma once
+
+namespace Yuki {
+
+	// NOTE(Peter): Only queries the CPU the first time, cheap enough to call before every dispatch
+	bool IsAVX2Supported();
+
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <mutex>
 
 #include <Aura/Unique.hpp>
 #include <Aura/Arena.hpp>
@@ -15,6 +17,8 @@ namespace Yuki {
 		{ t.operator->() } -> std::same_as<typename T::Impl*>;
 	};
 
+	// NOTE(Peter): Handles get copied from multiple threads (e.g. when recording command lists in parallel),
+	//              so the counts are only ever modified through std::atomic_ref
 	struct HandleControlBlock
 	{
 		uint32_t RefCount;
@@ -24,14 +28,17 @@ namespace Yuki {
 	struct ControlBlockAllocator
 	{
 		inline static Aura::Unique<Aura::Arena> s_ControlBlockArena = Aura::Unique<Aura::Arena>::New(1 * 1024 * 1024);
+		inline static std::mutex s_ControlBlockMutex;
 
 		Aura::Arena::Block AllocateControlBlock() const
 		{
+			std::scoped_lock lock(s_ControlBlockMutex);
 			return s_ControlBlockArena->Allocate(sizeof(HandleControlBlock));
 		}
 
 		void DeallocateControlBlock(Aura::Arena::Block controlBlock)
 		{
+			std::scoped_lock lock(s_ControlBlockMutex);
 			s_ControlBlockArena->Free(controlBlock);
 		}
 	};
@@ -86,7 +93,7 @@ namespace Yuki {
 
 			if (m_ControlBlock)
 			{
-				m_ControlBlock->WeakReferences--;
+				std::atomic_ref(m_ControlBlock->WeakReferences).fetch_sub(1, std::memory_order_acq_rel);
 			}
 
 			m_Impl = other.m_Impl;
@@ -113,7 +120,7 @@ namespace Yuki {
 			if (!m_ControlBlock)
 				return;
 
-			m_ControlBlock->WeakReferences++;
+			std::atomic_ref(m_ControlBlock->WeakReferences).fetch_add(1, std::memory_order_relaxed);
 		}
 
 		void DecreaseRefCount()
@@ -121,9 +128,9 @@ namespace Yuki {
 			if (!m_ControlBlock)
 				return;
 
-			m_ControlBlock->WeakReferences--;
+			uint32_t weakReferences = std::atomic_ref(m_ControlBlock->WeakReferences).fetch_sub(1, std::memory_order_acq_rel) - 1;
 
-			if (m_ControlBlock->WeakReferences == 0 && m_ControlBlock->RefCount == 0)
+			if (weakReferences == 0 && std::atomic_ref(m_ControlBlock->RefCount).load(std::memory_order_acquire) == 0)
 			{
 				m_Allocator.DeallocateControlBlock(Aura::Arena::Block::From(m_ControlBlock));
 			}
@@ -202,7 +209,7 @@ namespace Yuki {
 			if (m_Impl == nullptr || m_ControlBlock == nullptr)
 				return;
 
-			m_ControlBlock->RefCount++;
+			std::atomic_ref(m_ControlBlock->RefCount).fetch_add(1, std::memory_order_relaxed);
 		}
 
 		void DecreaseRefCount()
@@ -210,11 +217,11 @@ namespace Yuki {
 			if (m_Impl == nullptr || m_ControlBlock == nullptr)
 				return;
 
-			if (--m_ControlBlock->RefCount == 0)
+			if (std::atomic_ref(m_ControlBlock->RefCount).fetch_sub(1, std::memory_order_acq_rel) == 1)
 			{
 				T{ m_Impl }.Destroy();
 
-				if (m_ControlBlock->WeakReferences == 0)
+				if (std::atomic_ref(m_ControlBlock->WeakReferences).load(std::memory_order_acquire) == 0)
 				{
 					m_Allocator.DeallocateControlBlock(Aura::Arena::Block::From(m_ControlBlock));
 				}
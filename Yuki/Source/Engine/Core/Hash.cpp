@@ -0,0 +1,51 @@
+#include "Hash.hpp"
+
+#include <cstring>
+
+namespace Yuki {
+
+	uint64_t HashBytes(const void* data, uint64_t size, uint64_t seed)
+	{
+		constexpr uint64_t m = 0xC6A4A7935BD1E995ull;
+		constexpr int32_t r = 47;
+
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		uint64_t hash = seed ^ (size * m);
+
+		uint64_t wordCount = size / 8;
+		for (uint64_t i = 0; i < wordCount; i++)
+		{
+			uint64_t word;
+			memcpy(&word, bytes + i * 8, sizeof(word));
+
+			word *= m;
+			word ^= word >> r;
+			word *= m;
+
+			hash ^= word;
+			hash *= m;
+		}
+
+		const uint8_t* tail = bytes + wordCount * 8;
+
+		switch (size & 7)
+		{
+		case 7: hash ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+		case 6: hash ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+		case 5: hash ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+		case 4: hash ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+		case 3: hash ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+		case 2: hash ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+		case 1:
+			hash ^= uint64_t(tail[0]);
+			hash *= m;
+		}
+
+		hash ^= hash >> r;
+		hash *= m;
+		hash ^= hash >> r;
+
+		return hash;
+	}
+
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+namespace Yuki {
+
+	// 64-bit MurmurHash2, fast enough to hash whole files while they're being loaded. Not meant to be cryptographically secure.
+	uint64_t HashBytes(const void* data, uint64_t size, uint64_t seed = 0);
+
+}
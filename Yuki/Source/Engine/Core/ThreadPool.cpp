@@ -0,0 +1,127 @@
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <memory>
+
+namespace Yuki {
+
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		m_Threads.reserve(threadCount);
+
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			m_Threads.emplace_back([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		for (auto& thread : m_Threads)
+		{
+			thread.request_stop();
+		}
+
+		m_JobAvailable.notify_all();
+		m_Threads.clear();
+	}
+
+	void ThreadPool::Submit(Job job)
+	{
+		{
+			std::scoped_lock lock(m_Mutex);
+			m_Jobs.push_back(std::move(job));
+		}
+
+		m_JobAvailable.notify_one();
+	}
+
+	void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		// NOTE(Peter): Shared with the helpers because a helper may only get to run after every index has been processed and
+		//              the call has returned, it has to find out there's nothing left to do without touching func
+		struct State
+		{
+			std::atomic<uint32_t> NextIndex = 0;
+			std::atomic<uint32_t> ActiveHelpers = 0;
+		};
+
+		auto state = std::make_shared<State>();
+
+		auto process = [count, &func](State& s)
+		{
+			for (uint32_t index = s.NextIndex.fetch_add(1); index < count; index = s.NextIndex.fetch_add(1))
+			{
+				func(index);
+			}
+		};
+
+		// The calling thread participates as well, so we never need more than count - 1 helpers
+		uint32_t helperCount = std::min(GetThreadCount(), count - 1);
+
+		for (uint32_t i = 0; i < helperCount; i++)
+		{
+			Submit([state, process]()
+			{
+				state->ActiveHelpers.fetch_add(1);
+				process(*state);
+
+				if (state->ActiveHelpers.fetch_sub(1) == 1)
+				{
+					state->ActiveHelpers.notify_all();
+				}
+			});
+		}
+
+		process(*state);
+
+		// Only waits for the helpers that picked up an index, the ones still queued won't find any work. This is what lets worker
+		// threads call ParallelFor, waiting for every helper could wait on jobs queued behind the worker itself.
+		for (uint32_t active = state->ActiveHelpers.load(); active != 0; active = state->ActiveHelpers.load())
+		{
+			state->ActiveHelpers.wait(active);
+		}
+	}
+
+	void ThreadPool::WaitIdle()
+	{
+		std::unique_lock lock(m_Mutex);
+		m_Idle.wait(lock, [this]() { return m_Jobs.empty() && m_RunningJobs == 0; });
+	}
+
+	void ThreadPool::WorkerLoop(std::stop_token stopToken)
+	{
+		while (true)
+		{
+			Job job;
+
+			{
+				std::unique_lock lock(m_Mutex);
+
+				if (!m_JobAvailable.wait(lock, stopToken, [this]() { return !m_Jobs.empty(); }))
+				{
+					return;
+				}
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+				m_RunningJobs++;
+			}
+
+			job();
+
+			{
+				std::scoped_lock lock(m_Mutex);
+				m_RunningJobs--;
+			}
+
+			m_Idle.notify_all();
+		}
+	}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Yuki {
+
+	class ThreadPool
+	{
+	public:
+		using Job = std::function<void()>;
+
+		explicit ThreadPool(uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void Submit(Job job);
+
+		// Calls func for every index in [0, count), spread across the worker threads and the calling thread.
+		// Returns once every index has been processed. Can be called from inside a job, nested loops never wait on queued jobs.
+		void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func);
+
+		// Blocks until every submitted job has finished
+		void WaitIdle();
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+	private:
+		void WorkerLoop(std::stop_token stopToken);
+
+	private:
+		std::vector<std::jthread> m_Threads;
+
+		std::mutex m_Mutex;
+		std::condition_variable_any m_JobAvailable;
+		std::condition_variable m_Idle;
+
+		std::deque<Job> m_Jobs;
+		uint32_t m_RunningJobs = 0;
+	};
+
+}
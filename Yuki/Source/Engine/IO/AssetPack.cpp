@@ -0,0 +1,367 @@
+#include "AssetPack.hpp"
+#include "LZ4.hpp"
+
+#include "Engine/Core/Hash.hpp"
+
+#include <cstring>
+#include <numeric>
+
+namespace Yuki {
+
+	static constexpr uint32_t s_PackMagic = 0x4B415059; // YPAK
+	static constexpr uint32_t s_PackVersion = 1;
+
+	// Assets start on a cache line so they can be read in place, e.g. copied straight into a staging buffer
+	static constexpr uint64_t s_AssetAlignment = 64;
+
+	// Compressed assets have to save at least 1/16th of their size, otherwise decompressing them isn't worth it
+	static constexpr uint64_t s_MinCompressionSavings = 16;
+
+	// Followed by the table of contents, the paths and the assets
+	struct AssetPackHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t Reserved;
+		uint64_t EntriesOffset;
+		uint64_t NamesOffset;
+		uint64_t NamesSize;
+	};
+
+	enum AssetPackEntryFlags : uint32_t
+	{
+		AssetPackEntryFlagCompressed = 1 << 0,
+	};
+
+	// Sorted by PathHash and then by path, so lookups binary search the table without touching the paths
+	struct AssetPackEntry
+	{
+		uint64_t PathHash;
+		uint64_t Offset;
+		uint64_t StoredSize;
+		uint64_t Size;
+		uint32_t NameOffset;
+		uint32_t NameLength;
+		uint32_t Flags;
+		uint32_t Reserved;
+	};
+
+	static uint64_t HashPath(std::string_view path)
+	{
+		return HashBytes(path.data(), path.size());
+	}
+
+	static uint64_t AlignAsset(uint64_t offset)
+	{
+		return (offset + s_AssetAlignment - 1) & ~(s_AssetAlignment - 1);
+	}
+
+	std::string AssetPack::NormalizePath(std::string_view path)
+	{
+		std::string result(path);
+
+		for (auto& c : result)
+		{
+			c = c == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		}
+
+		size_t start = 0;
+
+		while (start < result.size())
+		{
+			if (result.compare(start, 2, "./") == 0)
+			{
+				start += 2;
+			}
+			else if (result[start] == '/')
+			{
+				start++;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		return result.substr(start);
+	}
+
+	AssetPack::AssetPack(const std::filesystem::path& filepath)
+	{
+		auto file = FileIO::MapFile(filepath);
+
+		if (!file.IsValid() || file.GetSize() < sizeof(AssetPackHeader))
+		{
+			WriteLine("Can't open asset pack {}, the file doesn't exist or is too small.", LogLevel::Warn, filepath.string());
+			return;
+		}
+
+		AssetPackHeader header;
+		memcpy(&header, file.GetData(), sizeof(header));
+
+		uint64_t entriesEnd = header.EntriesOffset + uint64_t(header.EntryCount) * sizeof(AssetPackEntry);
+
+		// NOTE(Peter): The table is read in place, so it has to be aligned. Everything in it is validated once here
+		//              rather than on every lookup.
+		if (header.Magic != s_PackMagic || header.Version != s_PackVersion ||
+			header.EntriesOffset % alignof(AssetPackEntry) != 0 || entriesEnd > file.GetSize() ||
+			header.NamesOffset + header.NamesSize > file.GetSize())
+		{
+			WriteLine("Can't open asset pack {}, it isn't a pack or was made by a different version of the packer.", LogLevel::Warn, filepath.string());
+			return;
+		}
+
+		const auto* entries = reinterpret_cast<const AssetPackEntry*>(file.GetData() + header.EntriesOffset);
+
+		for (uint32_t i = 0; i < header.EntryCount; i++)
+		{
+			const auto& entry = entries[i];
+
+			bool isCompressed = entry.Flags & AssetPackEntryFlagCompressed;
+
+			if (entry.StoredSize > file.GetSize() || entry.Offset > file.GetSize() - entry.StoredSize || uint64_t(entry.NameOffset) + entry.NameLength > header.NamesSize ||
+				(!isCompressed && entry.StoredSize != entry.Size))
+			{
+				WriteLine("Can't open asset pack {}, it's corrupt.", LogLevel::Warn, filepath.string());
+				return;
+			}
+		}
+
+		m_Entries = entries;
+		m_EntryCount = header.EntryCount;
+		m_Names = reinterpret_cast<const char*>(file.GetData() + header.NamesOffset);
+		m_File = std::move(file);
+	}
+
+	const AssetPackEntry* AssetPack::Find(std::string_view path) const
+	{
+		if (!IsValid())
+		{
+			return nullptr;
+		}
+
+		auto normalizedPath = NormalizePath(path);
+		uint64_t hash = HashPath(normalizedPath);
+
+		const AssetPackEntry* end = m_Entries + m_EntryCount;
+		const AssetPackEntry* entry = std::lower_bound(m_Entries, end, hash, [](const AssetPackEntry& entry, uint64_t hash)
+		{
+			return entry.PathHash < hash;
+		});
+
+		// Paths are only compared if their hashes collide
+		for (; entry != end && entry->PathHash == hash; entry++)
+		{
+			if (std::string_view(m_Names + entry->NameOffset, entry->NameLength) == normalizedPath)
+			{
+				return entry;
+			}
+		}
+
+		return nullptr;
+	}
+
+	bool AssetPack::Contains(std::string_view path) const
+	{
+		return Find(path) != nullptr;
+	}
+
+	PackedAsset AssetPack::Read(std::string_view path) const
+	{
+		const AssetPackEntry* entry = Find(path);
+
+		if (!entry)
+		{
+			return {};
+		}
+
+		PackedAsset asset = { .View = m_File.GetView(entry->Offset, entry->StoredSize) };
+
+		if (entry->Flags & AssetPackEntryFlagCompressed)
+		{
+			asset.Decompressed.resize(entry->Size);
+
+			if (!LZ4::Decompress(asset.View.GetData(), entry->StoredSize, asset.Decompressed.data(), entry->Size))
+			{
+				WriteLine("Failed to decompress {} from an asset pack, the pack is corrupt.", LogLevel::Warn, path);
+				return {};
+			}
+		}
+
+		return asset;
+	}
+
+	PackedAsset LoadAsset(const AssetPack* pack, const std::filesystem::path& filepath)
+	{
+		if (pack)
+		{
+			if (auto asset = pack->Read(filepath.lexically_normal().generic_string()); asset.IsValid())
+			{
+				return asset;
+			}
+		}
+
+		return { .View = FileIO::MapFile(filepath) };
+	}
+
+	void AssetPackWriter::Add(std::string_view path, std::vector<std::byte> data, bool compress)
+	{
+		auto normalizedPath = AssetPack::NormalizePath(path);
+
+		if (auto it = m_EntryIndices.find(normalizedPath); it != m_EntryIndices.end())
+		{
+			m_Entries[it->second] = { std::move(normalizedPath), std::move(data), compress };
+			return;
+		}
+
+		m_EntryIndices[normalizedPath] = static_cast<uint32_t>(m_Entries.size());
+		m_Entries.push_back({ std::move(normalizedPath), std::move(data), compress });
+	}
+
+	bool AssetPackWriter::AddFile(const std::filesystem::path& filepath, std::string_view path, bool compress)
+	{
+		auto file = FileIO::MapFile(filepath);
+
+		if (!file.IsValid())
+		{
+			return false;
+		}
+
+		std::vector<std::byte> data(file.GetSize());
+
+		if (!data.empty())
+		{
+			memcpy(data.data(), file.GetData(), data.size());
+		}
+
+		Add(path, std::move(data), compress);
+		return true;
+	}
+
+	bool AssetPackWriter::Write(const std::filesystem::path& filepath, ThreadPool* threadPool) const
+	{
+		// Compressed data of every entry, empty if it's stored as is
+		std::vector<std::vector<std::byte>> compressed(m_Entries.size());
+
+		auto compressEntry = [&](uint32_t index)
+		{
+			const auto& entry = m_Entries[index];
+
+			if (!entry.Compress || entry.Data.empty())
+			{
+				return;
+			}
+
+			auto& result = compressed[index];
+			result.resize(LZ4::GetCompressBound(entry.Data.size()));
+
+			uint64_t size = LZ4::Compress(entry.Data.data(), entry.Data.size(), result.data(), result.size());
+
+			if (size == 0 || size > entry.Data.size() - entry.Data.size() / s_MinCompressionSavings)
+			{
+				result.clear();
+				return;
+			}
+
+			result.resize(size);
+		};
+
+		if (threadPool)
+		{
+			threadPool->ParallelFor(static_cast<uint32_t>(m_Entries.size()), compressEntry);
+		}
+		else
+		{
+			for (uint32_t i = 0; i < m_Entries.size(); i++)
+			{
+				compressEntry(i);
+			}
+		}
+
+		std::vector<AssetPackEntry> entries(m_Entries.size());
+		std::string names;
+
+		for (uint32_t i = 0; i < m_Entries.size(); i++)
+		{
+			const auto& source = m_Entries[i];
+			bool isCompressed = !compressed[i].empty();
+
+			entries[i] =
+			{
+				.PathHash = HashPath(source.Path),
+				.StoredSize = isCompressed ? compressed[i].size() : source.Data.size(),
+				.Size = source.Data.size(),
+				.NameOffset = static_cast<uint32_t>(names.size()),
+				.NameLength = static_cast<uint32_t>(source.Path.size()),
+				.Flags = isCompressed ? AssetPackEntryFlagCompressed : 0u,
+				.Reserved = 0,
+			};
+
+			names += source.Path;
+		}
+
+		// The assets are written in the order they were added, only the table is sorted
+		std::vector<uint32_t> order(entries.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs)
+		{
+			if (entries[lhs].PathHash != entries[rhs].PathHash)
+			{
+				return entries[lhs].PathHash < entries[rhs].PathHash;
+			}
+
+			return m_Entries[lhs].Path < m_Entries[rhs].Path;
+		});
+
+		uint64_t entriesOffset = sizeof(AssetPackHeader);
+		uint64_t namesOffset = entriesOffset + entries.size() * sizeof(AssetPackEntry);
+		uint64_t offset = AlignAsset(namesOffset + names.size());
+		uint64_t fileSize = namesOffset + names.size();
+
+		for (auto& entry : entries)
+		{
+			entry.Offset = offset;
+			fileSize = offset + entry.StoredSize;
+			offset = AlignAsset(fileSize);
+		}
+
+		AssetPackHeader header =
+		{
+			.Magic = s_PackMagic,
+			.Version = s_PackVersion,
+			.EntryCount = static_cast<uint32_t>(entries.size()),
+			.Reserved = 0,
+			.EntriesOffset = entriesOffset,
+			.NamesOffset = namesOffset,
+			.NamesSize = names.size(),
+		};
+
+		// The padding between the assets stays zeroed
+		std::vector<std::byte> bytes(fileSize);
+		memcpy(bytes.data(), &header, sizeof(header));
+
+		for (uint32_t i = 0; i < order.size(); i++)
+		{
+			memcpy(bytes.data() + entriesOffset + i * sizeof(AssetPackEntry), &entries[order[i]], sizeof(AssetPackEntry));
+		}
+
+		memcpy(bytes.data() + namesOffset, names.data(), names.size());
+
+		for (uint32_t i = 0; i < entries.size(); i++)
+		{
+			const auto& data = compressed[i].empty() ? m_Entries[i].Data : compressed[i];
+			memcpy(bytes.data() + entries[i].Offset, data.data(), data.size());
+		}
+
+		// NOTE(Peter): Replaced atomically, a running game can keep the old pack mapped
+		if (!FileIO::WriteFileAtomic(filepath, bytes))
+		{
+			WriteLine("Failed to write asset pack {}.", LogLevel::Error, filepath.string());
+			return false;
+		}
+
+		return true;
+	}
+
+}
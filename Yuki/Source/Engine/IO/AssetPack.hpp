@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Engine/IO/FileIO.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+
+#include <filesystem>
+#include <span>
+#include <unordered_map>
+
+namespace Yuki {
+
+	// How assets are laid out in the pack, only AssetPack.cpp needs to know
+	struct AssetPackEntry;
+
+	// The contents of a single asset. Stored assets are a view of the mapped pack, compressed ones are decompressed
+	// into Decompressed. Keeps the pack mapped for as long as it's alive.
+	struct PackedAsset
+	{
+		FileIO::MappedFile View;
+
+		// Empty unless the asset was compressed
+		std::vector<std::byte> Decompressed;
+
+		bool IsValid() const { return View.IsValid(); }
+
+		std::span<const std::byte> GetBytes() const { return Decompressed.empty() ? View.GetBytes() : std::span<const std::byte>(Decompressed); }
+		std::string_view GetText() const { return { reinterpret_cast<const char*>(GetBytes().data()), GetBytes().size() }; }
+	};
+
+	// Many assets in a single file, so loading them costs one open and no path lookups in the filesystem. The table of
+	// contents is sorted by the hash of the asset paths and searched in place, every asset starts on a cache line and
+	// can be LZ4 compressed. Paths are case insensitive and use forward slashes, e.g. "shaders/common.hlsl".
+	// NOTE(Peter): Read is thread safe
+	class AssetPack
+	{
+	public:
+		AssetPack() = default;
+
+		// Maps the pack, the pack is invalid if the file doesn't exist or isn't a pack
+		explicit AssetPack(const std::filesystem::path& filepath);
+
+		bool IsValid() const { return m_File.IsValid(); }
+
+		uint32_t GetEntryCount() const { return m_EntryCount; }
+
+		bool Contains(std::string_view path) const;
+
+		// Returns an invalid asset if the pack doesn't contain path, or if it couldn't be decompressed
+		PackedAsset Read(std::string_view path) const;
+
+		// Lowercase, forward slashes and no leading "./" or "/", what paths are hashed and compared as
+		static std::string NormalizePath(std::string_view path);
+
+	private:
+		const AssetPackEntry* Find(std::string_view path) const;
+
+	private:
+		FileIO::MappedFile m_File;
+
+		// Point into m_File
+		const AssetPackEntry* m_Entries = nullptr;
+		uint32_t m_EntryCount = 0;
+		const char* m_Names = nullptr;
+	};
+
+	// Reads filepath from pack if there is one and it contains the asset, maps the loose file otherwise. Paths are looked up
+	// as they're passed in, so the pack has to be built from the directory they're relative to.
+	PackedAsset LoadAsset(const AssetPack* pack, const std::filesystem::path& filepath);
+
+	// Builds packs, used by the AssetPacker tool
+	class AssetPackWriter
+	{
+	public:
+		// Adding the same path again replaces the asset. Compressed assets are only stored compressed if that makes them smaller.
+		void Add(std::string_view path, std::vector<std::byte> data, bool compress);
+
+		// Returns false if the file couldn't be read
+		bool AddFile(const std::filesystem::path& filepath, std::string_view path, bool compress);
+
+		// Compresses the assets across threadPool if there is one
+		bool Write(const std::filesystem::path& filepath, ThreadPool* threadPool = nullptr) const;
+
+		uint32_t GetEntryCount() const { return static_cast<uint32_t>(m_Entries.size()); }
+
+	private:
+		struct PendingEntry
+		{
+			std::string Path;
+			std::vector<std::byte> Data;
+			bool Compress;
+		};
+
+	private:
+		std::vector<PendingEntry> m_Entries;
+		std::unordered_map<std::string, uint32_t> m_EntryIndices;
+	};
+
+}
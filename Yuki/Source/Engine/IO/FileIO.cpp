@@ -1,20 +1,65 @@
 #include "FileIO.hpp"
 
+#include <thread>
+
 namespace Yuki::FileIO {
 
-	bool ReadText(const std::filesystem::path& filepath, std::string& outString)
+	bool WriteText(const std::filesystem::path& filepath, std::string_view text)
 	{
-		std::ifstream stream(filepath);
+		std::ofstream stream(filepath);
 
 		if (!stream)
 		{
 			return false;
 		}
 
-		std::stringstream str;
-		str << stream.rdbuf();
-		outString = str.str();
+		stream << text;
+		return static_cast<bool>(stream);
+	}
+
+	bool WriteFileAtomic(const std::filesystem::path& filepath, std::span<const std::byte> data)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(filepath.parent_path(), error);
+
+		// NOTE(Peter): The thread id keeps concurrent writers of the same file from sharing a temporary file
+		auto tempPath = filepath;
+		tempPath += std::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+		{
+			std::ofstream stream(tempPath, std::ios::binary);
+			stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+			if (!stream)
+			{
+				stream.close();
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tempPath, filepath, error);
+
+		if (error)
+		{
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+
 		return true;
 	}
 
+	MappedFile MappedFile::GetView(uint64_t offset, uint64_t size) const
+	{
+		if (!IsValid() || offset > m_Size || size > m_Size - offset)
+		{
+			return {};
+		}
+
+		MappedFile view = *this;
+		view.m_Data = m_Data + offset;
+		view.m_Size = size;
+		return view;
+	}
+
 }
@@ -1,9 +1,69 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
+#include <span>
 
 namespace Yuki::FileIO {
 
+	// Reads the whole file with a single read sized by the file size, only falls back to growing the string if the file
+	// turns out to be larger than it claimed. The text is read as is, line endings aren't converted.
 	bool ReadText(const std::filesystem::path& filepath, std::string& outString);
+	bool WriteText(const std::filesystem::path& filepath, std::string_view text);
+
+	// Same as ReadText, but into outData. Its capacity is reused, so reading many files into the same vector only allocates
+	// when a file is larger than any before it.
+	bool ReadBinary(const std::filesystem::path& filepath, std::vector<std::byte>& outData);
+
+	// Reads exactly outData.size() bytes starting at offset into memory the caller owns, e.g. a mapped staging buffer.
+	// Returns false if the file is shorter than that.
+	bool ReadBinary(const std::filesystem::path& filepath, uint64_t offset, std::span<std::byte> outData);
+
+	// A file mapped read-only into memory, or a view of part of one, pages are only read from disk once they're touched.
+	// Copies and views share the mapping, the file is unmapped once the last of them is gone.
+	class MappedFile
+	{
+	public:
+		bool IsValid() const { return m_Mapping != nullptr; }
+
+		// Null for empty files
+		const std::byte* GetData() const { return m_Data; }
+		uint64_t GetSize() const { return m_Size; }
+
+		std::span<const std::byte> GetBytes() const { return { m_Data, m_Size }; }
+		std::string_view GetText() const { return { reinterpret_cast<const char*>(m_Data), m_Size }; }
+
+		// Keeps the whole file mapped for as long as the view is alive. Returns an invalid view if the range doesn't fit.
+		MappedFile GetView(uint64_t offset, uint64_t size) const;
+
+	private:
+		struct Mapping
+		{
+			const std::byte* Data = nullptr;
+			uint64_t Size = 0;
+
+			// Platform handles, closed by the destructor
+			void* File = nullptr;
+			void* Section = nullptr;
+
+			~Mapping();
+		};
+
+		std::shared_ptr<Mapping> m_Mapping;
+
+		// The part of the mapping this file or view covers
+		const std::byte* m_Data = nullptr;
+		uint64_t m_Size = 0;
+
+		friend MappedFile MapFile(const std::filesystem::path& filepath);
+	};
+
+	// Returns an invalid file if it doesn't exist or couldn't be mapped
+	MappedFile MapFile(const std::filesystem::path& filepath);
+
+	// Writes data to a temporary file next to filepath and moves it over filepath once it's complete, so nobody ever
+	// reads a partially written file. Creates the parent directories. Returns false if the file couldn't be written or
+	// replaced, e.g. because another thread has it mapped on a platform that doesn't allow replacing it.
+	bool WriteFileAtomic(const std::filesystem::path& filepath, std::span<const std::byte> data);
 
 }
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+namespace Yuki {
+
+	// A single read the IO service hands to a backend, Destination always has room for Size bytes
+	struct IOReadOperation
+	{
+		const std::filesystem::path* Filepath = nullptr;
+		uint64_t Offset = 0;
+		std::byte* Destination = nullptr;
+		uint64_t Size = 0;
+
+		// Written by the backend
+		uint64_t BytesRead = 0;
+		bool Succeeded = false;
+	};
+
+	// How the IO service performs reads, only used by IOService.cpp and the platform layer
+	class IOBackend
+	{
+	public:
+		virtual ~IOBackend() = default;
+
+		virtual std::string_view GetName() const = 0;
+
+		// Performs every read in the batch and returns once all of them have finished. Only ever called from the IO thread.
+		virtual void Read(std::span<IOReadOperation> operations) = 0;
+	};
+
+}
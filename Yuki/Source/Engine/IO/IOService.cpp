@@ -0,0 +1,308 @@
+#include "IOService.hpp"
+#include "IOBackend.hpp"
+#include "FileIO.hpp"
+
+#include "Engine/Core/ThreadPool.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+namespace Yuki {
+
+	// Implemented by the platform layer, returns null if the platform doesn't support async IO
+	IOBackend* CreatePlatformIOBackend(uint32_t maxReadsInFlight);
+
+	// Blocking reads are mostly spent waiting on the disk, so this doesn't depend on the number of cores
+	static constexpr uint32_t s_FallbackThreadCount = 4;
+
+	// Used if the platform has no async IO, each read blocks one of the threads
+	class ThreadPoolIOBackend final : public IOBackend
+	{
+	public:
+		ThreadPoolIOBackend()
+			: m_ThreadPool(s_FallbackThreadCount)
+		{
+		}
+
+		std::string_view GetName() const override { return "Thread Pool"; }
+
+		void Read(std::span<IOReadOperation> operations) override
+		{
+			m_ThreadPool.ParallelFor(static_cast<uint32_t>(operations.size()), [&](uint32_t index)
+			{
+				auto& operation = operations[index];
+				operation.Succeeded = FileIO::ReadBinary(*operation.Filepath, operation.Offset, { operation.Destination, operation.Size });
+				operation.BytesRead = operation.Succeeded ? operation.Size : 0;
+			});
+		}
+
+	private:
+		ThreadPool m_ThreadPool;
+	};
+
+	IOService::IOService(uint32_t maxReadsInFlight)
+		: m_MaxReadsInFlight(std::max(maxReadsInFlight, 1u))
+	{
+		m_Backend.reset(CreatePlatformIOBackend(m_MaxReadsInFlight));
+
+		if (!m_Backend)
+		{
+			m_Backend = std::make_unique<ThreadPoolIOBackend>();
+		}
+
+		m_Thread = std::jthread([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+	}
+
+	IOService::~IOService()
+	{
+		// NOTE(Peter): Reads that are still queued are dropped, but the ones in flight have to finish since the backend
+		//              may still be writing to them
+		{
+			std::scoped_lock lock(m_Mutex);
+
+			for (auto& queue : m_Queues)
+			{
+				queue.clear();
+			}
+		}
+
+		m_Thread.request_stop();
+		m_Thread = {};
+	}
+
+	IORequest IOService::Read(IOReadRequest request, Callback callback)
+	{
+		std::scoped_lock lock(m_Mutex);
+
+		IORequest handle = { m_NextRequestID++ };
+		m_Queues[static_cast<uint32_t>(request.Priority)].push_back({ handle, std::move(request), std::move(callback) });
+		m_PendingCount++;
+
+		m_ReadAvailable.notify_one();
+		return handle;
+	}
+
+	bool IOService::Cancel(IORequest request)
+	{
+		std::scoped_lock lock(m_Mutex);
+
+		if (auto it = m_InFlight.find(request.ID); it != m_InFlight.end())
+		{
+			it->second = true;
+			return true;
+		}
+
+		for (auto& queue : m_Queues)
+		{
+			auto it = std::ranges::find_if(queue, [&](const QueuedRead& read) { return read.Request.ID == request.ID; });
+
+			if (it == queue.end())
+			{
+				continue;
+			}
+
+			IOResult result = { .Request = it->Request, .Status = IOStatus::Cancelled, .Destination = it->Desc.Destination };
+			m_Completed.push_back({ std::move(result), std::move(it->OnCompleted) });
+			queue.erase(it);
+
+			m_PendingCount--;
+			m_Idle.notify_all();
+			return true;
+		}
+
+		return false;
+	}
+
+	void IOService::CancelAll()
+	{
+		std::scoped_lock lock(m_Mutex);
+
+		for (auto& [id, cancelled] : m_InFlight)
+		{
+			cancelled = true;
+		}
+
+		for (auto& queue : m_Queues)
+		{
+			for (auto& read : queue)
+			{
+				IOResult result = { .Request = read.Request, .Status = IOStatus::Cancelled, .Destination = read.Desc.Destination };
+				m_Completed.push_back({ std::move(result), std::move(read.OnCompleted) });
+			}
+
+			m_PendingCount -= static_cast<uint32_t>(queue.size());
+			queue.clear();
+		}
+
+		m_Idle.notify_all();
+	}
+
+	uint32_t IOService::DispatchCompletions()
+	{
+		std::vector<CompletedRead> completed;
+
+		{
+			std::scoped_lock lock(m_Mutex);
+			completed.swap(m_Completed);
+		}
+
+		// NOTE(Peter): Called without the lock held, so callbacks can submit more reads
+		for (auto& read : completed)
+		{
+			if (read.OnCompleted)
+			{
+				read.OnCompleted(read.Result);
+			}
+		}
+
+		return static_cast<uint32_t>(completed.size());
+	}
+
+	void IOService::WaitIdle()
+	{
+		std::unique_lock lock(m_Mutex);
+		m_Idle.wait(lock, [this] { return m_PendingCount == 0; });
+	}
+
+	uint32_t IOService::GetPendingCount() const
+	{
+		std::scoped_lock lock(m_Mutex);
+		return m_PendingCount;
+	}
+
+	std::string_view IOService::GetBackendName() const
+	{
+		return m_Backend->GetName();
+	}
+
+	void IOService::WorkerLoop(std::stop_token stopToken)
+	{
+		std::vector<QueuedRead> batch;
+
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_Mutex);
+
+				m_ReadAvailable.wait(lock, stopToken, [this]
+				{
+					return std::ranges::any_of(m_Queues, [](const auto& queue) { return !queue.empty(); });
+				});
+
+				if (stopToken.stop_requested())
+				{
+					return;
+				}
+
+				for (auto& queue : m_Queues | std::views::reverse)
+				{
+					while (!queue.empty() && batch.size() < m_MaxReadsInFlight)
+					{
+						m_InFlight[queue.front().Request.ID] = false;
+						batch.push_back(std::move(queue.front()));
+						queue.pop_front();
+					}
+				}
+			}
+
+			ProcessBatch(batch);
+			batch.clear();
+		}
+	}
+
+	void IOService::ProcessBatch(std::vector<QueuedRead>& batch)
+	{
+		std::vector<IOResult> results(batch.size());
+		std::vector<IOReadOperation> operations;
+		std::vector<uint32_t> operationIndices;
+		operations.reserve(batch.size());
+		operationIndices.reserve(batch.size());
+
+		for (uint32_t i = 0; i < batch.size(); i++)
+		{
+			const auto& desc = batch[i].Desc;
+			auto& result = results[i];
+
+			result.Request = batch[i].Request;
+			result.Destination = desc.Destination;
+
+			uint64_t size = desc.Size;
+
+			if (size == 0)
+			{
+				std::error_code error;
+				uint64_t fileSize = std::filesystem::file_size(desc.Filepath, error);
+
+				if (error || desc.Offset > fileSize)
+				{
+					continue;
+				}
+
+				size = fileSize - desc.Offset;
+			}
+
+			std::byte* destination = nullptr;
+
+			if (!desc.Destination.empty())
+			{
+				if (size > desc.Destination.size())
+				{
+					continue;
+				}
+
+				destination = desc.Destination.data();
+			}
+			else
+			{
+				result.Data.resize(size);
+				destination = result.Data.data();
+			}
+
+			operations.push_back({ .Filepath = &desc.Filepath, .Offset = desc.Offset, .Destination = destination, .Size = size });
+			operationIndices.push_back(i);
+		}
+
+		if (!operations.empty())
+		{
+			m_Backend->Read(operations);
+		}
+
+		for (uint32_t i = 0; i < operations.size(); i++)
+		{
+			auto& result = results[operationIndices[i]];
+
+			if (operations[i].Succeeded)
+			{
+				result.Status = IOStatus::Completed;
+				result.BytesRead = operations[i].BytesRead;
+			}
+		}
+
+		std::scoped_lock lock(m_Mutex);
+
+		for (uint32_t i = 0; i < batch.size(); i++)
+		{
+			auto& result = results[i];
+
+			if (m_InFlight[result.Request.ID])
+			{
+				result.Status = IOStatus::Cancelled;
+				result.Data = {};
+				result.BytesRead = 0;
+			}
+
+			if (result.Status == IOStatus::Failed)
+			{
+				WriteLine("Failed to read {}.", LogLevel::Warn, batch[i].Desc.Filepath.string());
+				result.Data = {};
+			}
+
+			m_InFlight.erase(result.Request.ID);
+			m_Completed.push_back({ std::move(result), std::move(batch[i].OnCompleted) });
+		}
+
+		m_PendingCount -= static_cast<uint32_t>(batch.size());
+		m_Idle.notify_all();
+	}
+
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+
+namespace Yuki {
+
+	class IOBackend;
+
+	enum class IOPriority
+	{
+		Low, Normal, High
+	};
+
+	enum class IOStatus
+	{
+		Completed, Failed, Cancelled
+	};
+
+	struct IORequest
+	{
+		uint64_t ID = 0;
+
+		bool IsValid() const { return ID != 0; }
+	};
+
+	struct IOReadRequest
+	{
+		std::filesystem::path Filepath;
+		uint64_t Offset = 0;
+
+		// Reads up to the end of the file if it's 0
+		uint64_t Size = 0;
+
+		// Reads into memory the caller owns instead of a vector the service allocates, e.g. a mapped staging buffer.
+		// The read fails if it doesn't fit. Has to stay alive until the callback has run, even if the request was cancelled.
+		std::span<std::byte> Destination;
+
+		IOPriority Priority = IOPriority::Normal;
+	};
+
+	struct IOResult
+	{
+		IORequest Request;
+		IOStatus Status = IOStatus::Failed;
+
+		// Empty if the request had a Destination or didn't complete
+		std::vector<std::byte> Data;
+		std::span<std::byte> Destination;
+
+		uint64_t BytesRead = 0;
+
+		std::span<const std::byte> GetBytes() const { return { Data.empty() ? Destination.data() : Data.data(), BytesRead }; }
+	};
+
+	// Reads files on a background thread, so streaming can keep many reads in flight without blocking the frame. Reads
+	// are handed to the platform's async IO in batches, highest priority first, or spread across a few blocking threads
+	// if the platform doesn't have any. Callbacks only run in DispatchCompletions, on the thread that calls it.
+	// NOTE(Peter): Read and Cancel are thread safe
+	class IOService
+	{
+	public:
+		using Callback = std::function<void(IOResult& result)>;
+
+		// At most maxReadsInFlight reads are handed to the backend at once
+		explicit IOService(uint32_t maxReadsInFlight = 32);
+		~IOService();
+
+		IOService(const IOService&) = delete;
+		IOService& operator=(const IOService&) = delete;
+
+		IORequest Read(IOReadRequest request, Callback callback);
+
+		// Requests that haven't been handed to the backend yet are dropped, reads in flight are finished but their data is
+		// thrown away. The callback is still called, with IOStatus::Cancelled. Returns false if the request already completed.
+		bool Cancel(IORequest request);
+
+		// Cancels every request that hasn't completed yet, the same way Cancel does
+		void CancelAll();
+
+		// Called once per frame by the application, calls the callbacks of every request that has finished since the last
+		// call. Returns how many it called.
+		uint32_t DispatchCompletions();
+
+		// Blocks until every request has finished, doesn't call their callbacks
+		void WaitIdle();
+
+		// Requests that haven't finished yet
+		uint32_t GetPendingCount() const;
+
+		std::string_view GetBackendName() const;
+
+	private:
+		struct QueuedRead
+		{
+			IORequest Request;
+			IOReadRequest Desc;
+			Callback OnCompleted;
+		};
+
+		struct CompletedRead
+		{
+			IOResult Result;
+			Callback OnCompleted;
+		};
+
+	private:
+		void WorkerLoop(std::stop_token stopToken);
+		void ProcessBatch(std::vector<QueuedRead>& batch);
+
+	private:
+		std::unique_ptr<IOBackend> m_Backend;
+		uint32_t m_MaxReadsInFlight;
+
+		mutable std::mutex m_Mutex;
+		std::condition_variable_any m_ReadAvailable;
+		std::condition_variable m_Idle;
+
+		// Indexed by IOPriority
+		std::array<std::deque<QueuedRead>, 3> m_Queues;
+
+		// Requests handed to the backend, set to true if they were cancelled while in flight
+		std::unordered_map<uint64_t, bool> m_InFlight;
+
+		std::vector<CompletedRead> m_Completed;
+
+		uint64_t m_NextRequestID = 1;
+		uint32_t m_PendingCount = 0;
+
+		// NOTE(Peter): Declared last so the thread is stopped before anything it uses is destroyed
+		std::jthread m_Thread;
+	};
+
+}
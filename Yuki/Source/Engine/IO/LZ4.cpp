@@ -0,0 +1,249 @@
+#include "LZ4.hpp"
+
+#include <cstring>
+
+namespace Yuki::LZ4 {
+
+	static constexpr uint32_t s_MinMatch = 4;
+	static constexpr uint32_t s_MaxOffset = 65535;
+	static constexpr uint32_t s_HashBits = 16;
+
+	// NOTE(Peter): Required by the format, the last 5 bytes are always literals and the last match starts at least 12 bytes before the end
+	static constexpr uint64_t s_LastLiterals = 5;
+	static constexpr uint64_t s_MatchStartLimit = 12;
+
+	static uint32_t Load32(const std::byte* data)
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	static uint32_t HashSequence(uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - s_HashBits);
+	}
+
+	// Lengths of 15 and up continue in extra bytes of 255 each, ending with a byte below 255
+	static uint64_t GetLengthSize(uint64_t length)
+	{
+		return length >= 15 ? (length - 15) / 255 + 1 : 0;
+	}
+
+	static std::byte* WriteLength(std::byte* dest, uint64_t length)
+	{
+		if (length < 15)
+		{
+			return dest;
+		}
+
+		length -= 15;
+
+		for (; length >= 255; length -= 255)
+		{
+			*dest++ = std::byte(255);
+		}
+
+		*dest++ = std::byte(length);
+		return dest;
+	}
+
+	static bool ReadLength(const std::byte*& source, const std::byte* sourceEnd, uint64_t& length)
+	{
+		if (length < 15)
+		{
+			return true;
+		}
+
+		uint8_t extra;
+
+		do
+		{
+			if (source == sourceEnd)
+			{
+				return false;
+			}
+
+			extra = static_cast<uint8_t>(*source++);
+			length += extra;
+		} while (extra == 255);
+
+		return true;
+	}
+
+	uint64_t GetCompressBound(uint64_t sourceSize)
+	{
+		return sourceSize + sourceSize / 255 + 16;
+	}
+
+	uint64_t Compress(const std::byte* source, uint64_t sourceSize, std::byte* dest, uint64_t destCapacity)
+	{
+		// Positions are hashed as 32-bit values
+		if (sourceSize > std::numeric_limits<uint32_t>::max())
+		{
+			return 0;
+		}
+
+		std::vector<uint32_t> hashTable(1ull << s_HashBits, 0);
+
+		std::byte* output = dest;
+		std::byte* outputEnd = dest + destCapacity;
+
+		uint64_t anchor = 0;
+		uint64_t position = 0;
+
+		auto writeSequence = [&](uint64_t literalLength, uint64_t offset, uint64_t matchLength) -> bool
+		{
+			uint64_t size = 1 + GetLengthSize(literalLength) + literalLength + (offset > 0 ? 2 + GetLengthSize(matchLength) : 0);
+
+			if (size > static_cast<uint64_t>(outputEnd - output))
+			{
+				return false;
+			}
+
+			*output++ = std::byte((std::min<uint64_t>(literalLength, 15) << 4) | std::min<uint64_t>(matchLength, 15));
+			output = WriteLength(output, literalLength);
+
+			if (literalLength > 0)
+			{
+				memcpy(output, source + anchor, literalLength);
+				output += literalLength;
+			}
+
+			// The last sequence only has literals
+			if (offset > 0)
+			{
+				*output++ = std::byte(offset & 0xFF);
+				*output++ = std::byte(offset >> 8);
+				output = WriteLength(output, matchLength);
+			}
+
+			return true;
+		};
+
+		if (sourceSize > s_MatchStartLimit)
+		{
+			uint64_t matchStartEnd = sourceSize - s_MatchStartLimit;
+			uint64_t matchEnd = sourceSize - s_LastLiterals;
+
+			while (position <= matchStartEnd)
+			{
+				uint32_t sequence = Load32(source + position);
+				uint32_t& entry = hashTable[HashSequence(sequence)];
+				uint64_t candidate = entry;
+				entry = static_cast<uint32_t>(position);
+
+				if (candidate >= position || position - candidate > s_MaxOffset || Load32(source + candidate) != sequence)
+				{
+					// Skips ahead faster the longer nothing matched, incompressible data doesn't get hashed byte by byte
+					position += 1 + ((position - anchor) >> 6);
+					continue;
+				}
+
+				uint64_t length = s_MinMatch;
+
+				while (position + length < matchEnd && source[candidate + length] == source[position + length])
+				{
+					length++;
+				}
+
+				if (!writeSequence(position - anchor, position - candidate, length - s_MinMatch))
+				{
+					return 0;
+				}
+
+				position += length;
+				anchor = position;
+
+				// Matches that start right after this one are common, the position before it is worth remembering
+				if (position - 2 <= matchStartEnd)
+				{
+					hashTable[HashSequence(Load32(source + position - 2))] = static_cast<uint32_t>(position - 2);
+				}
+			}
+		}
+
+		if (!writeSequence(sourceSize - anchor, 0, 0))
+		{
+			return 0;
+		}
+
+		return static_cast<uint64_t>(output - dest);
+	}
+
+	bool Decompress(const std::byte* source, uint64_t sourceSize, std::byte* dest, uint64_t destSize)
+	{
+		const std::byte* input = source;
+		const std::byte* inputEnd = source + sourceSize;
+
+		std::byte* output = dest;
+		std::byte* outputEnd = dest + destSize;
+
+		while (input < inputEnd)
+		{
+			auto token = static_cast<uint8_t>(*input++);
+
+			uint64_t literalLength = token >> 4;
+
+			if (!ReadLength(input, inputEnd, literalLength) ||
+				literalLength > static_cast<uint64_t>(inputEnd - input) ||
+				literalLength > static_cast<uint64_t>(outputEnd - output))
+			{
+				return false;
+			}
+
+			if (literalLength > 0)
+			{
+				memcpy(output, input, literalLength);
+				input += literalLength;
+				output += literalLength;
+			}
+
+			if (input == inputEnd)
+			{
+				break;
+			}
+
+			if (inputEnd - input < 2)
+			{
+				return false;
+			}
+
+			uint64_t offset = static_cast<uint64_t>(input[0]) | (static_cast<uint64_t>(input[1]) << 8);
+			input += 2;
+
+			uint64_t matchLength = token & 0xF;
+
+			if (offset == 0 || offset > static_cast<uint64_t>(output - dest) || !ReadLength(input, inputEnd, matchLength))
+			{
+				return false;
+			}
+
+			matchLength += s_MinMatch;
+
+			if (matchLength > static_cast<uint64_t>(outputEnd - output))
+			{
+				return false;
+			}
+
+			const std::byte* match = output - offset;
+
+			// NOTE(Peter): Matches can overlap the bytes they produce, that's how runs are encoded, so they're copied front to back
+			if (offset >= matchLength)
+			{
+				memcpy(output, match, matchLength);
+				output += matchLength;
+			}
+			else
+			{
+				for (uint64_t i = 0; i < matchLength; i++)
+				{
+					*output++ = match[i];
+				}
+			}
+		}
+
+		return output == outputEnd;
+	}
+
+}
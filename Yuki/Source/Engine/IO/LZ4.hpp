@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Yuki::LZ4 {
+
+	// The LZ4 block format, no frame around it so the sizes have to be stored elsewhere. Compression favors speed over ratio,
+	// decompression validates every length and offset so corrupt data fails instead of reading or writing out of bounds.
+
+	// The largest size Compress can produce for sourceSize bytes
+	uint64_t GetCompressBound(uint64_t sourceSize);
+
+	// Returns the compressed size, or 0 if it didn't fit in destCapacity or source is 4GB or larger
+	uint64_t Compress(const std::byte* source, uint64_t sourceSize, std::byte* dest, uint64_t destCapacity);
+
+	// destSize has to be the exact decompressed size, returns false if the data is corrupt
+	bool Decompress(const std::byte* source, uint64_t sourceSize, std::byte* dest, uint64_t destSize);
+
+}
@@ -0,0 +1,417 @@
+#include "BufferPool.hpp"
+
+namespace Yuki {
+
+	static constexpr uint32_t AlignUp(uint32_t value, uint32_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	BufferPool::BufferPool(RHIContext context, const BufferPoolConfig& config)
+		: m_Context(context), m_Config(config)
+	{
+		YukiAssert(config.BlockSize >= SmallSize);
+
+		if (config.Mode == BufferPoolMode::Linear)
+		{
+			YukiAssert(config.FramesInFlight > 0);
+			m_Frames.resize(config.FramesInFlight);
+		}
+	}
+
+	void BufferPool::Destroy()
+	{
+		for (auto& block : m_Blocks)
+		{
+			if (block.Resource)
+			{
+				block.Resource.Destroy();
+			}
+		}
+
+		m_Blocks.clear();
+		m_FreeBlocks.clear();
+		m_Frames.clear();
+		m_AllocatedBytes = 0;
+		m_AllocationCount = 0;
+	}
+
+	BufferAllocation BufferPool::Allocate(uint32_t size, uint32_t alignment)
+	{
+		YukiAssert(size > 0 && std::has_single_bit(alignment));
+
+		return m_Config.Mode == BufferPoolMode::Linear ? AllocateLinear(size, alignment) : AllocateTLSF(size, alignment);
+	}
+
+	void BufferPool::NextFrame()
+	{
+		YukiAssert(m_Config.Mode == BufferPoolMode::Linear);
+
+		m_CurrentFrame = (m_CurrentFrame + 1) % m_Config.FramesInFlight;
+		m_CurrentBlock = 0;
+
+		auto& frame = m_Frames[m_CurrentFrame];
+
+		for (uint32_t blockIndex : frame.Blocks)
+		{
+			m_Blocks[blockIndex].Head = 0;
+		}
+
+		m_AllocatedBytes -= frame.AllocatedBytes;
+		m_AllocationCount -= frame.AllocationCount;
+		frame.AllocatedBytes = 0;
+		frame.AllocationCount = 0;
+	}
+
+	uint32_t BufferPool::CreateBlock(uint32_t size)
+	{
+		uint32_t blockIndex;
+
+		if (m_FreeBlocks.empty())
+		{
+			blockIndex = static_cast<uint32_t>(m_Blocks.size());
+			m_Blocks.emplace_back();
+		}
+		else
+		{
+			blockIndex = m_FreeBlocks.back();
+			m_FreeBlocks.pop_back();
+		}
+
+		auto& block = m_Blocks[blockIndex];
+		block.Resource = Buffer::Create(m_Context, size, m_Config.Usage, m_Config.Category);
+		block.Size = size;
+		block.Head = 0;
+
+		if (m_Config.Mode == BufferPoolMode::TLSF)
+		{
+			for (auto& freeLists : block.FreeLists)
+			{
+				freeLists.fill(~0u);
+			}
+
+			InsertFreeNode(block, NewNode(block, 0, size));
+		}
+
+		return blockIndex;
+	}
+
+	void BufferPool::DestroyBlock(uint32_t blockIndex)
+	{
+		auto& block = m_Blocks[blockIndex];
+		block.Resource.Destroy();
+		block.Resource = {};
+		block.Nodes.clear();
+		block.UnusedNodes.clear();
+		block.FirstLevelBitmap = 0;
+		block.SecondLevelBitmaps.fill(0);
+
+		m_FreeBlocks.push_back(blockIndex);
+	}
+
+	BufferAllocation BufferPool::AllocateLinear(uint32_t size, uint32_t alignment)
+	{
+		auto& frame = m_Frames[m_CurrentFrame];
+
+		frame.AllocatedBytes += size;
+		frame.AllocationCount++;
+		m_AllocatedBytes += size;
+		m_AllocationCount++;
+
+		for (; m_CurrentBlock < frame.Blocks.size(); m_CurrentBlock++)
+		{
+			uint32_t blockIndex = frame.Blocks[m_CurrentBlock];
+			auto& block = m_Blocks[blockIndex];
+			uint32_t offset = AlignUp(block.Head, alignment);
+
+			if (uint64_t(offset) + size <= block.Size)
+			{
+				block.Head = offset + size;
+				return { block.Resource, offset, size, blockIndex };
+			}
+		}
+
+		// NOTE(Peter): The block stays with this frame from now on, so a frame only has to grow once
+		uint32_t blockIndex = CreateBlock(std::max(m_Config.BlockSize, size));
+		frame.Blocks.push_back(blockIndex);
+
+		auto& block = m_Blocks[blockIndex];
+		block.Head = size;
+		return { block.Resource, 0, size, blockIndex };
+	}
+
+	BufferAllocation BufferPool::AllocateTLSF(uint32_t size, uint32_t alignment)
+	{
+		size = AlignUp(size, MinAlignment);
+		alignment = std::max(alignment, MinAlignment);
+
+		BufferAllocation allocation;
+
+		for (uint32_t i = 0; i < m_Blocks.size(); i++)
+		{
+			if (m_Blocks[i].Resource && AllocateFromBlock(i, size, alignment, allocation))
+			{
+				return allocation;
+			}
+		}
+
+		uint32_t blockIndex = CreateBlock(std::max(m_Config.BlockSize, size + alignment));
+		bool allocated = AllocateFromBlock(blockIndex, size, alignment, allocation);
+		YukiAssert(allocated);
+		return allocation;
+	}
+
+	void BufferPool::MapSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+	{
+		if (size < SmallSize)
+		{
+			firstLevel = 0;
+			secondLevel = size / MinAlignment;
+			return;
+		}
+
+		uint32_t log = static_cast<uint32_t>(std::bit_width(size)) - 1;
+		firstLevel = log - SmallSizeBits + 1;
+		secondLevel = (size >> (log - SecondLevelBits)) ^ SecondLevelCount;
+	}
+
+	bool BufferPool::AllocateFromBlock(uint32_t blockIndex, uint32_t size, uint32_t alignment, BufferAllocation& allocation)
+	{
+		auto& block = m_Blocks[blockIndex];
+
+		// Any free node is already aligned to MinAlignment, bigger alignments may need to skip up to the difference
+		uint32_t nodeIndex = FindFreeNode(block, size + alignment - MinAlignment);
+
+		if (nodeIndex == ~0u)
+		{
+			return false;
+		}
+
+		RemoveFreeNode(block, nodeIndex);
+
+		// NOTE(Peter): NewNode can grow the node list, so nodes are always accessed through their index
+		uint32_t padding = AlignUp(block.Nodes[nodeIndex].Offset, alignment) - block.Nodes[nodeIndex].Offset;
+
+		if (padding > 0)
+		{
+			uint32_t paddingIndex = NewNode(block, block.Nodes[nodeIndex].Offset, padding);
+			uint32_t prevIndex = block.Nodes[nodeIndex].PrevPhysical;
+
+			block.Nodes[paddingIndex].PrevPhysical = prevIndex;
+			block.Nodes[paddingIndex].NextPhysical = nodeIndex;
+
+			if (prevIndex != ~0u)
+			{
+				block.Nodes[prevIndex].NextPhysical = paddingIndex;
+			}
+
+			block.Nodes[nodeIndex].PrevPhysical = paddingIndex;
+			block.Nodes[nodeIndex].Offset += padding;
+			block.Nodes[nodeIndex].Size -= padding;
+
+			// Free nodes are always merged with their neighbours, so the node before this one can't be free
+			InsertFreeNode(block, paddingIndex);
+		}
+
+		uint32_t remainder = block.Nodes[nodeIndex].Size - size;
+
+		if (remainder > 0)
+		{
+			uint32_t remainderIndex = NewNode(block, block.Nodes[nodeIndex].Offset + size, remainder);
+			uint32_t nextIndex = block.Nodes[nodeIndex].NextPhysical;
+
+			block.Nodes[remainderIndex].PrevPhysical = nodeIndex;
+			block.Nodes[remainderIndex].NextPhysical = nextIndex;
+
+			if (nextIndex != ~0u)
+			{
+				block.Nodes[nextIndex].PrevPhysical = remainderIndex;
+			}
+
+			block.Nodes[nodeIndex].NextPhysical = remainderIndex;
+			block.Nodes[nodeIndex].Size = size;
+
+			InsertFreeNode(block, remainderIndex);
+		}
+
+		block.AllocationCount++;
+		m_AllocatedBytes += size;
+		m_AllocationCount++;
+
+		const auto& node = block.Nodes[nodeIndex];
+		allocation = { block.Resource, node.Offset, size, blockIndex, nodeIndex };
+		return true;
+	}
+
+	void BufferPool::Free(const BufferAllocation& allocation)
+	{
+		YukiAssert(m_Config.Mode == BufferPoolMode::TLSF && allocation.IsValid());
+
+		auto& block = m_Blocks[allocation.Block];
+		uint32_t nodeIndex = allocation.Node;
+
+		YukiAssert(!block.Nodes[nodeIndex].IsFree);
+
+		m_AllocatedBytes -= block.Nodes[nodeIndex].Size;
+		m_AllocationCount--;
+
+		uint32_t nextIndex = block.Nodes[nodeIndex].NextPhysical;
+
+		if (nextIndex != ~0u && block.Nodes[nextIndex].IsFree)
+		{
+			RemoveFreeNode(block, nextIndex);
+
+			block.Nodes[nodeIndex].Size += block.Nodes[nextIndex].Size;
+			block.Nodes[nodeIndex].NextPhysical = block.Nodes[nextIndex].NextPhysical;
+
+			if (block.Nodes[nextIndex].NextPhysical != ~0u)
+			{
+				block.Nodes[block.Nodes[nextIndex].NextPhysical].PrevPhysical = nodeIndex;
+			}
+
+			block.UnusedNodes.push_back(nextIndex);
+		}
+
+		uint32_t prevIndex = block.Nodes[nodeIndex].PrevPhysical;
+
+		if (prevIndex != ~0u && block.Nodes[prevIndex].IsFree)
+		{
+			RemoveFreeNode(block, prevIndex);
+
+			block.Nodes[prevIndex].Size += block.Nodes[nodeIndex].Size;
+			block.Nodes[prevIndex].NextPhysical = block.Nodes[nodeIndex].NextPhysical;
+
+			if (block.Nodes[nodeIndex].NextPhysical != ~0u)
+			{
+				block.Nodes[block.Nodes[nodeIndex].NextPhysical].PrevPhysical = prevIndex;
+			}
+
+			block.UnusedNodes.push_back(nodeIndex);
+			nodeIndex = prevIndex;
+		}
+
+		InsertFreeNode(block, nodeIndex);
+
+		// Empty blocks are released as long as there's another one to allocate from, so memory shrinks back after a spike
+		if (--block.AllocationCount == 0 && GetBlockCount() > 1)
+		{
+			DestroyBlock(allocation.Block);
+		}
+	}
+
+	uint32_t BufferPool::NewNode(Block& block, uint32_t offset, uint32_t size)
+	{
+		uint32_t nodeIndex;
+
+		if (block.UnusedNodes.empty())
+		{
+			nodeIndex = static_cast<uint32_t>(block.Nodes.size());
+			block.Nodes.emplace_back();
+		}
+		else
+		{
+			nodeIndex = block.UnusedNodes.back();
+			block.UnusedNodes.pop_back();
+		}
+
+		block.Nodes[nodeIndex] = { .Offset = offset, .Size = size };
+		return nodeIndex;
+	}
+
+	void BufferPool::InsertFreeNode(Block& block, uint32_t nodeIndex)
+	{
+		auto& node = block.Nodes[nodeIndex];
+
+		uint32_t firstLevel, secondLevel;
+		MapSize(node.Size, firstLevel, secondLevel);
+
+		uint32_t& head = block.FreeLists[firstLevel][secondLevel];
+
+		node.IsFree = true;
+		node.PrevFree = ~0u;
+		node.NextFree = head;
+
+		if (head != ~0u)
+		{
+			block.Nodes[head].PrevFree = nodeIndex;
+		}
+
+		head = nodeIndex;
+
+		block.FirstLevelBitmap |= 1u << firstLevel;
+		block.SecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	}
+
+	void BufferPool::RemoveFreeNode(Block& block, uint32_t nodeIndex)
+	{
+		auto& node = block.Nodes[nodeIndex];
+
+		uint32_t firstLevel, secondLevel;
+		MapSize(node.Size, firstLevel, secondLevel);
+
+		if (node.PrevFree != ~0u)
+		{
+			block.Nodes[node.PrevFree].NextFree = node.NextFree;
+		}
+		else
+		{
+			block.FreeLists[firstLevel][secondLevel] = node.NextFree;
+
+			if (node.NextFree == ~0u)
+			{
+				block.SecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+
+				if (block.SecondLevelBitmaps[firstLevel] == 0)
+				{
+					block.FirstLevelBitmap &= ~(1u << firstLevel);
+				}
+			}
+		}
+
+		if (node.NextFree != ~0u)
+		{
+			block.Nodes[node.NextFree].PrevFree = node.PrevFree;
+		}
+
+		node.IsFree = false;
+	}
+
+	uint32_t BufferPool::FindFreeNode(const Block& block, uint32_t size) const
+	{
+		// Rounding up to the next list means every node in the list we find is big enough, which is what keeps this constant time
+		uint64_t searchSize = size;
+
+		if (size >= SmallSize)
+		{
+			uint32_t log = static_cast<uint32_t>(std::bit_width(size)) - 1;
+			searchSize += (1ull << (log - SecondLevelBits)) - 1;
+		}
+
+		if (searchSize > std::numeric_limits<uint32_t>::max())
+		{
+			return ~0u;
+		}
+
+		uint32_t firstLevel, secondLevel;
+		MapSize(static_cast<uint32_t>(searchSize), firstLevel, secondLevel);
+
+		uint32_t secondLevelMap = block.SecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+
+		if (secondLevelMap == 0)
+		{
+			uint32_t firstLevelMap = block.FirstLevelBitmap & (~0u << (firstLevel + 1));
+
+			if (firstLevelMap == 0)
+			{
+				return ~0u;
+			}
+
+			firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+			secondLevelMap = block.SecondLevelBitmaps[firstLevel];
+		}
+
+		secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+		return block.FreeLists[firstLevel][secondLevel];
+	}
+
+}
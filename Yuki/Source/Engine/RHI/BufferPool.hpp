@@ -0,0 +1,155 @@
+#pragma once
+
+#include "RHI.hpp"
+
+namespace Yuki {
+
+	enum class BufferPoolMode
+	{
+		// Allocations can't be freed individually, everything allocated during a frame is released at once
+		// when the pool comes back around to that frame
+		Linear,
+
+		// Allocations live until they're freed, free ranges are found in constant time with a two-level segregated fit allocator
+		TLSF,
+	};
+
+	struct BufferPoolConfig
+	{
+		BufferUsage Usage;
+		MemoryCategory Category = MemoryCategory::Other;
+		BufferPoolMode Mode = BufferPoolMode::TLSF;
+
+		// Allocations larger than a block get a block of their own
+		uint32_t BlockSize = 16 * 1024 * 1024;
+
+		// Linear pools only
+		uint32_t FramesInFlight = 2;
+	};
+
+	// A range of one of the pool's buffers, bind Resource with Offset or use GetAddress
+	struct BufferAllocation
+	{
+		Buffer Resource;
+		uint32_t Offset = 0;
+		uint32_t Size = 0;
+
+		uint32_t Block = ~0u;
+		uint32_t Node = ~0u;
+
+		bool IsValid() const { return Block != ~0u; }
+
+		// NOTE(Peter): Blocks of movable pools can be moved by the defragmenter, so the address is looked up every
+		//              time instead of being stored. Call this while recording, not when allocating.
+		uint64_t GetAddress() const { return Resource.GetAddress() + Offset; }
+	};
+
+	// Hands out ranges of a few large buffers instead of creating a buffer per allocation, which keeps
+	// allocating down to some bit scans and the number of Vulkan objects down to the number of blocks.
+	// NOTE(Peter): Not thread safe, every thread that needs to allocate should have its own pool
+	class BufferPool
+	{
+	public:
+		BufferPool() = default;
+		BufferPool(RHIContext context, const BufferPoolConfig& config);
+
+		// The GPU has to be done with every allocation
+		void Destroy();
+
+		// alignment has to be a power of two
+		BufferAllocation Allocate(uint32_t size, uint32_t alignment = 16);
+
+		// TLSF pools only, the GPU has to be done with the allocation
+		void Free(const BufferAllocation& allocation);
+
+		// Linear pools only. Moves on to the blocks of the next frame and releases everything allocated in them,
+		// the caller has to make sure the GPU has finished with the frame that last allocated from them.
+		void NextFrame();
+
+		uint32_t GetBlockCount() const { return static_cast<uint32_t>(m_Blocks.size()) - static_cast<uint32_t>(m_FreeBlocks.size()); }
+		uint64_t GetAllocatedBytes() const { return m_AllocatedBytes; }
+		uint32_t GetAllocationCount() const { return m_AllocationCount; }
+
+	private:
+		static constexpr uint32_t SecondLevelBits = 4;
+		static constexpr uint32_t SecondLevelCount = 1 << SecondLevelBits;
+
+		// Sizes below SmallSize share the first first-level list, above it every power of two gets its own
+		static constexpr uint32_t SmallSizeBits = 8;
+		static constexpr uint32_t SmallSize = 1 << SmallSizeBits;
+		static constexpr uint32_t FirstLevelCount = 32 - SmallSizeBits + 1;
+
+		static constexpr uint32_t MinAlignment = SmallSize / SecondLevelCount;
+
+		// A physically contiguous range of a block, either free or allocated
+		struct Node
+		{
+			uint32_t Offset;
+			uint32_t Size;
+
+			uint32_t PrevPhysical = ~0u;
+			uint32_t NextPhysical = ~0u;
+
+			// Free nodes only
+			uint32_t PrevFree = ~0u;
+			uint32_t NextFree = ~0u;
+
+			bool IsFree = false;
+		};
+
+		struct Block
+		{
+			Buffer Resource;
+			uint32_t Size;
+
+			// Linear pools
+			uint32_t Head = 0;
+
+			// TLSF pools
+			std::vector<Node> Nodes;
+			std::vector<uint32_t> UnusedNodes;
+			uint32_t FirstLevelBitmap = 0;
+			std::array<uint32_t, FirstLevelCount> SecondLevelBitmaps{};
+			std::array<std::array<uint32_t, SecondLevelCount>, FirstLevelCount> FreeLists;
+			uint32_t AllocationCount = 0;
+		};
+
+	private:
+		uint32_t CreateBlock(uint32_t size);
+		void DestroyBlock(uint32_t blockIndex);
+
+		BufferAllocation AllocateLinear(uint32_t size, uint32_t alignment);
+		BufferAllocation AllocateTLSF(uint32_t size, uint32_t alignment);
+		bool AllocateFromBlock(uint32_t blockIndex, uint32_t size, uint32_t alignment, BufferAllocation& allocation);
+
+		// Sizes below SmallSize are split linearly, above it every power of two is split into SecondLevelCount ranges
+		static void MapSize(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+		uint32_t NewNode(Block& block, uint32_t offset, uint32_t size);
+		void InsertFreeNode(Block& block, uint32_t nodeIndex);
+		void RemoveFreeNode(Block& block, uint32_t nodeIndex);
+		uint32_t FindFreeNode(const Block& block, uint32_t size) const;
+
+	private:
+		RHIContext m_Context;
+		BufferPoolConfig m_Config;
+
+		std::vector<Block> m_Blocks;
+		std::vector<uint32_t> m_FreeBlocks;
+
+		// Linear pools, the blocks every frame allocates from in order
+		struct LinearFrame
+		{
+			std::vector<uint32_t> Blocks;
+			uint64_t AllocatedBytes = 0;
+			uint32_t AllocationCount = 0;
+		};
+		std::vector<LinearFrame> m_Frames;
+		uint32_t m_CurrentFrame = 0;
+		uint32_t m_CurrentBlock = 0;
+
+		uint64_t m_AllocatedBytes = 0;
+		uint32_t m_AllocationCount = 0;
+	};
+
+}
@@ -6,6 +6,7 @@
 
 #include <Aura/Span.hpp>
 
+#include <array>
 #include <filesystem>
 #include <functional>
 
@@ -18,7 +19,106 @@ namespace Yuki {
 		Transfer = 1 << 2
 	};
 
+	// NOTE(Peter): Command counters are kept per command list and added to the context when the list is submitted,
+	//              everything else is counted on the context as it happens
+	struct RHIStatistics
+	{
+		uint64_t DrawCalls = 0;
+		uint64_t IndicesDrawn = 0;
+		uint64_t PipelineBinds = 0;
+
+		// Individual image and buffer barriers, after redundant ones have been skipped
+		uint64_t Barriers = 0;
+
+		uint64_t DescriptorWrites = 0;
+		uint64_t Submits = 0;
+
+		// Through CopyBuffer and CopyBufferToImage
+		uint64_t CopiedBytes = 0;
+
+		// Written into images from the CPU by Image::WriteFromHost, without a command list
+		uint64_t HostCopiedBytes = 0;
+
+		uint64_t BuffersCreated = 0;
+		uint64_t BuffersDestroyed = 0;
+		uint64_t ImagesCreated = 0;
+		uint64_t ImagesDestroyed = 0;
+
+		RHIStatistics& operator+=(const RHIStatistics& other)
+		{
+			DrawCalls += other.DrawCalls;
+			IndicesDrawn += other.IndicesDrawn;
+			PipelineBinds += other.PipelineBinds;
+			Barriers += other.Barriers;
+			DescriptorWrites += other.DescriptorWrites;
+			Submits += other.Submits;
+			CopiedBytes += other.CopiedBytes;
+			HostCopiedBytes += other.HostCopiedBytes;
+			BuffersCreated += other.BuffersCreated;
+			BuffersDestroyed += other.BuffersDestroyed;
+			ImagesCreated += other.ImagesCreated;
+			ImagesDestroyed += other.ImagesDestroyed;
+			return *this;
+		}
+	};
+
+	// What GPU memory is used for, only used for reporting
+	enum class MemoryCategory
+	{
+		Other,
+		Staging,
+		BatchGeometry,
+		Textures,
+		RenderTargets,
+		Meshes,
+	};
+	inline constexpr uint32_t MemoryCategoryCount = 6;
+
+	constexpr std::string_view MemoryCategoryToString(MemoryCategory category)
+	{
+		switch (category)
+		{
+		case MemoryCategory::Other: return "Other";
+		case MemoryCategory::Staging: return "Staging";
+		case MemoryCategory::BatchGeometry: return "BatchGeometry";
+		case MemoryCategory::Textures: return "Textures";
+		case MemoryCategory::RenderTargets: return "RenderTargets";
+		case MemoryCategory::Meshes: return "Meshes";
+		}
+
+		return "Unknown";
+	}
+
+	struct MemoryHeapReport
+	{
+		// Everything the process has allocated from the heap, including memory we didn't allocate ourselves
+		uint64_t Usage;
+
+		// How much the process can use before allocations start failing or evicting other memory
+		uint64_t Budget;
+
+		// Bytes we've handed out to resources
+		uint64_t AllocatedBytes;
+
+		bool DeviceLocal;
+	};
+
+	struct MemoryCategoryReport
+	{
+		uint64_t Bytes = 0;
+		uint32_t Allocations = 0;
+	};
+
+	struct MemoryReport
+	{
+		std::vector<MemoryHeapReport> Heaps;
+		std::array<MemoryCategoryReport, MemoryCategoryCount> Categories;
+	};
+
 	struct Queue;
+	class AssetPack;
+
+	enum class ImageFormat;
 
 	struct RHIContext : Handle<RHIContext>
 	{
@@ -27,6 +127,26 @@ namespace Yuki {
 
 		Aura::Span<Queue> RequestQueues(QueueType type, uint32_t count) const;
 		Queue RequestQueue(QueueType type) const;
+
+		// Everything counted since the last reset
+		RHIStatistics GetStatistics() const;
+
+		// Returns what was counted since the last reset and starts over, meant to be called once per frame
+		RHIStatistics ResetStatistics() const;
+
+		// NOTE(Peter): Queries the driver, meant to be called at most once per frame
+		MemoryReport GetMemoryReport() const;
+
+		// Whether images of the format can be sampled, block compressed formats aren't available everywhere
+		bool IsImageFormatSupported(ImageFormat format) const;
+
+		// Whether images of the format can be created with ImageUsage::HostTransfer and written with Image::WriteFromHost,
+		// the device may support host image copies but not for every format
+		bool IsHostImageCopySupported(ImageFormat format) const;
+
+		// Shaders and the files they include are read from pack before the filesystem,
+		// the pack has to outlive the context or be unset
+		void SetAssetPack(const AssetPack* pack) const;
 	};
 
 	enum class ImageLayout
@@ -42,10 +162,75 @@ namespace Yuki {
 
 	enum class ImageFormat
 	{
+		None,
 		RGBA8Unorm,
 		BGRA8Unorm,
+		RGBA8Srgb,
+		BGRA8Srgb,
+		D32SFloat,
+		D24UnormS8UInt,
+
+		// Block compressed, every 4x4 block of pixels is stored in 8 (BC1, BC4) or 16 bytes
+		BC1RGBAUnorm,
+		BC3RGBAUnorm,
+		BC4RUnorm,
+		BC5RGUnorm,
+		BC7RGBAUnorm,
+		BC1RGBASrgb,
+		BC3RGBASrgb,
+		BC7RGBASrgb,
 	};
 
+	inline bool IsBlockCompressed(ImageFormat format)
+	{
+		return format >= ImageFormat::BC1RGBAUnorm && format <= ImageFormat::BC7RGBASrgb;
+	}
+
+	// The same encoding with sRGB color that the sampler converts to linear, formats without one are returned as is
+	inline ImageFormat GetSrgbFormat(ImageFormat format)
+	{
+		switch (format)
+		{
+		case ImageFormat::RGBA8Unorm: return ImageFormat::RGBA8Srgb;
+		case ImageFormat::BGRA8Unorm: return ImageFormat::BGRA8Srgb;
+		case ImageFormat::BC1RGBAUnorm: return ImageFormat::BC1RGBASrgb;
+		case ImageFormat::BC3RGBAUnorm: return ImageFormat::BC3RGBASrgb;
+		case ImageFormat::BC7RGBAUnorm: return ImageFormat::BC7RGBASrgb;
+		default: return format;
+		}
+	}
+
+	// Bytes a single mip level takes up when tightly packed, block compressed formats are rounded up to whole blocks
+	inline uint64_t CalculateImageSize(ImageFormat format, uint32_t width, uint32_t height)
+	{
+		uint64_t blocks = uint64_t((width + 3) / 4) * ((height + 3) / 4);
+
+		switch (format)
+		{
+		case ImageFormat::None: return 0;
+		case ImageFormat::BC1RGBAUnorm:
+		case ImageFormat::BC1RGBASrgb:
+		case ImageFormat::BC4RUnorm: return blocks * 8;
+		case ImageFormat::BC3RGBAUnorm:
+		case ImageFormat::BC3RGBASrgb:
+		case ImageFormat::BC5RGUnorm:
+		case ImageFormat::BC7RGBAUnorm:
+		case ImageFormat::BC7RGBASrgb: return blocks * 16;
+		default: return uint64_t(width) * height * 4;
+		}
+	}
+
+	// Levels in a full mip chain, the last one is 1x1
+	inline uint32_t CalculateMipLevelCount(uint32_t width, uint32_t height)
+	{
+		return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+	}
+
+	inline uint32_t CalculateMipExtent(uint32_t extent, uint32_t mipLevel)
+	{
+		return std::max(extent >> mipLevel, 1u);
+	}
+
 	enum class ImageUsage
 	{
 		ColorAttachment        = 1 << 0,
@@ -53,6 +238,9 @@ namespace Yuki {
 		TransferSrc            = 1 << 2,
 		TransferDst            = 1 << 3,
 		Sampled                = 1 << 4,
+
+		// Allows Image::WriteFromHost, only if RHIContext::IsHostImageCopySupported for the image's format
+		HostTransfer           = 1 << 5,
 	};
 	inline void MakeEnumFlags(ImageUsage) {}
 
@@ -62,16 +250,45 @@ namespace Yuki {
 		uint32_t Height;
 		ImageFormat Format;
 		ImageUsage Usage;
+
+		// Every level has to be written separately, the default view covers all of them
+		uint32_t MipLevels = 1;
+
 		bool CreateDefaultView = false;
+		MemoryCategory Category = MemoryCategory::Other;
+	};
+
+	struct ImageMemoryRequirements
+	{
+		uint64_t Size;
+		uint64_t Alignment;
+		uint32_t MemoryTypeBits;
+	};
+
+	// Device memory that images can be placed in, images may overlap as long as only one of them is in use at a time
+	struct AliasingMemory : Handle<AliasingMemory>
+	{
+		static AliasingMemory Create(RHIContext context, uint64_t size, uint32_t memoryTypeBits, MemoryCategory category = MemoryCategory::RenderTargets);
+		void Destroy();
 	};
 
 	struct ImageView;
 	struct Image : Handle<Image>
 	{
 		static Image Create(RHIContext context, const ImageConfig& config);
+
+		// The image doesn't own the memory, destroying it leaves the memory allocated
+		static Image CreateAliased(RHIContext context, const ImageConfig& config, AliasingMemory memory, uint64_t offset);
 		void Destroy();
 
+		static ImageMemoryRequirements GetMemoryRequirements(RHIContext context, const ImageConfig& config);
+
 		ImageView GetDefaultView() const;
+
+		// Copies a whole mip level from CPU memory straight into the image, without a staging buffer or a command list.
+		// The pixels have to be tightly packed, the image is ready to be sampled once every level has been written.
+		// NOTE(Peter): Nothing else may use the image while it's being written, but different images can be written from different threads
+		void WriteFromHost(const void* data, uint64_t size, uint32_t mipLevel = 0) const;
 	};
 
 	struct ImageView : Handle<ImageView>
@@ -101,14 +318,32 @@ namespace Yuki {
 		void Wait(uint64_t value = 0) const;
 	};
 
+	struct TimestampQueryPool : Handle<TimestampQueryPool>
+	{
+		static TimestampQueryPool Create(RHIContext context, uint32_t count);
+		void Destroy();
+
+		// The GPU has to be done with the lists that wrote the queries
+		void Reset(uint32_t first, uint32_t count) const;
+
+		// Never waits for the GPU, returns false if any of the queries hasn't been written yet.
+		// Timestamps are in nanoseconds but only differences between them are meaningful.
+		bool GetResults(uint32_t first, Aura::Span<uint64_t> timestamps) const;
+	};
+
 	struct CommandList;
 	struct Queue : Handle<Queue>
 	{
 		void Destroy() {}
 
 		void AcquireImages(Aura::Span<Swapchain> swapchains, Aura::Span<Fence> signals) const;
+
+		// Shorthand for a SubmitBatch with a single submit, the command lists have to be ended already
 		void SubmitCommandLists(Aura::Span<CommandList> commandLists, Aura::Span<Fence> waits, Aura::Span<Fence> signals) const;
 		void Present(Aura::Span<Swapchain> swapchains, Aura::Span<Fence> waits) const;
+
+		// Lists recorded for queues that don't support timestamps can't write them, e.g. some transfer-only queues
+		bool SupportsTimestamps() const;
 	};
 
 	enum class ImageFilter
@@ -160,12 +395,30 @@ namespace Yuki {
 		std::filesystem::path FilePath;
 	};
 
+	enum class CompareOp
+	{
+		Never,
+		Less,
+		Equal,
+		LessOrEqual,
+		Greater,
+		NotEqual,
+		GreaterOrEqual,
+		Always
+	};
+
 	struct GraphicsPipelineConfig
 	{
 		std::vector<ShaderConfig> Shaders;
 		uint32_t PushConstantSize;
 
 		std::vector<ImageFormat> ColorAttachmentFormats;
+
+		// NOTE(Peter): Depth testing is only enabled if DepthAttachmentFormat isn't None
+		ImageFormat DepthAttachmentFormat = ImageFormat::None;
+		bool DepthTest = true;
+		bool DepthWrite = true;
+		CompareOp DepthCompareOp = CompareOp::Less;
 	};
 
 	struct GraphicsPipeline : Handle<GraphicsPipeline>
@@ -185,12 +438,16 @@ namespace Yuki {
 		Mapped          = 1 << 6,
 		DeviceLocal     = 1 << 7,
 		DedicatedMemory = 1 << 8,
+
+		// Lets the MemoryDefragmenter move the buffer, every submit that uses it has to wait for the defragmenter's fence.
+		// Can't be combined with Mapped.
+		Movable         = 1 << 9,
 	};
 	inline void MakeEnumFlags(BufferUsage) {}
 
 	struct Buffer : Handle<Buffer>
 	{
-		static Buffer Create(RHIContext context, uint64_t size, BufferUsage usage);
+		static Buffer Create(RHIContext context, uint64_t size, BufferUsage usage, MemoryCategory category = MemoryCategory::Other);
 		void Destroy();
 
 		uint64_t GetAddress() const;
@@ -204,34 +461,153 @@ namespace Yuki {
 		}
 	};
 
+	struct DefragmentationStatistics
+	{
+		uint64_t BytesMoved = 0;
+		uint32_t AllocationsMoved = 0;
+		uint64_t BytesFreed = 0;
+		uint32_t BlocksFreed = 0;
+	};
+
+	// Compacts device memory by moving buffers created with BufferUsage::Movable into fewer memory blocks, a few megabytes per
+	// frame. Moved buffers keep their handle but get a new device address, so addresses have to be fetched with Buffer::GetAddress
+	// every time they're recorded.
+	// NOTE(Peter): Images are never moved because their views are written to descriptor heaps we don't know about
+	struct MemoryDefragmenter : Handle<MemoryDefragmenter>
+	{
+		// Only one defragmenter can exist per context
+		static MemoryDefragmenter Create(RHIContext context, Queue queue, uint64_t maxBytesPerFrame = 4 * 1024 * 1024);
+
+		// Waits for the copies that are still in flight
+		void Destroy();
+
+		// Meant to be called once per frame before anything is recorded. The copies wait for the last value signalled on
+		// frameFence, and every submit after this call that uses a movable buffer has to wait for GetFence.
+		void Update(Fence frameFence);
+
+		Fence GetFence() const;
+
+		DefragmentationStatistics GetStatistics() const;
+	};
+
+	enum class IndexType
+	{
+		UInt16,
+		UInt32
+	};
+
+	// How a resource is going to be used next, barriers derive the stages, access masks and image layouts from this
+	enum class ResourceAccess
+	{
+		None,
+
+		ColorAttachmentWrite,
+		DepthAttachmentWrite,
+
+		TransferRead,
+		TransferWrite,
+
+		// Sampled images and storage / device address buffers read from any graphics shader stage
+		ShaderRead,
+
+		IndexRead,
+		Present,
+
+		// Anything, in the general layout. Avoid when a more specific access is known
+		General,
+	};
+
+	struct ImageBarrier
+	{
+		Image Target;
+		ResourceAccess Access;
+
+		// The current contents aren't needed anymore, allows the transition to skip preserving them
+		bool Discard = false;
+
+		// The image that last used the memory this image is placed in, its accesses are waited on as well
+		Image AliasedFrom = {};
+	};
+
+	struct BufferBarrier
+	{
+		Buffer Target;
+		ResourceAccess Access;
+	};
+
 	struct RenderingAttachment
 	{
 		ImageView Target;
 	};
 
+	enum class RenderingContents
+	{
+		// Commands are recorded directly into the list that began rendering
+		Inline,
+
+		// The only command allowed inside the rendering scope is ExecuteSecondaries
+		SecondaryLists,
+	};
+
 	struct Viewport
 	{
 		uint32_t Width;
 		uint32_t Height;
 	};
 
+	// Number of commands a CommandList skipped because they wouldn't have changed any bound state
+	struct StateCacheStatistics
+	{
+		uint32_t ElidedPipelineBinds = 0;
+		uint32_t ElidedDescriptorHeapBinds = 0;
+		uint32_t ElidedViewportChanges = 0;
+		uint32_t ElidedIndexBufferBinds = 0;
+		uint32_t ElidedPushConstantUploads = 0;
+
+		// Push constant bytes that weren't re-uploaded, including bytes skipped by partial uploads
+		uint32_t ElidedPushConstantBytes = 0;
+
+		StateCacheStatistics& operator+=(const StateCacheStatistics& other)
+		{
+			ElidedPipelineBinds += other.ElidedPipelineBinds;
+			ElidedDescriptorHeapBinds += other.ElidedDescriptorHeapBinds;
+			ElidedViewportChanges += other.ElidedViewportChanges;
+			ElidedIndexBufferBinds += other.ElidedIndexBufferBinds;
+			ElidedPushConstantUploads += other.ElidedPushConstantUploads;
+			ElidedPushConstantBytes += other.ElidedPushConstantBytes;
+			return *this;
+		}
+	};
+
+	// NOTE(Peter): Command lists cache the state they've bound and skip binds / push constant uploads that
+	//              wouldn't change anything, push constants are only uploaded for the byte ranges that changed
 	struct CommandList : Handle<CommandList>
 	{
-		void BeginRendering(Aura::Span<RenderingAttachment> colorAttachments) const;
+		// Finishes recording, has to be called before the list is submitted
+		void End() const;
+
+		void BeginRendering(Aura::Span<RenderingAttachment> colorAttachments, RenderingAttachment depthAttachment = {}, RenderingContents contents = RenderingContents::Inline) const;
 		void EndRendering() const;
 
 		void SetViewports(Aura::Span<Viewport> viewports) const;
 		void BindPipeline(GraphicsPipeline pipeline) const;
 		
+		// NOTE(Peter): Resources remember how they were last accessed, so a barrier only has to specify the next access.
+		//              Every transition in a call is flushed as a single dependency, prefer batching them up.
+		//              Image barriers always transition every mip level together.
+		void Barrier(Aura::Span<ImageBarrier> images, Aura::Span<BufferBarrier> buffers = {}) const;
+
+		// Shorthand for a single image barrier with the access that matches the layout
 		void TransitionImage(Image image, ImageLayout layout) const;
 		void BlitImage(Image dest, Image src) const;
 
 		void BindDescriptorHeap(DescriptorHeap heap, GraphicsPipeline pipeline) const;
 		void BindVertexBuffer(Buffer buffer, uint32_t stride) const;
-		void BindIndexBuffer(Buffer buffer) const;
+		void BindIndexBuffer(Buffer buffer, IndexType type = IndexType::UInt32, uint64_t offset = 0) const;
 
 		void CopyBuffer(Buffer dest, Buffer src, uint32_t size, uint32_t srcOffset = 0, uint32_t destOffset = 0) const;
-		void CopyBufferToImage(Image dest, Buffer src, uint32_t size, uint32_t srcOffset = 0) const;
+		// Writes a whole mip level, the buffer has to hold it tightly packed starting at srcOffset
+		void CopyBufferToImage(Image dest, Buffer src, uint32_t size, uint32_t srcOffset = 0, uint32_t mipLevel = 0) const;
 
 		void SetPushConstants(GraphicsPipeline pipeline, const void* data, uint32_t size) const;
 
@@ -242,7 +618,14 @@ namespace Yuki {
 		}
 
 		void Draw(uint32_t vertexCount) const;
-		void DrawIndexed(uint32_t indexCount, uint32_t instanceIndex) const;
+		// Indices are read starting at firstIndex in the bound index buffer, the vertex offset is always 0
+		void DrawIndexed(uint32_t indexCount, uint32_t instanceIndex, uint32_t firstIndex = 0) const;
+
+		// Ends the secondary lists and executes them in order, all state bound on this list is lost afterwards
+		void ExecuteSecondaries(Aura::Span<CommandList> secondaries) const;
+
+		// Written once every previously recorded command has finished
+		void WriteTimestamp(TimestampQueryPool pool, uint32_t index) const;
 	};
 
 	struct CommandPool : Handle<CommandPool>
@@ -253,5 +636,50 @@ namespace Yuki {
 		void Reset() const;
 
 		CommandList NewList() const;
+
+		// NOTE(Peter): Secondary lists continue a rendering scope begun with RenderingContents::SecondaryLists,
+		//              the formats have to match the attachments passed to BeginRendering. Secondaries don't
+		//              inherit any state, so pipelines, descriptor heaps and viewports have to be bound again.
+		CommandList NewSecondaryList(Aura::Span<ImageFormat> colorAttachmentFormats, ImageFormat depthAttachmentFormat = ImageFormat::None) const;
+
+		// State cache statistics of every list allocated since the last Reset
+		StateCacheStatistics GetStateCacheStatistics() const;
+	};
+
+	// Collects several logical submits, potentially for different queues, and hands them to the driver
+	// with a single submit call per queue when flushed
+	struct SubmitBatch
+	{
+		struct FenceValue
+		{
+			Fence Target;
+			uint64_t Value;
+		};
+
+		struct Submit
+		{
+			Queue Target;
+			uint32_t CommandListOffset;
+			uint32_t CommandListCount;
+			uint32_t WaitOffset;
+			uint32_t WaitCount;
+			uint32_t SignalOffset;
+			uint32_t SignalCount;
+		};
+
+		// NOTE(Peter): Waits for the last value signalled on each wait fence and signals the next value of each signal
+		//              fence. Values are reserved immediately so later submits in the batch can wait for them, which also
+		//              means waiting for a signal fence on the CPU will never return until the batch has been flushed.
+		void Add(Queue queue, Aura::Span<CommandList> commandLists, Aura::Span<Fence> waits, Aura::Span<Fence> signals);
+
+		// Submits everything grouped by queue, in the order the queues were first used, and clears the batch
+		void Flush();
+
+		bool IsEmpty() const { return Submits.empty(); }
+
+		std::vector<Submit> Submits;
+		std::vector<CommandList> CommandLists;
+		std::vector<FenceValue> Waits;
+		std::vector<FenceValue> Signals;
 	};
 }
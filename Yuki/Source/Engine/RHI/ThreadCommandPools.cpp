@@ -0,0 +1,56 @@
+#include "ThreadCommandPools.hpp"
+
+namespace Yuki {
+
+	ThreadCommandPools::ThreadCommandPools(RHIContext context, Queue queue, uint32_t threadCount, uint32_t framesInFlight)
+		: m_ThreadCount(threadCount), m_FramesInFlight(framesInFlight)
+	{
+		YukiAssert(threadCount > 0 && framesInFlight > 0);
+
+		m_Pools.reserve(threadCount * framesInFlight);
+
+		for (uint32_t i = 0; i < threadCount * framesInFlight; i++)
+		{
+			m_Pools.push_back(CommandPool::Create(context, queue));
+		}
+	}
+
+	void ThreadCommandPools::Destroy()
+	{
+		for (auto pool : m_Pools)
+		{
+			pool.Destroy();
+		}
+
+		m_Pools.clear();
+	}
+
+	void ThreadCommandPools::NextFrame()
+	{
+		m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
+
+		for (uint32_t i = 0; i < m_ThreadCount; i++)
+		{
+			GetPool(i).Reset();
+		}
+	}
+
+	CommandPool ThreadCommandPools::GetPool(uint32_t threadIndex) const
+	{
+		YukiAssert(threadIndex < m_ThreadCount);
+		return m_Pools[m_CurrentFrame * m_ThreadCount + threadIndex];
+	}
+
+	StateCacheStatistics ThreadCommandPools::GetStateCacheStatistics() const
+	{
+		StateCacheStatistics result;
+
+		for (uint32_t i = 0; i < m_ThreadCount; i++)
+		{
+			result += GetPool(i).GetStateCacheStatistics();
+		}
+
+		return result;
+	}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "RHI.hpp"
+
+namespace Yuki {
+
+	// Hands out one CommandPool per recording thread, with a separate set of pools for every frame in flight.
+	// A pool may only be recorded into from one thread at a time, which is what lets recording skip all locking,
+	// so threads should index the pools by a stable slot (e.g. the index of the chunk of work they're recording).
+	class ThreadCommandPools
+	{
+	public:
+		ThreadCommandPools() = default;
+
+		// framesInFlight is how many frames the GPU may still be executing when NextFrame is called, plus the one being recorded
+		ThreadCommandPools(RHIContext context, Queue queue, uint32_t threadCount, uint32_t framesInFlight);
+
+		void Destroy();
+
+		// Moves on to the pools of the next frame and resets them, the caller has to make sure
+		// the GPU has finished executing the lists that were recorded the last time they were used
+		void NextFrame();
+
+		CommandPool GetPool(uint32_t threadIndex) const;
+		uint32_t GetThreadCount() const { return m_ThreadCount; }
+
+		// State cache statistics of every list recorded since the last call to NextFrame
+		StateCacheStatistics GetStateCacheStatistics() const;
+
+	private:
+		uint32_t m_ThreadCount = 0;
+		uint32_t m_FramesInFlight = 0;
+		uint32_t m_CurrentFrame = 0;
+
+		// m_FramesInFlight * m_ThreadCount pools, grouped by frame
+		std::vector<CommandPool> m_Pools;
+	};
+
+}
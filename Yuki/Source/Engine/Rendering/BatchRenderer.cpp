@@ -1,57 +1,30 @@
 #include "BatchRenderer.hpp"
+#include "GeometryBatchImpl.hpp"
 
-#include <rtmcpp/PackedVector.hpp>
-#include <rtmcpp/VectorOps.hpp>
 #include <rtmcpp/PackedMatrix.hpp>
 
+#include <unordered_map>
+
 namespace Yuki {
 
 	struct BatchPushConstants
 	{
 		rtmcpp::PackedMat4 ViewProjection;
 		uint64_t Vertices;
+		// NOTE(Peter): BatchVertexFormat, the vertex shader decodes the vertices based on this
+		uint32_t VertexFormat;
 	} PC;
 
-	struct BatchedVertex
-	{
-		rtmcpp::PackedVec2 Position;
-		rtmcpp::PackedVec2 UV;
-		uint32_t Color;
-		uint32_t Texture = ~0u;
-	};
-
-	static constexpr float32_t QuadHalfSize = 8.0f;
-
-	template<>
-	struct Handle<GeometryBatch>::Impl
-	{
-		RHIContext Context;
-
-		std::vector<BatchedVertex> Vertices;
-		std::vector<uint32_t> Indices;
-		uint32_t BaseIndex = 0;
+	// Below this many batches per thread recording inline is cheaper than recording secondary lists
+	static constexpr uint32_t MinBatchesPerRecordingThread = 128;
 
-		Buffer VertexBuffer;
-		Buffer IndexBuffer;
-
-		std::vector<Image> Images;
-
-		bool IsDirty = false;
-
-		void CreateResources()
-		{
-			VertexBuffer = Buffer::Create(Context, Vertices.size() * sizeof(BatchedVertex), BufferUsage::StorageBuffer | BufferUsage::TransferDst);
-			IndexBuffer = Buffer::Create(Context, Indices.size() * sizeof(uint32_t), BufferUsage::IndexBuffer | BufferUsage::TransferDst);
-		}
-	};
-
-	BatchRenderer::BatchRenderer(RHIContext context, Aura::Span<ShaderConfig> shaders)
+	BatchRenderer::BatchRenderer(RHIContext context, Aura::Span<ShaderConfig> shaders, uint32_t framesInFlight)
 		: m_Context(context)
 	{
 		m_GraphicsQueue = context.RequestQueue(QueueType::Graphics);
 		m_TransferQueue = context.RequestQueue(QueueType::Transfer);
 
-		m_CommandPool = CommandPool::Create(context, m_GraphicsQueue);
+		m_CommandPools = ThreadCommandPools(context, m_GraphicsQueue, m_ThreadPool.GetThreadCount() + 1, framesInFlight);
 
 		m_UploadFence = Fence::Create(context);
 
@@ -62,7 +35,11 @@ namespace Yuki {
 			.PushConstantSize = sizeof(BatchPushConstants),
 			.ColorAttachmentFormats = {
 				ImageFormat::RGBA8Unorm
-			}
+			},
+			.DepthAttachmentFormat = ImageFormat::D32SFloat,
+			.DepthTest = true,
+			.DepthWrite = true,
+			.DepthCompareOp = CompareOp::LessOrEqual,
 		}, m_DescriptorHeap);
 
 		m_DefaultSampler = Sampler::Create(context, {
@@ -74,232 +51,377 @@ namespace Yuki {
 		m_DescriptorHeap.WriteSampler(0, m_DefaultSampler);
 		
 		// NOTE(Peter): Growable staging buffer (or several smaller staging buffers?)
- 		m_StagingBuffer = Buffer::Create(context, 10 * 1024 * 1024, BufferUsage::TransferSrc | BufferUsage::Mapped);
+ 		m_StagingBuffer = Buffer::Create(context, 10 * 1024 * 1024, BufferUsage::TransferSrc | BufferUsage::Mapped, MemoryCategory::Staging);
+
+		m_GeometryBuffers = GeometryBufferPool(context);
+
+		// NOTE(Peter): The copies wait for the frame fence, which is signalled on the graphics queue
+		m_Defragmenter = MemoryDefragmenter::Create(context, m_GraphicsQueue);
+	}
+
+	void BatchRenderer::Destroy()
+	{
+		m_Defragmenter.Destroy();
+		m_UploadFence.Wait();
+
+		// The batches can outlive the renderer, they just lose their GPU copies
+		for (auto batch : m_Batches)
+		{
+			batch->VertexBuffer = {};
+			batch->IndexBuffer = {};
+			batch->BufferPool = nullptr;
+		}
+		m_Batches.clear();
+
+		m_GeometryBuffers.Destroy();
+		m_StagingBuffer.Destroy();
+
+		if (m_FinalImage)
+		{
+			m_FinalImage.Destroy();
+		}
+
+		if (m_DepthImage)
+		{
+			m_DepthImage.Destroy();
+		}
+
+		m_CommandPools.Destroy();
+		m_Pipeline.Destroy();
+		m_DefaultSampler.Destroy();
+		m_DescriptorHeap.Destroy();
+		m_UploadFence.Destroy();
 	}
 
 	GeometryBatch BatchRenderer::NewBatch()
 	{
 		auto* batch = new GeometryBatch::Impl();
 		batch->Context = m_Context;
+		batch->BufferPool = &m_GeometryBuffers;
 		m_Batches.push_back({ batch });
 		return { batch };
 	}
 
+	std::vector<BatchRenderer::BufferCopy> BatchRenderer::PrepareUploads()
+	{
+		std::vector<BufferCopy> copies;
+		uint32_t stagingOffset = 0;
+
+		for (auto batch : m_Batches)
+		{
+			if (!batch->IsDirty)
+			{
+				continue;
+			}
+
+			batch->SortQuadsFrontToBack();
+
+			uint32_t vertexSize = batch->GetVertexDataSize(m_VertexFormat);
+			uint32_t indexSize = batch->GetIndexDataSize();
+
+			batch->CreateResources(vertexSize, indexSize);
+
+			for (uint32_t i = 0; i < batch->Images.size(); i++)
+			{
+				m_DescriptorHeap.WriteSampledImage(i, batch->Images[i].GetDefaultView());
+			}
+
+			batch->WriteVertices(m_StagingBuffer, stagingOffset, m_VertexFormat);
+			copies.push_back({ batch->VertexBuffer.Resource, vertexSize, stagingOffset, batch->VertexBuffer.Offset });
+			stagingOffset += vertexSize;
+
+			batch->WriteIndices(m_StagingBuffer, stagingOffset);
+			copies.push_back({ batch->IndexBuffer.Resource, indexSize, stagingOffset, batch->IndexBuffer.Offset });
+			// 16-bit indices can leave the offset misaligned for the next batch's vertices
+			stagingOffset += (indexSize + 3) & ~3u;
+
+			batch->IsDirty = false;
+		}
+
+		return copies;
+	}
+
 	void BatchRenderer::Render(const rtmcpp::Mat4& viewProjection, Fence fence)
 	{
 		PC.ViewProjection = viewProjection;
 
-		RenderingAttachment attachment = { m_FinalImage.GetDefaultView() };
+		// Moves buffers before anything is recorded, so everything below records the new buffers and addresses
+		m_Defragmenter.Update(fence);
+		auto defragmenterFence = m_Defragmenter.GetFence();
 
-		m_CommandPool.Reset();
+		m_CommandPools.NextFrame();
+		auto commandPool = m_CommandPools.GetPool(0);
 
-		uint32_t stagingOffset = 0;
+		m_GeometryBuffers.NextFrame(fence);
 
-		CommandList copyCmd = {};
+		bool hasDirtyBatches = std::ranges::any_of(m_Batches, [](const GeometryBatch& batch) { return batch->IsDirty; });
 
-		for (auto batch : m_Batches)
+		if (hasDirtyBatches)
 		{
-			if (batch->IsDirty)
+			// The previous upload has to be done reading the staging buffer before we overwrite it,
+			// that upload was submitted a frame ago so this should practically never block
+			m_UploadFence.Wait();
+
+			auto copyCmd = commandPool.NewList();
+
 			{
-				if (!copyCmd)
+				// NOTE(Peter): Not every transfer queue can write timestamps, the upload just isn't profiled on those
+				GPUProfileScope scope(m_TransferQueue.SupportsTimestamps() ? m_Profiler : nullptr, copyCmd, "Batch Upload");
+
+				for (const auto& copy : PrepareUploads())
 				{
-					copyCmd = m_CommandPool.NewList();
+					copyCmd.CopyBuffer(copy.Target, m_StagingBuffer, copy.Size, copy.StagingOffset, copy.TargetOffset);
 				}
+			}
 
-				batch->CreateResources();
+			copyCmd.End();
 
-				for (uint32_t i = 0; i < batch->Images.size(); i++)
-				{
-					m_DescriptorHeap.WriteSampledImage(i, batch->Images[i].GetDefaultView());
-				}
+			// The uploads may write blocks the defragmenter is still copying
+			m_SubmitBatch.Add(m_TransferQueue, { copyCmd }, { defragmenterFence }, { m_UploadFence });
+		}
 
-				uint32_t vertexSize = static_cast<uint32_t>(batch->Vertices.size()) * sizeof(BatchedVertex);
-				uint32_t indexSize = static_cast<uint32_t>(batch->Indices.size()) * sizeof(uint32_t);
+		auto cmd = commandPool.NewList();
 
-				m_StagingBuffer.Set(Aura::Span{ batch->Vertices.data(), static_cast<uint32_t>(batch->Vertices.size()) }, stagingOffset);
-				copyCmd.CopyBuffer(batch->VertexBuffer, m_StagingBuffer, vertexSize, stagingOffset);
-				stagingOffset += vertexSize;
-				m_StagingBuffer.Set(Aura::Span{ batch->Indices.data(), static_cast<uint32_t>(batch->Indices.size()) }, stagingOffset);
-				copyCmd.CopyBuffer(batch->IndexBuffer, m_StagingBuffer, indexSize, stagingOffset);
-				stagingOffset += indexSize;
+		{
+			GPUProfileScope scope(m_Profiler, cmd, "Batch Render");
+
+			// Both attachments are cleared when rendering begins, so last frame's contents can be dropped
+			cmd.Barrier({
+				{ m_FinalImage, ResourceAccess::ColorAttachmentWrite, true },
+				{ m_DepthImage, ResourceAccess::DepthAttachmentWrite, true },
+			});
+
+			RecordDraws(cmd, m_FinalImage, m_DepthImage);
+
+			cmd.Barrier({ { m_FinalImage, ResourceAccess::TransferRead } });
+		}
 
-				batch->IsDirty = false;
+		cmd.End();
+
+		// The draws wait for the uploads on the GPU instead of us stalling for them on the CPU
+		if (hasDirtyBatches)
+		{
+			m_SubmitBatch.Add(m_GraphicsQueue, { cmd }, { fence, m_UploadFence, defragmenterFence }, { fence });
+		}
+		else
+		{
+			m_SubmitBatch.Add(m_GraphicsQueue, { cmd }, { fence, defragmenterFence }, { fence });
+		}
+
+		m_SubmitBatch.Flush();
+	}
+
+	RenderGraphImage BatchRenderer::AddPasses(RenderGraph& graph, const rtmcpp::Mat4& viewProjection, Fence fence)
+	{
+		PC.ViewProjection = viewProjection;
+
+		m_CommandPools.NextFrame();
+
+		// Older frames may still be drawing from released ranges if there are more than two frames in flight
+		m_GeometryBuffers.NextFrame(fence);
+
+		// NOTE(Peter): The uploads run on the graph's queue, so the graph orders them before the draws
+		//              with buffer barriers instead of a fence wait
+		auto copies = PrepareUploads();
+		auto stagingBuffer = graph.ImportBuffer(m_StagingBuffer);
+
+		// Batches share the pool's blocks, every block is imported once and used once per pass
+		std::unordered_map<Buffer::ID, RenderGraphBuffer> importedBuffers;
+		auto importBuffer = [&](std::vector<RenderGraphBuffer>& buffers, Buffer buffer)
+		{
+			auto [it, inserted] = importedBuffers.try_emplace(buffer.GetID());
+			if (inserted)
+			{
+				it->second = graph.ImportBuffer(buffer);
+			}
+
+			if (std::ranges::find(buffers, it->second.Index, &RenderGraphBuffer::Index) == buffers.end())
+			{
+				buffers.push_back(it->second);
 			}
+		};
+
+		std::vector<RenderGraphBuffer> copyTargets;
+		for (const auto& copy : copies)
+		{
+			importBuffer(copyTargets, copy.Target);
 		}
 
-		if (copyCmd)
+		if (!copies.empty())
 		{
-			m_TransferQueue.SubmitCommandLists({ copyCmd }, {}, { m_UploadFence });
+			graph.AddPass("Batch Upload", [&](RenderGraphPassBuilder& builder)
+			{
+				builder.Read(stagingBuffer, ResourceAccess::TransferRead);
 
-			// NOTE(Peter): Potentially quite slow, horrible regardless, consider double-buffering
-			m_UploadFence.Wait();
+				for (auto target : copyTargets)
+				{
+					builder.Write(target, ResourceAccess::TransferWrite);
+				}
+			},
+			[this, copies = std::move(copies)](CommandList commandList, const RenderGraph&)
+			{
+				for (const auto& copy : copies)
+				{
+					commandList.CopyBuffer(copy.Target, m_StagingBuffer, copy.Size, copy.StagingOffset, copy.TargetOffset);
+				}
+			});
 		}
 
-		auto cmd = m_CommandPool.NewList();
-		cmd.TransitionImage(m_FinalImage, ImageLayout::AttachmentOptimal);
-		cmd.BeginRendering({ attachment });
-		cmd.BindPipeline(m_Pipeline);
-		cmd.BindDescriptorHeap(m_DescriptorHeap, m_Pipeline);
-		cmd.SetViewports({ m_Viewport });
+		auto colorImage = graph.ImportImage(m_FinalImage);
+		auto depthImage = graph.CreateImage({ m_Viewport.Width, m_Viewport.Height, ImageFormat::D32SFloat });
 
+		// Vertex and index blocks are separate, so every block is read with one kind of access
+		std::vector<RenderGraphBuffer> vertexBuffers, indexBuffers;
 		for (auto batch : m_Batches)
 		{
-			if (!batch->VertexBuffer || !batch->IndexBuffer)
+			if (!batch->VertexBuffer.IsValid() || !batch->IndexBuffer.IsValid())
 			{
 				continue;
 			}
 
-			PC.Vertices = batch->VertexBuffer.GetAddress();
-			cmd.SetPushConstants(m_Pipeline, PC);
-			cmd.BindIndexBuffer(batch->IndexBuffer);
-			cmd.DrawIndexed(static_cast<uint32_t>(batch->Indices.size()), 0);
+			importBuffer(vertexBuffers, batch->VertexBuffer.Resource);
+			importBuffer(indexBuffers, batch->IndexBuffer.Resource);
 		}
 
-		cmd.EndRendering();
-		cmd.TransitionImage(m_FinalImage, ImageLayout::TransferSrc);
+		graph.AddPass("Batch Render", [&](RenderGraphPassBuilder& builder)
+		{
+			builder.Write(colorImage, ResourceAccess::ColorAttachmentWrite);
+			builder.Write(depthImage, ResourceAccess::DepthAttachmentWrite);
 
-		m_GraphicsQueue.SubmitCommandLists({ cmd }, { fence }, { fence });
-	}
+			// Vertices are pulled through their buffer address in the vertex shader
+			for (auto buffer : vertexBuffers)
+			{
+				builder.Read(buffer, ResourceAccess::ShaderRead);
+			}
 
-	void BatchRenderer::SetSize(uint32_t width, uint32_t height)
-	{
-		if (m_FinalImage)
+			for (auto buffer : indexBuffers)
+			{
+				builder.Read(buffer, ResourceAccess::IndexRead);
+			}
+		},
+		[this, colorImage, depthImage](CommandList commandList, const RenderGraph& graph)
 		{
-			m_FinalImage.Destroy();
-		}
-
-		m_FinalImage = Image::Create(m_Context, {
-			.Width = width,
-			.Height = height,
-			.Format = ImageFormat::RGBA8Unorm,
-			.Usage = ImageUsage::ColorAttachment | ImageUsage::TransferSrc,
-			.CreateDefaultView = true
+			RecordDraws(commandList, graph.GetImage(colorImage), graph.GetImage(depthImage));
 		});
 
-		m_Viewport = { width, height };
+		return colorImage;
 	}
 
-	void GeometryBatch::Clear() const
+	void BatchRenderer::RecordDraws(CommandList commandList, Image colorImage, Image depthImage)
 	{
-		m_Impl->Vertices.clear();
-		m_Impl->Indices.clear();
-		m_Impl->BaseIndex = 0;
+		RenderingAttachment attachment = { colorImage.GetDefaultView() };
+		RenderingAttachment depthAttachment = { depthImage.GetDefaultView() };
 
-		if (m_Impl->VertexBuffer)
-		{
-			m_Impl->VertexBuffer.Destroy();
-		}
+		// Draw the batches with the nearest geometry first, the quads within each batch are already sorted
+		std::vector<GeometryBatch> drawOrder = m_Batches;
+		std::ranges::stable_sort(drawOrder, {}, [](const GeometryBatch& batch) { return batch->GetNearestDepth(); });
+
+		uint32_t batchCount = static_cast<uint32_t>(drawOrder.size());
+		uint32_t threadCount = std::min(m_CommandPools.GetThreadCount(), batchCount / MinBatchesPerRecordingThread);
 
-		if (m_Impl->IndexBuffer)
+		if (threadCount <= 1)
 		{
-			m_Impl->IndexBuffer.Destroy();
+			commandList.BeginRendering({ attachment }, depthAttachment);
+			RecordBatches(commandList, { drawOrder.data(), batchCount });
 		}
-
-		m_Impl->Images.clear();
-	}
-
-	void GeometryBatch::AddQuad(rtmcpp::Vec2 position, rtmcpp::Vec4 color) const
-	{
-		// Add new vertices
+		else
 		{
-			m_Impl->Vertices.push_back({
-				.Position = {  position.X - QuadHalfSize, position.Y + QuadHalfSize },
-				.Color = rtmcpp::PackUnorm4x8<float>(color)
-			});
+			// Every thread records a contiguous range of the draw order, so executing the secondaries
+			// in thread order keeps the batches sorted front to back
+			std::vector<CommandList> secondaries(threadCount);
+			uint32_t batchesPerThread = (batchCount + threadCount - 1) / threadCount;
 
-			m_Impl->Vertices.push_back({
-				.Position = {  position.X + QuadHalfSize, position.Y + QuadHalfSize },
-				.Color = rtmcpp::PackUnorm4x8<float>(color)
-			});
+			m_ThreadPool.ParallelFor(threadCount, [&](uint32_t threadIndex)
+			{
+				uint32_t start = std::min(threadIndex * batchesPerThread, batchCount);
+				uint32_t end = std::min(start + batchesPerThread, batchCount);
 
-			m_Impl->Vertices.push_back({
-				.Position = {  position.X + QuadHalfSize, position.Y - QuadHalfSize },
-				.Color = rtmcpp::PackUnorm4x8<float>(color)
+				auto secondary = m_CommandPools.GetPool(threadIndex).NewSecondaryList({ ImageFormat::RGBA8Unorm }, ImageFormat::D32SFloat);
+				RecordBatches(secondary, { drawOrder.data() + start, end - start });
+				secondaries[threadIndex] = secondary;
 			});
 
-			m_Impl->Vertices.push_back({
-				.Position = {  position.X - QuadHalfSize, position.Y - QuadHalfSize },
-				.Color = rtmcpp::PackUnorm4x8<float>(color)
-			});
+			commandList.BeginRendering({ attachment }, depthAttachment, RenderingContents::SecondaryLists);
+			commandList.ExecuteSecondaries({ secondaries.data(), threadCount });
 		}
 
-		// Add new indices
-		{
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 0);
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 1);
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 2);
-		
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 2);
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 3);
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 0);
-
-			m_Impl->BaseIndex += 4;
-		}
+		commandList.EndRendering();
 	}
 
-	void GeometryBatch::AddTexturedQuad(rtmcpp::Vec2 position, Image image) const
+	void BatchRenderer::RecordBatches(CommandList commandList, Aura::Span<GeometryBatch> batches) const
 	{
-		uint32_t imageIndex = ~0u;
+		commandList.BindPipeline(m_Pipeline);
+		commandList.BindDescriptorHeap(m_DescriptorHeap, m_Pipeline);
+		commandList.SetViewports({ m_Viewport });
+
+		// Every recording thread needs its own copy, only the view projection is shared
+		BatchPushConstants pushConstants = PC;
 
-		for (uint32_t i = 0; i < m_Impl->Images.size(); i++)
+		for (auto batch : batches)
 		{
-			if (m_Impl->Images[i] == image)
+			if (!batch->VertexBuffer.IsValid() || !batch->IndexBuffer.IsValid())
 			{
-				imageIndex = i;
-				break;
+				continue;
 			}
-		}
 
-		if (imageIndex == ~0u)
-		{
-			imageIndex = static_cast<uint32_t>(m_Impl->Images.size());
-			m_Impl->Images.push_back(image);
+			pushConstants.Vertices = batch->VertexBuffer.GetAddress();
+			pushConstants.VertexFormat = std::to_underlying(batch->UploadedVertexFormat);
+			commandList.SetPushConstants(m_Pipeline, pushConstants);
+			commandList.BindIndexBuffer(batch->IndexBuffer.Resource, batch->UploadedIndexType, batch->IndexBuffer.Offset);
+			commandList.DrawIndexed(static_cast<uint32_t>(batch->Indices.size()), 0);
 		}
+	}
 
-		// Add new vertices
+	void BatchRenderer::SetVertexFormat(BatchVertexFormat format)
+	{
+		if (m_VertexFormat == format)
 		{
-			m_Impl->Vertices.push_back({
-				.Position = {  position.X - QuadHalfSize, position.Y + QuadHalfSize },
-				.UV = { 0.0f, 1.0f },
-				.Texture = imageIndex
-			});
+			return;
+		}
 
-			m_Impl->Vertices.push_back({ 
-				.Position = {  position.X + QuadHalfSize, position.Y + QuadHalfSize },
-				.UV = { 1.0f, 1.0f },
-				.Texture = imageIndex
-			});
+		m_VertexFormat = format;
 
-			m_Impl->Vertices.push_back({ 
-				.Position = {  position.X + QuadHalfSize, position.Y - QuadHalfSize },
-				.UV = { 1.0f, 0.0f },
-				.Texture = imageIndex
-			});
+		// Everything that's already been uploaded has to be re-encoded
+		for (auto batch : m_Batches)
+		{
+			if (batch->VertexBuffer.IsValid())
+			{
+				batch->IsDirty = true;
+			}
+		}
+	}
 
-			m_Impl->Vertices.push_back({ 
-				.Position = {  position.X - QuadHalfSize, position.Y - QuadHalfSize },
-				.UV = { 0.0f, 0.0f },
-				.Texture = imageIndex
-			});
+	void BatchRenderer::SetSize(uint32_t width, uint32_t height)
+	{
+		if (m_FinalImage)
+		{
+			m_FinalImage.Destroy();
 		}
 
-		// Add new indices
+		if (m_DepthImage)
 		{
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 0);
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 1);
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 2);
+			m_DepthImage.Destroy();
+		}
 
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 2);
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 3);
-			m_Impl->Indices.push_back(m_Impl->BaseIndex + 0);
+		m_FinalImage = Image::Create(m_Context, {
+			.Width = width,
+			.Height = height,
+			.Format = ImageFormat::RGBA8Unorm,
+			.Usage = ImageUsage::ColorAttachment | ImageUsage::TransferSrc,
+			.CreateDefaultView = true,
+			.Category = MemoryCategory::RenderTargets
+		});
 
-			m_Impl->BaseIndex += 4;
-		}
-	}
+		m_DepthImage = Image::Create(m_Context, {
+			.Width = width,
+			.Height = height,
+			.Format = ImageFormat::D32SFloat,
+			.Usage = ImageUsage::DepthStencilAttachment,
+			.CreateDefaultView = true,
+			.Category = MemoryCategory::RenderTargets
+		});
 
-	void GeometryBatch::MarkDirty() const
-	{
-		m_Impl->IsDirty = true;
+		m_Viewport = { width, height };
 	}
 
 }
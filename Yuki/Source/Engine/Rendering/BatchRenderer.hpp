@@ -1,25 +1,82 @@
 #pragma once
 
 #include "GeometryBatch.hpp"
+#include "GeometryBufferPool.hpp"
+#include "RenderGraph.hpp"
 #include "Engine/RHI/RHI.hpp"
+#include "Engine/RHI/ThreadCommandPools.hpp"
+#include "Engine/Core/ThreadPool.hpp"
 
 #include <rtmcpp/Vector.hpp>
 #include <rtmcpp/Matrix.hpp>
 
 namespace Yuki {
 
+	// The layout batch vertices are uploaded to the GPU in, the CPU-side vertices are always kept at full precision
+	enum class BatchVertexFormat
+	{
+		// 28 bytes, 32-bit float position, depth and UVs and a 32-bit texture index
+		Full,
+
+		// 16 bytes, half-float position, 16-bit unorm depth and UVs and a 16-bit texture index
+		CompactHalf,
+
+		// 16 bytes, signed 12.4 fixed-point position (+-2048 units, 1/16th precision),
+		// 16-bit unorm depth and UVs and a 16-bit texture index
+		CompactFixed,
+	};
+
 	class BatchRenderer
 	{
 	public:
-		BatchRenderer(RHIContext context, Aura::Span<ShaderConfig> shaders);
+		// The shaders have to read the vertices through the push constant address in every BatchVertexFormat,
+		// see EngineTester/Resources/GLSL/Batch.vert.glsl and Batch.frag.glsl.
+		// Render and AddPasses reuse the command lists of the frame framesInFlight frames ago, the GPU has to be done with it.
+		// The renderer owns the context's MemoryDefragmenter, so no other one can be created while it exists.
+		BatchRenderer(RHIContext context, Aura::Span<ShaderConfig> shaders, uint32_t framesInFlight);
+
+		// Has to be called before the context is destroyed, once the GPU is done with every frame that was rendered
+		void Destroy();
 
 		GeometryBatch NewBatch();
 
+		// Also runs a defragmentation pass every frame, its copies wait for the last value signalled on fence.
+		// Only the renderer's own geometry buffers are movable, other submits only have to wait for GetDefragmenterFence if they
+		// use buffers created with BufferUsage::Movable.
 		void Render(const rtmcpp::Mat4& viewProjection, Fence fence);
+		Fence GetDefragmenterFence() const { return m_Defragmenter.GetFence(); }
+
+		// Adds the upload and draw passes to graph instead of submitting them, the depth buffer becomes a transient graph image.
+		// The GPU has to be done with the previous frame since the staging buffer is rewritten right away. fence is the frame fence
+		// the graph's submit signals, released geometry ranges are only reused once it has passed the frames that drew them.
+		// NOTE(Peter): Memory isn't defragmented on this path, the graph's submit doesn't wait for the copies
+		RenderGraphImage AddPasses(RenderGraph& graph, const rtmcpp::Mat4& viewProjection, Fence fence);
+
+		void SetVertexFormat(BatchVertexFormat format);
 
 		void SetSize(uint32_t width, uint32_t height);
 		Image GetFinalImage() const { return m_FinalImage; }
 
+		// Render records its upload and draw lists in scopes, passes added to a graph are profiled by the graph instead
+		void SetProfiler(GPUProfiler* profiler) { m_Profiler = profiler; }
+
+		// Binds and push constant uploads skipped while recording the last frame
+		StateCacheStatistics GetStateCacheStatistics() const { return m_CommandPools.GetStateCacheStatistics(); }
+
+	private:
+		// Writes the dirty batches to the staging buffer and returns the copies that upload them
+		struct BufferCopy
+		{
+			Buffer Target;
+			uint32_t Size;
+			uint32_t StagingOffset;
+			uint32_t TargetOffset;
+		};
+		std::vector<BufferCopy> PrepareUploads();
+
+		void RecordDraws(CommandList commandList, Image colorImage, Image depthImage);
+		void RecordBatches(CommandList commandList, Aura::Span<GeometryBatch> batches) const;
+
 	private:
 		RHIContext m_Context;
 		Queue m_GraphicsQueue, m_TransferQueue;
@@ -29,14 +86,23 @@ namespace Yuki {
 		Sampler m_DefaultSampler;
 
 		GraphicsPipeline m_Pipeline;
-		CommandPool m_CommandPool;
+
+		// Pool 0 is also used for the primary lists, which are only recorded while no worker is recording
+		ThreadPool m_ThreadPool;
+		ThreadCommandPools m_CommandPools;
+		SubmitBatch m_SubmitBatch;
 
 		Image m_FinalImage;
+		Image m_DepthImage;
 		Viewport m_Viewport;
 
 		Buffer m_StagingBuffer;
+		GeometryBufferPool m_GeometryBuffers;
+		MemoryDefragmenter m_Defragmenter;
 
 		std::vector<GeometryBatch> m_Batches;
+		GPUProfiler* m_Profiler = nullptr;
+		BatchVertexFormat m_VertexFormat = BatchVertexFormat::Full;
 	};
 
 }
@@ -0,0 +1,767 @@
+#include "GLTFLoader.hpp"
+#include "ImageProcessor.hpp"
+
+#include "Engine/IO/FileIO.hpp"
+#include "Engine/Core/Hash.hpp"
+
+#include <fastgltf/core.hpp>
+#include <fastgltf/tools.hpp>
+#include <fastgltf/types.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <span>
+
+namespace Yuki {
+
+	// Reads accessors straight out of the buffers we've resolved ourselves, external buffers are mapped rather than loaded by fastgltf
+	struct GLTFBufferAdapter
+	{
+		const std::vector<std::span<const std::byte>>& Buffers;
+
+		fastgltf::span<const std::byte> operator()(const fastgltf::Asset& asset, std::size_t bufferViewIndex) const
+		{
+			const auto& bufferView = asset.bufferViews[bufferViewIndex];
+			const auto& buffer = Buffers[bufferView.bufferIndex];
+			return { buffer.data() + bufferView.byteOffset, bufferView.byteLength };
+		}
+	};
+
+	static constexpr uint32_t s_GeometryCacheMagic = 0x48534D59; // YMSH
+	static constexpr uint32_t s_GeometryCacheVersion = 1;
+
+	// Followed by a FirstIndex and IndexCount pair for every primitive, the vertices and the indices
+	struct GeometryCacheHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+
+		// Of the geometry before it was optimized
+		uint64_t SourceHash;
+
+		uint32_t PrimitiveCount;
+		uint32_t VertexCount;
+		uint32_t IndexCount;
+		uint32_t Reserved;
+	};
+
+	// Where the vertices and indices of a primitive go in the model's buffers
+	struct PrimitiveRange
+	{
+		const fastgltf::Primitive* Primitive;
+		uint32_t FirstVertex;
+		uint32_t VertexCount;
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+	};
+
+	void Model::Destroy()
+	{
+		VertexBuffer.Destroy();
+		IndexBuffer.Destroy();
+
+		for (auto image : Images)
+		{
+			if (image)
+			{
+				image.Destroy();
+			}
+		}
+
+		Images.clear();
+		Meshes.clear();
+		Instances.clear();
+	}
+
+	GLTFLoader::GLTFLoader(RHIContext context, std::filesystem::path cacheDirectory, const MeshImportSettings& meshSettings)
+		: m_Context(context), m_Importer(std::move(cacheDirectory)), m_MeshSettings(meshSettings)
+	{
+		m_ThreadPool = Aura::Unique<ThreadPool>::New();
+
+		m_TextureSettings =
+		{
+			.Format = context.IsImageFormatSupported(ImageFormat::BC7RGBAUnorm) ? ImageFormat::BC7RGBAUnorm : ImageFormat::RGBA8Unorm,
+			.GenerateMips = true,
+			.IsSRGB = true,
+		};
+	}
+
+	Model GLTFLoader::Load(const std::filesystem::path& filepath)
+	{
+		auto models = LoadBatch({ filepath });
+		return std::move(models[0]);
+	}
+
+	std::vector<Model> GLTFLoader::LoadBatch(Aura::Span<std::filesystem::path> filepaths)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+
+		// NOTE(Peter): Each file fans out across the same threads again for its buffers, primitives and images
+		std::vector<ParsedModel> parsedModels(filepaths.Count());
+		m_ThreadPool->ParallelFor(filepaths.Count(), [&](uint32_t index)
+		{
+			parsedModels[index] = Parse(filepaths[index]);
+		});
+
+		m_Statistics = {};
+
+		uint64_t stagingSize = 0;
+		uint32_t vertexStride = m_MeshSettings.Quantize ? sizeof(QuantizedMeshVertex) : sizeof(MeshVertex);
+
+		for (const auto& parsed : parsedModels)
+		{
+			m_Statistics.SourceBytes += parsed.SourceBytes;
+
+			if (parsed.IsValid())
+			{
+				stagingSize += parsed.Vertices.size() * vertexStride + parsed.Indices.size() * sizeof(uint32_t);
+				m_Statistics.ModelCount++;
+			}
+		}
+
+		std::vector<Model> models(filepaths.Count());
+
+		// The geometry of every model goes through one staging buffer in a single submit
+		if (stagingSize > 0)
+		{
+			// NOTE(Peter): Buffer offsets and copy sizes are 32-bit, batches with more than 4 GB of geometry have to be split up
+			YukiAssert(stagingSize <= std::numeric_limits<uint32_t>::max());
+
+			auto uploadFence = Fence::Create(m_Context);
+			auto stagingBuffer = Buffer::Create(m_Context, stagingSize, BufferUsage::TransferSrc | BufferUsage::Mapped, MemoryCategory::Staging);
+
+			auto queue = m_Context.RequestQueue(QueueType::Transfer);
+			auto pool = CommandPool::Create(m_Context, queue);
+			auto cmd = pool.NewList();
+
+			uint32_t offset = 0;
+
+			auto upload = [&](BufferUsage usage, const void* data, uint64_t size)
+			{
+				auto buffer = Buffer::Create(m_Context, size, usage | BufferUsage::TransferDst, MemoryCategory::Meshes);
+				stagingBuffer.SetData(static_cast<const std::byte*>(data), offset, static_cast<uint32_t>(size));
+				cmd.CopyBuffer(buffer, stagingBuffer, static_cast<uint32_t>(size), offset);
+				offset += static_cast<uint32_t>(size);
+				return buffer;
+			};
+
+			for (uint32_t i = 0; i < parsedModels.size(); i++)
+			{
+				auto& parsed = parsedModels[i];
+
+				if (!parsed.IsValid())
+				{
+					continue;
+				}
+
+				auto& model = models[i];
+				model.VertexStride = vertexStride;
+
+				if (m_MeshSettings.Quantize)
+				{
+					float32_t min[3] = { std::numeric_limits<float32_t>::max(), std::numeric_limits<float32_t>::max(), std::numeric_limits<float32_t>::max() };
+					float32_t max[3] = { std::numeric_limits<float32_t>::lowest(), std::numeric_limits<float32_t>::lowest(), std::numeric_limits<float32_t>::lowest() };
+
+					for (const auto& vertex : parsed.Vertices)
+					{
+						const float32_t position[3] = { vertex.Position.X, vertex.Position.Y, vertex.Position.Z };
+
+						for (uint32_t j = 0; j < 3; j++)
+						{
+							min[j] = std::min(min[j], position[j]);
+							max[j] = std::max(max[j], position[j]);
+						}
+					}
+
+					model.PositionMin = { min[0], min[1], min[2] };
+					model.PositionScale = { max[0] - min[0], max[1] - min[1], max[2] - min[2] };
+
+					std::vector<QuantizedMeshVertex> quantized(parsed.Vertices.size());
+
+					for (uint32_t j = 0; j < quantized.size(); j++)
+					{
+						quantized[j] = MeshOptimizer::QuantizeVertex(parsed.Vertices[j], model.PositionMin, model.PositionScale);
+					}
+
+					model.VertexBuffer = upload(BufferUsage::VertexBuffer, quantized.data(), quantized.size() * sizeof(QuantizedMeshVertex));
+				}
+				else
+				{
+					model.VertexBuffer = upload(BufferUsage::VertexBuffer, parsed.Vertices.data(), parsed.Vertices.size() * sizeof(MeshVertex));
+				}
+
+				model.IndexBuffer = upload(BufferUsage::IndexBuffer, parsed.Indices.data(), parsed.Indices.size() * sizeof(uint32_t));
+				model.Meshes = std::move(parsed.Meshes);
+				model.Instances = std::move(parsed.Instances);
+			}
+
+			cmd.End();
+
+			queue.SubmitCommandLists({ cmd }, {}, { uploadFence });
+
+			uploadFence.Wait();
+
+			pool.Destroy();
+			stagingBuffer.Destroy();
+			uploadFence.Destroy();
+		}
+
+		// Textures of every model are uploaded together as well
+		std::vector<TextureData> textures;
+
+		for (const auto& parsed : parsedModels)
+		{
+			if (parsed.IsValid())
+			{
+				textures.insert(textures.end(), std::make_move_iterator(parsed.Textures.begin()), std::make_move_iterator(parsed.Textures.end()));
+			}
+		}
+
+		for (const auto& texture : textures)
+		{
+			m_Statistics.UploadedBytes += texture.GetPixelsSize();
+		}
+
+		auto images = ImageProcessor::CreateFromTextures(m_Context, { textures.data(), static_cast<uint32_t>(textures.size()) });
+		uint32_t nextImage = 0;
+
+		for (uint32_t i = 0; i < parsedModels.size(); i++)
+		{
+			if (!parsedModels[i].IsValid())
+			{
+				continue;
+			}
+
+			auto imageCount = static_cast<uint32_t>(parsedModels[i].Textures.size());
+			models[i].Images.assign(images.begin() + nextImage, images.begin() + nextImage + imageCount);
+			nextImage += imageCount;
+		}
+
+		m_Statistics.UploadedBytes += stagingSize;
+		m_Statistics.Seconds = std::chrono::duration<float64_t>(std::chrono::steady_clock::now() - startTime).count();
+
+		WriteLine("Loaded {} of {} models, {:.1f} MB in {:.1f} ms ({:.1f} MB/s, {:.1f} MB uploaded)",
+			m_Statistics.ModelCount, filepaths.Count(),
+			m_Statistics.SourceBytes / (1024.0 * 1024.0), m_Statistics.Seconds * 1000.0,
+			m_Statistics.GetMegabytesPerSecond(), m_Statistics.UploadedBytes / (1024.0 * 1024.0));
+
+		return models;
+	}
+
+	GLTFLoader::ParsedModel GLTFLoader::Parse(const std::filesystem::path& filepath) const
+	{
+		auto file = FileIO::MapFile(filepath);
+
+		if (!file.IsValid())
+		{
+			WriteLine("Can't load model {}, failed to open the file.", LogLevel::Warn, filepath.string());
+			return {};
+		}
+
+		// NOTE(Peter): simdjson needs padding after the JSON, so the file has to be copied once
+		auto data = fastgltf::GltfDataBuffer::FromBytes(file.GetData(), file.GetSize());
+
+		if (data.error() != fastgltf::Error::None)
+		{
+			WriteLine("Can't load model {}, {}.", LogLevel::Warn, filepath.string(), fastgltf::getErrorMessage(data.error()));
+			return {};
+		}
+
+		// Parsers can't be shared between threads
+		thread_local fastgltf::Parser parser;
+
+		auto asset = parser.loadGltf(data.get(), filepath.parent_path(), fastgltf::Options::None);
+
+		if (asset.error() != fastgltf::Error::None)
+		{
+			WriteLine("Can't load model {}, {}.", LogLevel::Warn, filepath.string(), fastgltf::getErrorMessage(asset.error()));
+			return {};
+		}
+
+		std::atomic<uint64_t> sourceBytes = file.GetSize();
+		ThreadPool* threadPool = &*m_ThreadPool;
+
+		// External buffers are mapped, only the parts the accessors read are ever loaded from disk
+		std::vector<FileIO::MappedFile> bufferFiles(asset->buffers.size());
+		std::vector<std::span<const std::byte>> buffers(asset->buffers.size());
+
+		threadPool->ParallelFor(static_cast<uint32_t>(asset->buffers.size()), [&](uint32_t index)
+		{
+			const auto& buffer = asset->buffers[index];
+
+			std::visit(fastgltf::visitor {
+				[&](const fastgltf::sources::URI& uri)
+				{
+					if (!uri.uri.isLocalPath())
+					{
+						return;
+					}
+
+					bufferFiles[index] = FileIO::MapFile(filepath.parent_path() / uri.uri.fspath());
+
+					if (bufferFiles[index].IsValid() && uri.fileByteOffset + buffer.byteLength <= bufferFiles[index].GetSize())
+					{
+						buffers[index] = { bufferFiles[index].GetData() + uri.fileByteOffset, buffer.byteLength };
+						sourceBytes += buffer.byteLength;
+					}
+				},
+				[&](const fastgltf::sources::Array& array) { buffers[index] = { array.bytes.data(), array.bytes.size() }; },
+				[&](const fastgltf::sources::Vector& vector) { buffers[index] = { vector.bytes.data(), vector.bytes.size() }; },
+				[&](const fastgltf::sources::ByteView& view) { buffers[index] = { view.bytes.data(), view.bytes.size() }; },
+				[](const auto&) {},
+			}, buffer.data);
+		});
+
+		for (uint32_t i = 0; i < buffers.size(); i++)
+		{
+			if (buffers[i].empty() && asset->buffers[i].byteLength > 0)
+			{
+				WriteLine("Can't load model {}, buffer {} couldn't be read.", LogLevel::Warn, filepath.string(), i);
+				return {};
+			}
+		}
+
+		ParsedModel result;
+
+		// Only the images used as base color textures are loaded, and each of them only once
+		std::vector<int32_t> imageSlots(asset->images.size(), -1);
+		std::vector<uint32_t> usedImages;
+
+		auto getBaseColorImage = [&](const fastgltf::Primitive& primitive) -> int32_t
+		{
+			if (!primitive.materialIndex.has_value())
+			{
+				return -1;
+			}
+
+			const auto& baseColor = asset->materials[primitive.materialIndex.value()].pbrData.baseColorTexture;
+
+			if (!baseColor.has_value())
+			{
+				return -1;
+			}
+
+			const auto& texture = asset->textures[baseColor->textureIndex];
+
+			if (!texture.imageIndex.has_value())
+			{
+				return -1;
+			}
+
+			auto imageIndex = texture.imageIndex.value();
+
+			if (imageSlots[imageIndex] == -1)
+			{
+				imageSlots[imageIndex] = static_cast<int32_t>(usedImages.size());
+				usedImages.push_back(static_cast<uint32_t>(imageIndex));
+			}
+
+			return imageSlots[imageIndex];
+		};
+
+		// Lays out every primitive up front so they can all be read in parallel
+		std::vector<PrimitiveRange> ranges;
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+
+		for (const auto& gltfMesh : asset->meshes)
+		{
+			auto& mesh = result.Meshes.emplace_back();
+			mesh.Name.assign(gltfMesh.name.begin(), gltfMesh.name.end());
+
+			for (const auto& primitive : gltfMesh.primitives)
+			{
+				auto position = primitive.findAttribute("POSITION");
+
+				if (primitive.type != fastgltf::PrimitiveType::Triangles || position == primitive.attributes.end())
+				{
+					WriteLine("Skipping a primitive of mesh {} in {}, only triangles with positions are supported.", LogLevel::Warn, mesh.Name, filepath.string());
+					continue;
+				}
+
+				PrimitiveRange range =
+				{
+					.Primitive = &primitive,
+					.FirstVertex = vertexCount,
+					.VertexCount = static_cast<uint32_t>(asset->accessors[position->accessorIndex].count),
+					.FirstIndex = indexCount,
+				};
+
+				range.IndexCount = primitive.indicesAccessor.has_value() ? static_cast<uint32_t>(asset->accessors[primitive.indicesAccessor.value()].count) : range.VertexCount;
+
+				mesh.Primitives.push_back({ range.FirstIndex, range.IndexCount, getBaseColorImage(primitive) });
+
+				vertexCount += range.VertexCount;
+				indexCount += range.IndexCount;
+				ranges.push_back(range);
+			}
+		}
+
+		result.Vertices.resize(vertexCount);
+		result.Indices.resize(indexCount);
+		result.Textures.resize(usedImages.size());
+
+		GLTFBufferAdapter adapter = { buffers };
+
+		threadPool->ParallelFor(static_cast<uint32_t>(ranges.size()), [&](uint32_t index)
+		{
+			const auto& range = ranges[index];
+			const auto& primitive = *range.Primitive;
+			MeshVertex* vertices = result.Vertices.data() + range.FirstVertex;
+
+			for (uint32_t i = 0; i < range.VertexCount; i++)
+			{
+				vertices[i] = { .Normal = { 0.0f, 0.0f, 1.0f } };
+			}
+
+			fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(asset.get(), asset->accessors[primitive.findAttribute("POSITION")->accessorIndex],
+				[&](fastgltf::math::fvec3 position, std::size_t i) { vertices[i].Position = { position[0], position[1], position[2] }; }, adapter);
+
+			if (auto normal = primitive.findAttribute("NORMAL"); normal != primitive.attributes.end())
+			{
+				fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(asset.get(), asset->accessors[normal->accessorIndex],
+					[&](fastgltf::math::fvec3 value, std::size_t i) { vertices[i].Normal = { value[0], value[1], value[2] }; }, adapter);
+			}
+
+			if (auto uv = primitive.findAttribute("TEXCOORD_0"); uv != primitive.attributes.end())
+			{
+				fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(asset.get(), asset->accessors[uv->accessorIndex],
+					[&](fastgltf::math::fvec2 value, std::size_t i) { vertices[i].UV = { value[0], value[1] }; }, adapter);
+			}
+
+			// Indices are rebased onto the model's vertex buffer, so every primitive can be drawn without a vertex offset
+			uint32_t* indices = result.Indices.data() + range.FirstIndex;
+
+			if (!primitive.indicesAccessor.has_value())
+			{
+				for (uint32_t i = 0; i < range.IndexCount; i++)
+				{
+					indices[i] = range.FirstVertex + i;
+				}
+
+				return;
+			}
+
+			// NOTE(Peter): Clamped so a broken file can't make the GPU read past the end of the vertex buffer
+			fastgltf::iterateAccessorWithIndex<uint32_t>(asset.get(), asset->accessors[primitive.indicesAccessor.value()],
+				[&](uint32_t value, std::size_t i) { indices[i] = range.FirstVertex + std::min(value, range.VertexCount - 1); }, adapter);
+		});
+
+		if (m_MeshSettings.Optimize && !result.Indices.empty())
+		{
+			OptimizeGeometry(result, filepath);
+		}
+
+		threadPool->ParallelFor(static_cast<uint32_t>(usedImages.size()), [&](uint32_t index)
+		{
+			auto& texture = result.Textures[index];
+
+			std::visit(fastgltf::visitor {
+				[&](const fastgltf::sources::URI& uri)
+				{
+					if (!uri.uri.isLocalPath())
+					{
+						return;
+					}
+
+					auto imagePath = filepath.parent_path() / uri.uri.fspath();
+					texture = m_Importer.Import(imagePath, m_TextureSettings, threadPool);
+
+					std::error_code error;
+					sourceBytes += std::filesystem::file_size(imagePath, error);
+				},
+				[&](const fastgltf::sources::BufferView& view)
+				{
+					const auto& bufferView = asset->bufferViews[view.bufferViewIndex];
+					const std::byte* bytes = buffers[bufferView.bufferIndex].data() + bufferView.byteOffset;
+					texture = TextureImporter::ImportFromMemory(bytes, bufferView.byteLength, m_TextureSettings, threadPool);
+				},
+				[&](const fastgltf::sources::Array& array)
+				{
+					texture = TextureImporter::ImportFromMemory(array.bytes.data(), array.bytes.size(), m_TextureSettings, threadPool);
+				},
+				[&](const fastgltf::sources::Vector& vector)
+				{
+					texture = TextureImporter::ImportFromMemory(vector.bytes.data(), vector.bytes.size(), m_TextureSettings, threadPool);
+				},
+				[](const auto&) {},
+			}, asset->images[usedImages[index]].data);
+		});
+
+		if (!asset->scenes.empty())
+		{
+			auto sceneIndex = asset->defaultScene.has_value() ? asset->defaultScene.value() : 0;
+
+			fastgltf::iterateSceneNodes(asset.get(), sceneIndex, fastgltf::math::fmat4x4(), [&](fastgltf::Node& node, fastgltf::math::fmat4x4 matrix)
+			{
+				if (!node.meshIndex.has_value())
+				{
+					return;
+				}
+
+				MeshInstance instance = { .Mesh = static_cast<uint32_t>(node.meshIndex.value()) };
+				static_assert(sizeof(instance.Transform) == sizeof(matrix));
+				memcpy(&instance.Transform, matrix.data(), sizeof(matrix));
+				result.Instances.push_back(instance);
+			});
+		}
+		else
+		{
+			// Files without scenes are just a collection of meshes
+			const float32_t identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+			for (uint32_t i = 0; i < result.Meshes.size(); i++)
+			{
+				MeshInstance instance = { .Mesh = i };
+				memcpy(&instance.Transform, identity, sizeof(identity));
+				result.Instances.push_back(instance);
+			}
+		}
+
+		result.SourceBytes = sourceBytes;
+		return result;
+	}
+
+	void GLTFLoader::OptimizeGeometry(ParsedModel& model, const std::filesystem::path& filepath) const
+	{
+		auto startTime = std::chrono::steady_clock::now();
+
+		std::vector<MeshPrimitive*> primitives;
+
+		for (auto& mesh : model.Meshes)
+		{
+			for (auto& primitive : mesh.Primitives)
+			{
+				primitives.push_back(&primitive);
+			}
+		}
+
+		// NOTE(Peter): Keyed on the geometry itself rather than the file, models that only changed their materials
+		//              or node transforms keep using the same cache
+		uint64_t sourceHash = HashBytes(model.Vertices.data(), model.Vertices.size() * sizeof(MeshVertex), s_GeometryCacheVersion);
+		sourceHash = HashBytes(model.Indices.data(), model.Indices.size() * sizeof(uint32_t), sourceHash);
+
+		for (const auto* primitive : primitives)
+		{
+			const uint32_t range[2] = { primitive->FirstIndex, primitive->IndexCount };
+			sourceHash = HashBytes(range, sizeof(range), sourceHash);
+		}
+
+		std::filesystem::path cachePath;
+
+		if (!m_Importer.GetCacheDirectory().empty())
+		{
+			cachePath = m_Importer.GetCacheDirectory() / std::format("{}-{:016x}.ymesh", filepath.stem().string(), sourceHash);
+
+			if (ReadGeometryCache(cachePath, sourceHash, model))
+			{
+				return;
+			}
+		}
+
+		auto vertexCountBefore = static_cast<uint32_t>(model.Vertices.size());
+		float32_t acmrBefore = MeshOptimizer::CalculateACMR(model.Indices, vertexCountBefore);
+
+		struct OptimizedPrimitive
+		{
+			std::vector<MeshVertex> Vertices;
+			std::vector<uint32_t> Indices;
+		};
+
+		std::vector<OptimizedPrimitive> optimized(primitives.size());
+
+		m_ThreadPool->ParallelFor(static_cast<uint32_t>(primitives.size()), [&](uint32_t index)
+		{
+			const auto& primitive = *primitives[index];
+
+			if (primitive.IndexCount == 0)
+			{
+				return;
+			}
+
+			// Every primitive's indices only reach its own vertices, so they're optimized on their own
+			auto firstIndex = model.Indices.begin() + primitive.FirstIndex;
+			auto [minIndex, maxIndex] = std::minmax_element(firstIndex, firstIndex + primitive.IndexCount);
+			uint32_t firstVertex = *minIndex;
+
+			auto& result = optimized[index];
+			result.Vertices.assign(model.Vertices.begin() + firstVertex, model.Vertices.begin() + *maxIndex + 1);
+			result.Indices.resize(primitive.IndexCount);
+
+			for (uint32_t i = 0; i < primitive.IndexCount; i++)
+			{
+				result.Indices[i] = firstIndex[i] - firstVertex;
+			}
+
+			MeshOptimizer::DeduplicateVertices(result.Vertices, result.Indices);
+			MeshOptimizer::OptimizeVertexCache(result.Indices, static_cast<uint32_t>(result.Vertices.size()));
+			MeshOptimizer::OptimizeOverdraw(result.Indices, result.Vertices);
+			MeshOptimizer::OptimizeVertexFetch(result.Vertices, result.Indices);
+		});
+
+		uint64_t vertexCount = 0;
+		uint64_t indexCount = 0;
+
+		for (const auto& primitive : optimized)
+		{
+			vertexCount += primitive.Vertices.size();
+			indexCount += primitive.Indices.size();
+		}
+
+		std::vector<MeshVertex> vertices;
+		std::vector<uint32_t> indices;
+		vertices.reserve(vertexCount);
+		indices.reserve(indexCount);
+
+		for (uint32_t i = 0; i < primitives.size(); i++)
+		{
+			auto& primitive = *primitives[i];
+			const auto& source = optimized[i];
+			auto firstVertex = static_cast<uint32_t>(vertices.size());
+
+			primitive.FirstIndex = static_cast<uint32_t>(indices.size());
+			primitive.IndexCount = static_cast<uint32_t>(source.Indices.size());
+
+			vertices.insert(vertices.end(), source.Vertices.begin(), source.Vertices.end());
+
+			for (uint32_t index : source.Indices)
+			{
+				indices.push_back(firstVertex + index);
+			}
+		}
+
+		model.Vertices = std::move(vertices);
+		model.Indices = std::move(indices);
+
+		WriteLine("Optimized {} in {:.1f} ms, {} vertices down to {}, ACMR {:.3f} down to {:.3f}", filepath.string(),
+			std::chrono::duration<float64_t, std::milli>(std::chrono::steady_clock::now() - startTime).count(),
+			vertexCountBefore, model.Vertices.size(),
+			acmrBefore, MeshOptimizer::CalculateACMR(model.Indices, static_cast<uint32_t>(model.Vertices.size())));
+
+		if (!cachePath.empty())
+		{
+			WriteGeometryCache(cachePath, sourceHash, model);
+		}
+	}
+
+	bool GLTFLoader::ReadGeometryCache(const std::filesystem::path& cachePath, uint64_t sourceHash, ParsedModel& model)
+	{
+		auto file = FileIO::MapFile(cachePath);
+
+		if (!file.IsValid() || file.GetSize() < sizeof(GeometryCacheHeader))
+		{
+			return false;
+		}
+
+		GeometryCacheHeader header;
+		memcpy(&header, file.GetData(), sizeof(header));
+
+		uint32_t primitiveCount = 0;
+
+		for (const auto& mesh : model.Meshes)
+		{
+			primitiveCount += static_cast<uint32_t>(mesh.Primitives.size());
+		}
+
+		if (header.Magic != s_GeometryCacheMagic || header.Version != s_GeometryCacheVersion ||
+			header.SourceHash != sourceHash || header.PrimitiveCount != primitiveCount)
+		{
+			return false;
+		}
+
+		uint64_t primitivesSize = uint64_t(header.PrimitiveCount) * sizeof(uint32_t) * 2;
+		uint64_t verticesSize = uint64_t(header.VertexCount) * sizeof(MeshVertex);
+		uint64_t indicesSize = uint64_t(header.IndexCount) * sizeof(uint32_t);
+
+		if (sizeof(header) + primitivesSize + verticesSize + indicesSize > file.GetSize())
+		{
+			WriteLine("Geometry cache {} is truncated, optimizing the model again.", LogLevel::Warn, cachePath.string());
+			return false;
+		}
+
+		const std::byte* data = file.GetData() + sizeof(header);
+		std::vector<uint32_t> ranges(header.PrimitiveCount * 2);
+		memcpy(ranges.data(), data, primitivesSize);
+
+		// NOTE(Peter): A broken cache mustn't be able to make the GPU read past the end of the buffers
+		for (uint32_t i = 0; i < header.PrimitiveCount; i++)
+		{
+			if (uint64_t(ranges[i * 2]) + ranges[i * 2 + 1] > header.IndexCount)
+			{
+				return false;
+			}
+		}
+
+		std::vector<uint32_t> indices(header.IndexCount);
+		memcpy(indices.data(), data + primitivesSize + verticesSize, indicesSize);
+
+		for (uint32_t index : indices)
+		{
+			if (index >= header.VertexCount)
+			{
+				return false;
+			}
+		}
+
+		model.Vertices.resize(header.VertexCount);
+		memcpy(model.Vertices.data(), data + primitivesSize, verticesSize);
+		model.Indices = std::move(indices);
+
+		uint32_t primitiveIndex = 0;
+
+		for (auto& mesh : model.Meshes)
+		{
+			for (auto& primitive : mesh.Primitives)
+			{
+				primitive.FirstIndex = ranges[primitiveIndex * 2];
+				primitive.IndexCount = ranges[primitiveIndex * 2 + 1];
+				primitiveIndex++;
+			}
+		}
+
+		return true;
+	}
+
+	void GLTFLoader::WriteGeometryCache(const std::filesystem::path& cachePath, uint64_t sourceHash, const ParsedModel& model)
+	{
+		std::vector<uint32_t> ranges;
+
+		for (const auto& mesh : model.Meshes)
+		{
+			for (const auto& primitive : mesh.Primitives)
+			{
+				ranges.push_back(primitive.FirstIndex);
+				ranges.push_back(primitive.IndexCount);
+			}
+		}
+
+		GeometryCacheHeader header =
+		{
+			.Magic = s_GeometryCacheMagic,
+			.Version = s_GeometryCacheVersion,
+			.SourceHash = sourceHash,
+			.PrimitiveCount = static_cast<uint32_t>(ranges.size() / 2),
+			.VertexCount = static_cast<uint32_t>(model.Vertices.size()),
+			.IndexCount = static_cast<uint32_t>(model.Indices.size()),
+			.Reserved = 0,
+		};
+
+		uint64_t rangesSize = ranges.size() * sizeof(uint32_t);
+		uint64_t verticesSize = model.Vertices.size() * sizeof(MeshVertex);
+		uint64_t indicesSize = model.Indices.size() * sizeof(uint32_t);
+
+		std::vector<std::byte> bytes(sizeof(header) + rangesSize + verticesSize + indicesSize);
+		std::byte* data = bytes.data();
+		memcpy(data, &header, sizeof(header));
+		memcpy(data + sizeof(header), ranges.data(), rangesSize);
+		memcpy(data + sizeof(header) + rangesSize, model.Vertices.data(), verticesSize);
+		memcpy(data + sizeof(header) + rangesSize + verticesSize, model.Indices.data(), indicesSize);
+
+		// NOTE(Peter): Same as the texture cache, replaced atomically so nobody reads it half written
+		if (!FileIO::WriteFileAtomic(cachePath, bytes))
+		{
+			WriteLine("Failed to write geometry cache {}.", LogLevel::Warn, cachePath.string());
+		}
+	}
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Engine/RHI/RHI.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include "Engine/Rendering/TextureImporter.hpp"
+#include "Engine/Rendering/MeshOptimizer.hpp"
+
+#include <Aura/Unique.hpp>
+
+#include <rtmcpp/PackedVector.hpp>
+#include <rtmcpp/PackedMatrix.hpp>
+
+#include <filesystem>
+
+namespace Yuki {
+
+	struct MeshImportSettings
+	{
+		// Runs the MeshOptimizer passes on every primitive, the results are cached next to the textures
+		bool Optimize = true;
+
+		// Uploads QuantizedMeshVertex instead of MeshVertex
+		bool Quantize = false;
+	};
+
+	// A single draw, the indices already point at the primitive's vertices in the model's vertex buffer
+	struct MeshPrimitive
+	{
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+
+		// Into Model::Images, -1 if the primitive doesn't have a base color texture
+		int32_t BaseColorImage = -1;
+	};
+
+	struct Mesh
+	{
+		std::string Name;
+		std::vector<MeshPrimitive> Primitives;
+	};
+
+	// Every node of the default scene that has a mesh
+	struct MeshInstance
+	{
+		uint32_t Mesh;
+
+		// Column-major, relative to the root of the scene
+		rtmcpp::PackedMat4 Transform;
+	};
+
+	// Vertices are bound with BindVertexBuffer(VertexBuffer, VertexStride). The indices of every primitive are already rebased
+	// onto the model's vertex buffer, so a primitive is drawn with DrawIndexed(IndexCount, instance, FirstIndex) at a vertex offset of 0
+	struct Model
+	{
+		Buffer VertexBuffer;
+		Buffer IndexBuffer;
+
+		// sizeof(MeshVertex), or sizeof(QuantizedMeshVertex) if the model was quantized
+		uint32_t VertexStride = sizeof(MeshVertex);
+
+		// Quantized positions are decoded with PositionMin + Position * PositionScale
+		rtmcpp::PackedVec3 PositionMin = { 0.0f, 0.0f, 0.0f };
+		rtmcpp::PackedVec3 PositionScale = { 1.0f, 1.0f, 1.0f };
+
+		std::vector<Mesh> Meshes;
+		std::vector<MeshInstance> Instances;
+
+		// Base color textures, sRGB
+		std::vector<Image> Images;
+
+		bool IsValid() const { return !Meshes.empty(); }
+		void Destroy();
+	};
+
+	struct GLTFLoadStatistics
+	{
+		uint32_t ModelCount = 0;
+
+		// Read from disk, including external buffers and images
+		uint64_t SourceBytes = 0;
+
+		// Vertex, index and texture data copied to the GPU
+		uint64_t UploadedBytes = 0;
+
+		float64_t Seconds = 0.0;
+
+		float64_t GetMegabytesPerSecond() const { return Seconds > 0.0 ? SourceBytes / (1024.0 * 1024.0) / Seconds : 0.0; }
+	};
+
+	// Loads the triangle meshes and base color textures of glTF and GLB files into device local buffers and images.
+	// Files are parsed on worker threads, their buffers and images are decoded in parallel, and the geometry of every
+	// model in a load goes to the GPU through a single staging buffer and submit. Geometry is optimized for the vertex
+	// cache, overdraw and vertex fetch once and read from the cache after that, see MeshOptimizer.
+	class GLTFLoader
+	{
+	public:
+		// Textures and optimized geometry are cached in cacheDirectory, nothing is cached if it's empty
+		explicit GLTFLoader(RHIContext context, std::filesystem::path cacheDirectory = {}, const MeshImportSettings& meshSettings = {});
+
+		// Blocks until the model has been uploaded, returns an invalid model if it couldn't be loaded
+		Model Load(const std::filesystem::path& filepath);
+
+		// Loads every file concurrently, the models are in the same order as filepaths
+		std::vector<Model> LoadBatch(Aura::Span<std::filesystem::path> filepaths);
+
+		// Of the last call to Load or LoadBatch, also written to the log
+		const GLTFLoadStatistics& GetStatistics() const { return m_Statistics; }
+
+	private:
+		// Everything that's read on the worker threads, before anything is uploaded
+		struct ParsedModel
+		{
+			std::vector<MeshVertex> Vertices;
+			std::vector<uint32_t> Indices;
+			std::vector<Mesh> Meshes;
+			std::vector<MeshInstance> Instances;
+			std::vector<TextureData> Textures;
+
+			uint64_t SourceBytes = 0;
+
+			bool IsValid() const { return !Vertices.empty(); }
+		};
+
+	private:
+		ParsedModel Parse(const std::filesystem::path& filepath) const;
+
+		// Optimizes every primitive, or reads the result of doing so from the cache
+		void OptimizeGeometry(ParsedModel& model, const std::filesystem::path& filepath) const;
+
+		static bool ReadGeometryCache(const std::filesystem::path& cachePath, uint64_t sourceHash, ParsedModel& model);
+		static void WriteGeometryCache(const std::filesystem::path& cachePath, uint64_t sourceHash, const ParsedModel& model);
+
+	private:
+		RHIContext m_Context;
+		TextureImporter m_Importer;
+		TextureImportSettings m_TextureSettings;
+		MeshImportSettings m_MeshSettings;
+
+		Aura::Unique<ThreadPool> m_ThreadPool;
+
+		GLTFLoadStatistics m_Statistics;
+	};
+
+}
@@ -0,0 +1,226 @@
+#include "GPUProfiler.hpp"
+
+#include "Engine/IO/FileIO.hpp"
+
+#include <Aura/Stack.hpp>
+
+namespace Yuki {
+
+	GPUProfiler::GPUProfiler(RHIContext context, uint32_t framesInFlight, uint32_t maxScopesPerFrame)
+		: m_Context(context), m_QueriesPerFrame(maxScopesPerFrame * 2)
+	{
+		m_QueryPool = TimestampQueryPool::Create(context, m_QueriesPerFrame * framesInFlight);
+		m_Frames.resize(framesInFlight);
+		m_Frames[0].IsPending = true;
+	}
+
+	void GPUProfiler::Destroy()
+	{
+		m_QueryPool.Destroy();
+		m_Frames.clear();
+		m_History.clear();
+	}
+
+	void GPUProfiler::NextFrame()
+	{
+		auto& currentFrame = m_Frames[m_FrameIndex % m_Frames.size()];
+		YukiAssert(currentFrame.OpenScopes.empty());
+
+		// Frames are resolved oldest first so the history stays in order
+		for (uint64_t frameIndex = m_FrameIndex + 1 - std::min<uint64_t>(m_FrameIndex + 1, m_Frames.size()); frameIndex <= m_FrameIndex; frameIndex++)
+		{
+			auto& frame = m_Frames[frameIndex % m_Frames.size()];
+
+			if (frame.IsPending && frame.FrameIndex == frameIndex && !ResolveFrame(frame))
+			{
+				break;
+			}
+		}
+
+		m_FrameIndex++;
+
+		uint32_t slot = static_cast<uint32_t>(m_FrameIndex % m_Frames.size());
+		auto& nextFrame = m_Frames[slot];
+
+		// NOTE(Peter): Happens if the lists were never submitted, or the GPU is further behind than the caller promised
+		if (nextFrame.IsPending && nextFrame.QueryCount > 0)
+		{
+			m_DroppedFrameCount++;
+		}
+
+		if (nextFrame.QueryCount > 0)
+		{
+			m_QueryPool.Reset(slot * m_QueriesPerFrame, nextFrame.QueryCount);
+		}
+
+		nextFrame.FrameIndex = m_FrameIndex;
+		nextFrame.Scopes.clear();
+		nextFrame.QueryCount = 0;
+		nextFrame.IsPending = true;
+	}
+
+	void GPUProfiler::BeginScope(CommandList commandList, std::string_view name)
+	{
+		uint32_t slot = static_cast<uint32_t>(m_FrameIndex % m_Frames.size());
+		auto& frame = m_Frames[slot];
+
+		// Running out of queries drops the scope instead of failing, every open scope still needs a query for its end
+		uint32_t query = ~0u;
+		if (frame.QueryCount + frame.OpenScopes.size() + 2 <= m_QueriesPerFrame)
+		{
+			query = frame.QueryCount++;
+			commandList.WriteTimestamp(m_QueryPool, slot * m_QueriesPerFrame + query);
+		}
+
+		frame.OpenScopes.push_back(static_cast<uint32_t>(frame.Scopes.size()));
+		frame.Scopes.push_back({
+			.Name = std::string(name),
+			.Depth = static_cast<uint32_t>(frame.OpenScopes.size() - 1),
+			.BeginQuery = query,
+			.EndQuery = ~0u,
+		});
+	}
+
+	void GPUProfiler::EndScope(CommandList commandList)
+	{
+		uint32_t slot = static_cast<uint32_t>(m_FrameIndex % m_Frames.size());
+		auto& frame = m_Frames[slot];
+
+		YukiAssert(!frame.OpenScopes.empty());
+
+		auto& scope = frame.Scopes[frame.OpenScopes.back()];
+		frame.OpenScopes.pop_back();
+
+		if (scope.BeginQuery == ~0u)
+		{
+			return;
+		}
+
+		scope.EndQuery = frame.QueryCount++;
+		commandList.WriteTimestamp(m_QueryPool, slot * m_QueriesPerFrame + scope.EndQuery);
+	}
+
+	bool GPUProfiler::ResolveFrame(FrameQueries& frame)
+	{
+		if (frame.QueryCount == 0)
+		{
+			frame.IsPending = false;
+			return true;
+		}
+
+		AuraStackPoint();
+
+		uint32_t slot = static_cast<uint32_t>(frame.FrameIndex % m_Frames.size());
+		auto timestamps = Aura::StackAlloc<uint64_t>(frame.QueryCount);
+
+		if (!m_QueryPool.GetResults(slot * m_QueriesPerFrame, { timestamps.Data(), frame.QueryCount }))
+		{
+			return false;
+		}
+
+		// NOTE(Peter): Scopes recorded on lists that were submitted out of order can start before the first one
+		GPUFrameResult result = { .FrameIndex = frame.FrameIndex, .BeginTimestamp = ~0ull };
+
+		for (const auto& scope : frame.Scopes)
+		{
+			if (scope.BeginQuery != ~0u)
+			{
+				result.BeginTimestamp = std::min(result.BeginTimestamp, timestamps[scope.BeginQuery]);
+			}
+		}
+
+		for (const auto& scope : frame.Scopes)
+		{
+			if (scope.BeginQuery == ~0u)
+			{
+				continue;
+			}
+
+			uint64_t begin = timestamps[scope.BeginQuery];
+			uint64_t end = timestamps[scope.EndQuery];
+
+			result.Scopes.push_back({
+				.Name = scope.Name,
+				.Depth = scope.Depth,
+				.StartMs = static_cast<double>(begin - result.BeginTimestamp) / 1'000'000.0,
+				.DurationMs = static_cast<double>(end - begin) / 1'000'000.0,
+			});
+		}
+
+		frame.IsPending = false;
+
+		m_History.push_back(result);
+		while (m_History.size() > m_HistorySize)
+		{
+			m_History.pop_front();
+		}
+
+		m_LatestResults = std::move(result);
+		return true;
+	}
+
+	double GPUProfiler::GetScopeTime(std::string_view name) const
+	{
+		double time = 0.0;
+
+		for (const auto& scope : m_LatestResults.Scopes)
+		{
+			if (scope.Name == name)
+			{
+				time += scope.DurationMs;
+			}
+		}
+
+		return time;
+	}
+
+	bool GPUProfiler::ExportChromeTrace(const std::filesystem::path& filepath) const
+	{
+		if (m_History.empty())
+		{
+			return false;
+		}
+
+		uint64_t firstTimestamp = m_History.front().BeginTimestamp;
+
+		std::string trace = "{\"traceEvents\":[";
+		bool first = true;
+
+		for (const auto& frame : m_History)
+		{
+			double frameStartUs = static_cast<double>(frame.BeginTimestamp - firstTimestamp) / 1000.0;
+
+			for (const auto& scope : frame.Scopes)
+			{
+				std::string name;
+				for (char c : scope.Name)
+				{
+					if (c == '"' || c == '\\')
+					{
+						name += '\\';
+					}
+
+					name += c;
+				}
+
+				trace += std::format("{}\n{{\"name\":\"{}\",\"cat\":\"GPU\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"frame\":{}}}}}",
+					first ? "" : ",", name, frameStartUs + scope.StartMs * 1000.0, scope.DurationMs * 1000.0, frame.FrameIndex);
+				first = false;
+			}
+		}
+
+		trace += "\n]}\n";
+		return FileIO::WriteText(filepath, trace);
+	}
+
+	void GPUProfiler::SetHistorySize(uint32_t frameCount)
+	{
+		m_HistorySize = frameCount;
+
+		while (m_History.size() > m_HistorySize)
+		{
+			m_History.pop_front();
+		}
+	}
+
+}
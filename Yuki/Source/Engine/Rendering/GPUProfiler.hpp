@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Engine/RHI/RHI.hpp"
+
+#include <deque>
+
+namespace Yuki {
+
+	struct GPUScopeResult
+	{
+		std::string Name;
+		uint32_t Depth;
+
+		// Relative to the first scope of the frame
+		double StartMs;
+		double DurationMs;
+	};
+
+	struct GPUFrameResult
+	{
+		uint64_t FrameIndex = 0;
+
+		// Timestamp of the first scope, only meaningful relative to other frames
+		uint64_t BeginTimestamp = 0;
+
+		// In the order the scopes began
+		std::vector<GPUScopeResult> Scopes;
+	};
+
+	// Named, nestable GPU timing scopes backed by timestamp queries. Every frame in flight records into its own range of
+	// queries and results are only read back once the GPU has written all of them, so they trail behind by up to framesInFlight frames.
+	// NOTE(Peter): Scopes may only be recorded from one thread, and have to end on the same command list they began on
+	class GPUProfiler
+	{
+	public:
+		GPUProfiler() = default;
+		GPUProfiler(RHIContext context, uint32_t framesInFlight = 2, uint32_t maxScopesPerFrame = 256);
+
+		void Destroy();
+
+		// Resolves every finished frame and moves on to the queries of the next frame in flight, the caller
+		// has to make sure the GPU has finished the lists recorded the last time those queries were used
+		void NextFrame();
+
+		void BeginScope(CommandList commandList, std::string_view name);
+		void EndScope(CommandList commandList);
+
+		// The newest frame whose results have been read back
+		const GPUFrameResult& GetLatestResults() const { return m_LatestResults; }
+
+		// Summed duration of every scope called name in the newest resolved frame
+		double GetScopeTime(std::string_view name) const;
+
+		// Frames whose queries had to be reused before the GPU had written all of them
+		uint64_t GetDroppedFrameCount() const { return m_DroppedFrameCount; }
+
+		// Writes the resolved frames that are still in the history in the Chrome trace event format (chrome://tracing, Perfetto)
+		bool ExportChromeTrace(const std::filesystem::path& filepath) const;
+		void SetHistorySize(uint32_t frameCount);
+
+	private:
+		struct Scope
+		{
+			std::string Name;
+			uint32_t Depth;
+			uint32_t BeginQuery;
+			uint32_t EndQuery;
+		};
+
+		struct FrameQueries
+		{
+			uint64_t FrameIndex = 0;
+			std::vector<Scope> Scopes;
+			std::vector<uint32_t> OpenScopes;
+			uint32_t QueryCount = 0;
+			bool IsPending = false;
+		};
+
+	private:
+		bool ResolveFrame(FrameQueries& frame);
+
+	private:
+		RHIContext m_Context;
+		TimestampQueryPool m_QueryPool;
+
+		uint32_t m_QueriesPerFrame = 0;
+		uint64_t m_FrameIndex = 0;
+		std::vector<FrameQueries> m_Frames;
+
+		GPUFrameResult m_LatestResults;
+		std::deque<GPUFrameResult> m_History;
+		uint32_t m_HistorySize = 300;
+
+		uint64_t m_DroppedFrameCount = 0;
+	};
+
+	// Profiles the rest of the enclosing block, does nothing without a profiler
+	class GPUProfileScope
+	{
+	public:
+		GPUProfileScope(GPUProfiler* profiler, CommandList commandList, std::string_view name)
+			: m_Profiler(profiler), m_CommandList(commandList)
+		{
+			if (m_Profiler)
+			{
+				m_Profiler->BeginScope(m_CommandList, name);
+			}
+		}
+
+		~GPUProfileScope()
+		{
+			if (m_Profiler)
+			{
+				m_Profiler->EndScope(m_CommandList);
+			}
+		}
+
+		GPUProfileScope(const GPUProfileScope&) = delete;
+		GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+
+	private:
+		GPUProfiler* m_Profiler;
+		CommandList m_CommandList;
+	};
+
+}
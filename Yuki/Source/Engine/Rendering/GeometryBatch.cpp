@@ -0,0 +1,135 @@
+#include "GeometryBatchImpl.hpp"
+
+#include <rtmcpp/VectorOps.hpp>
+
+namespace Yuki {
+
+	void GeometryBatch::Clear() const
+	{
+		m_Impl->Vertices.clear();
+		m_Impl->Indices.clear();
+		m_Impl->BaseIndex = 0;
+		m_Impl->QuadDepths.clear();
+
+		m_Impl->ReleaseResources();
+
+		m_Impl->Images.clear();
+	}
+
+	void GeometryBatch::AddQuad(rtmcpp::Vec2 position, rtmcpp::Vec4 color, float32_t depth) const
+	{
+		// Add new vertices
+		{
+			m_Impl->Vertices.push_back({
+				.Position = {  position.X - QuadHalfSize, position.Y + QuadHalfSize },
+				.Depth = depth,
+				.Color = rtmcpp::PackUnorm4x8<float>(color)
+			});
+
+			m_Impl->Vertices.push_back({
+				.Position = {  position.X + QuadHalfSize, position.Y + QuadHalfSize },
+				.Depth = depth,
+				.Color = rtmcpp::PackUnorm4x8<float>(color)
+			});
+
+			m_Impl->Vertices.push_back({
+				.Position = {  position.X + QuadHalfSize, position.Y - QuadHalfSize },
+				.Depth = depth,
+				.Color = rtmcpp::PackUnorm4x8<float>(color)
+			});
+
+			m_Impl->Vertices.push_back({
+				.Position = {  position.X - QuadHalfSize, position.Y - QuadHalfSize },
+				.Depth = depth,
+				.Color = rtmcpp::PackUnorm4x8<float>(color)
+			});
+		}
+
+		// Add new indices
+		{
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 0);
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 1);
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 2);
+		
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 2);
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 3);
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 0);
+
+			m_Impl->BaseIndex += 4;
+		}
+
+		m_Impl->QuadDepths.push_back(depth);
+	}
+
+	void GeometryBatch::AddTexturedQuad(rtmcpp::Vec2 position, Image image, float32_t depth) const
+	{
+		uint32_t imageIndex = ~0u;
+
+		for (uint32_t i = 0; i < m_Impl->Images.size(); i++)
+		{
+			if (m_Impl->Images[i] == image)
+			{
+				imageIndex = i;
+				break;
+			}
+		}
+
+		if (imageIndex == ~0u)
+		{
+			imageIndex = static_cast<uint32_t>(m_Impl->Images.size());
+			m_Impl->Images.push_back(image);
+		}
+
+		// Add new vertices
+		{
+			m_Impl->Vertices.push_back({
+				.Position = {  position.X - QuadHalfSize, position.Y + QuadHalfSize },
+				.Depth = depth,
+				.UV = { 0.0f, 1.0f },
+				.Texture = imageIndex
+			});
+
+			m_Impl->Vertices.push_back({ 
+				.Position = {  position.X + QuadHalfSize, position.Y + QuadHalfSize },
+				.Depth = depth,
+				.UV = { 1.0f, 1.0f },
+				.Texture = imageIndex
+			});
+
+			m_Impl->Vertices.push_back({ 
+				.Position = {  position.X + QuadHalfSize, position.Y - QuadHalfSize },
+				.Depth = depth,
+				.UV = { 1.0f, 0.0f },
+				.Texture = imageIndex
+			});
+
+			m_Impl->Vertices.push_back({ 
+				.Position = {  position.X - QuadHalfSize, position.Y - QuadHalfSize },
+				.Depth = depth,
+				.UV = { 0.0f, 0.0f },
+				.Texture = imageIndex
+			});
+		}
+
+		// Add new indices
+		{
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 0);
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 1);
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 2);
+
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 2);
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 3);
+			m_Impl->Indices.push_back(m_Impl->BaseIndex + 0);
+
+			m_Impl->BaseIndex += 4;
+		}
+
+		m_Impl->QuadDepths.push_back(depth);
+	}
+
+	void GeometryBatch::MarkDirty() const
+	{
+		m_Impl->IsDirty = true;
+	}
+
+}
@@ -10,8 +10,9 @@ namespace Yuki {
 	struct GeometryBatch : Handle<GeometryBatch>
 	{
 		void Clear() const;
-		void AddQuad(rtmcpp::Vec2 position, rtmcpp::Vec4 color) const;
-		void AddTexturedQuad(rtmcpp::Vec2 position, Image image) const;
+		// Depth is in the [0, 1] range, with 0 being closest to the camera
+		void AddQuad(rtmcpp::Vec2 position, rtmcpp::Vec4 color, float32_t depth = 0.0f) const;
+		void AddTexturedQuad(rtmcpp::Vec2 position, Image image, float32_t depth = 0.0f) const;
 		void MarkDirty() const;
 	};
 
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "GeometryBatch.hpp"
+#include "GeometryBufferPool.hpp"
+#include "BatchRenderer.hpp"
+#include "VertexPacking.hpp"
+
+#include <rtmcpp/PackedVector.hpp>
+
+#include <numeric>
+
+namespace Yuki {
+
+	struct BatchedVertex
+	{
+		rtmcpp::PackedVec2 Position;
+		// NOTE(Peter): [0, 1], 0 being closest to the camera
+		float32_t Depth;
+		rtmcpp::PackedVec2 UV;
+		uint32_t Color;
+		uint32_t Texture = ~0u;
+	};
+
+	// GPU-side layout used by BatchVertexFormat::CompactHalf and BatchVertexFormat::CompactFixed
+	struct CompactBatchedVertex
+	{
+		// 2x half-float or 2x signed 12.4 fixed-point, depending on the format
+		uint32_t Position;
+		// Unorm16
+		uint16_t Depth;
+		// 0xFFFF means untextured
+		uint16_t Texture;
+		// 2x Unorm16
+		uint32_t UV;
+		uint32_t Color;
+	};
+	static_assert(sizeof(CompactBatchedVertex) == 16);
+
+	inline constexpr float32_t QuadHalfSize = 8.0f;
+	inline constexpr uint32_t IndicesPerQuad = 6;
+
+	inline constexpr uint16_t CompactNoTexture = 0xFFFF;
+
+	inline uint32_t GetVertexStride(BatchVertexFormat format)
+	{
+		return format == BatchVertexFormat::Full ? sizeof(BatchedVertex) : sizeof(CompactBatchedVertex);
+	}
+
+	template<>
+	struct Handle<GeometryBatch>::Impl
+	{
+		RHIContext Context;
+
+		std::vector<BatchedVertex> Vertices;
+		std::vector<uint32_t> Indices;
+		uint32_t BaseIndex = 0;
+
+		// One entry per quad, in the same order as the quads appear in Indices
+		std::vector<float32_t> QuadDepths;
+
+		// Null for batches that are never uploaded to the GPU
+		GeometryBufferPool* BufferPool = nullptr;
+
+		BufferAllocation VertexBuffer;
+		BufferAllocation IndexBuffer;
+
+		// The layout of the data currently in VertexBuffer / IndexBuffer
+		BatchVertexFormat UploadedVertexFormat = BatchVertexFormat::Full;
+		IndexType UploadedIndexType = IndexType::UInt32;
+
+		std::vector<Image> Images;
+
+		bool IsDirty = false;
+
+		// Always switches to different ranges, frames in flight may still be drawing from the current ones
+		void CreateResources(uint32_t vertexDataSize, uint32_t indexDataSize)
+		{
+			ReleaseResources();
+			VertexBuffer = BufferPool->Acquire(GeometryBufferType::Vertices, vertexDataSize);
+			IndexBuffer = BufferPool->Acquire(GeometryBufferType::Indices, indexDataSize);
+		}
+
+		void ReleaseResources()
+		{
+			if (VertexBuffer.IsValid())
+			{
+				BufferPool->Release(GeometryBufferType::Vertices, VertexBuffer);
+				VertexBuffer = {};
+			}
+
+			if (IndexBuffer.IsValid())
+			{
+				BufferPool->Release(GeometryBufferType::Indices, IndexBuffer);
+				IndexBuffer = {};
+			}
+		}
+
+		// Every index is guaranteed to be smaller than BaseIndex
+		IndexType GetRequiredIndexType() const
+		{
+			return BaseIndex <= std::numeric_limits<uint16_t>::max() + 1u ? IndexType::UInt16 : IndexType::UInt32;
+		}
+
+		uint32_t GetVertexDataSize(BatchVertexFormat format) const
+		{
+			return static_cast<uint32_t>(Vertices.size()) * GetVertexStride(format);
+		}
+
+		uint32_t GetIndexDataSize() const
+		{
+			uint32_t indexSize = GetRequiredIndexType() == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+			return static_cast<uint32_t>(Indices.size()) * indexSize;
+		}
+
+		void WriteVertices(Buffer stagingBuffer, uint32_t offset, BatchVertexFormat format)
+		{
+			UploadedVertexFormat = format;
+
+			if (format == BatchVertexFormat::Full)
+			{
+				stagingBuffer.Set(Aura::Span{ Vertices.data(), static_cast<uint32_t>(Vertices.size()) }, offset);
+				return;
+			}
+
+			std::vector<CompactBatchedVertex> compactVertices(Vertices.size());
+
+			for (size_t i = 0; i < Vertices.size(); i++)
+			{
+				const auto& vertex = Vertices[i];
+				auto& compactVertex = compactVertices[i];
+
+				if (format == BatchVertexFormat::CompactHalf)
+				{
+					compactVertex.Position = Pack2x16(FloatToHalf(vertex.Position.X), FloatToHalf(vertex.Position.Y));
+				}
+				else
+				{
+					compactVertex.Position = Pack2x16(FloatToFixed12x4(vertex.Position.X), FloatToFixed12x4(vertex.Position.Y));
+				}
+
+				YukiAssert(vertex.Texture == ~0u || vertex.Texture < CompactNoTexture);
+
+				compactVertex.Depth = FloatToUnorm16(vertex.Depth);
+				compactVertex.Texture = vertex.Texture == ~0u ? CompactNoTexture : static_cast<uint16_t>(vertex.Texture);
+				compactVertex.UV = Pack2x16(FloatToUnorm16(vertex.UV.X), FloatToUnorm16(vertex.UV.Y));
+				compactVertex.Color = vertex.Color;
+			}
+
+			stagingBuffer.Set(Aura::Span{ compactVertices.data(), static_cast<uint32_t>(compactVertices.size()) }, offset);
+		}
+
+		void WriteIndices(Buffer stagingBuffer, uint32_t offset)
+		{
+			UploadedIndexType = GetRequiredIndexType();
+
+			if (UploadedIndexType == IndexType::UInt32)
+			{
+				stagingBuffer.Set(Aura::Span{ Indices.data(), static_cast<uint32_t>(Indices.size()) }, offset);
+				return;
+			}
+
+			std::vector<uint16_t> shortIndices(Indices.begin(), Indices.end());
+			stagingBuffer.Set(Aura::Span{ shortIndices.data(), static_cast<uint32_t>(shortIndices.size()) }, offset);
+		}
+
+		// Reorders the quads (not the vertices) so that they're drawn front-to-back, letting
+		// early depth testing reject fragments hidden behind quads that have already been drawn.
+		// All batched geometry is opaque (the pipeline doesn't enable blending) so this is always safe.
+		void SortQuadsFrontToBack()
+		{
+			if (std::ranges::is_sorted(QuadDepths))
+			{
+				return;
+			}
+
+			std::vector<uint32_t> quadOrder(QuadDepths.size());
+			std::iota(quadOrder.begin(), quadOrder.end(), 0u);
+			std::ranges::stable_sort(quadOrder, {}, [this](uint32_t quad) { return QuadDepths[quad]; });
+
+			std::vector<uint32_t> sortedIndices;
+			sortedIndices.reserve(Indices.size());
+
+			std::vector<float32_t> sortedDepths;
+			sortedDepths.reserve(QuadDepths.size());
+
+			for (uint32_t quad : quadOrder)
+			{
+				auto quadIndices = std::span{ Indices }.subspan(quad * IndicesPerQuad, IndicesPerQuad);
+				sortedIndices.insert(sortedIndices.end(), quadIndices.begin(), quadIndices.end());
+				sortedDepths.push_back(QuadDepths[quad]);
+			}
+
+			Indices = std::move(sortedIndices);
+			QuadDepths = std::move(sortedDepths);
+		}
+
+		float32_t GetNearestDepth() const
+		{
+			return QuadDepths.empty() ? 1.0f : QuadDepths.front();
+		}
+	};
+
+}
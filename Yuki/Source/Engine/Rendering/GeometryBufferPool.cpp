@@ -0,0 +1,103 @@
+#include "GeometryBufferPool.hpp"
+
+namespace Yuki {
+
+	GeometryBufferPool::GeometryBufferPool(RHIContext context)
+	{
+		m_Pools[std::to_underlying(GeometryBufferType::Vertices)] = BufferPool(context, {
+			.Usage = BufferUsage::StorageBuffer | BufferUsage::TransferDst | BufferUsage::Movable,
+			.Category = MemoryCategory::BatchGeometry,
+			.Mode = BufferPoolMode::TLSF,
+			.BlockSize = BlockSize,
+		});
+
+		m_Pools[std::to_underlying(GeometryBufferType::Indices)] = BufferPool(context, {
+			.Usage = BufferUsage::IndexBuffer | BufferUsage::TransferDst | BufferUsage::Movable,
+			.Category = MemoryCategory::BatchGeometry,
+			.Mode = BufferPoolMode::TLSF,
+			.BlockSize = BlockSize,
+		});
+	}
+
+	void GeometryBufferPool::Destroy()
+	{
+		for (auto& pool : m_Pools)
+		{
+			pool.Destroy();
+		}
+
+		m_ReleasedAllocations.clear();
+		m_RetiredAllocations.clear();
+	}
+
+	BufferAllocation GeometryBufferPool::Acquire(GeometryBufferType type, uint32_t size)
+	{
+		// Empty batches still get a range so they don't have to be special cased
+		return m_Pools[std::to_underlying(type)].Allocate(std::max(size, 1u));
+	}
+
+	void GeometryBufferPool::Release(GeometryBufferType type, const BufferAllocation& allocation)
+	{
+		m_ReleasedAllocations.push_back({ type, allocation });
+	}
+
+	void GeometryBufferPool::NextFrame(Fence fence)
+	{
+		if (fence)
+		{
+			m_RetireFence = fence;
+		}
+
+		if (!m_RetiredAllocations.empty())
+		{
+			uint64_t completedValue = m_RetireFence.GetCurrentValue();
+
+			std::erase_if(m_RetiredAllocations, [&](const RetiredAllocation& retired)
+			{
+				if (retired.FenceValue > completedValue)
+				{
+					return false;
+				}
+
+				m_Pools[std::to_underlying(retired.Type)].Free(retired.Allocation);
+				return true;
+			});
+		}
+
+		// The frames that may still be using the released ranges have all been submitted by now
+		for (const auto& released : m_ReleasedAllocations)
+		{
+			if (fence)
+			{
+				m_RetiredAllocations.push_back({ released.Type, released.Allocation, fence.GetValue() });
+			}
+			else
+			{
+				m_Pools[std::to_underlying(released.Type)].Free(released.Allocation);
+			}
+		}
+
+		m_ReleasedAllocations.clear();
+	}
+
+	uint32_t GeometryBufferPool::GetBlockCount() const
+	{
+		uint32_t blockCount = 0;
+		for (const auto& pool : m_Pools)
+		{
+			blockCount += pool.GetBlockCount();
+		}
+		return blockCount;
+	}
+
+	uint64_t GeometryBufferPool::GetAllocatedBytes() const
+	{
+		uint64_t allocatedBytes = 0;
+		for (const auto& pool : m_Pools)
+		{
+			allocatedBytes += pool.GetAllocatedBytes();
+		}
+		return allocatedBytes;
+	}
+
+}
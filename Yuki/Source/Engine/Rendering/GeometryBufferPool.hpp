@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Engine/RHI/BufferPool.hpp"
+
+#include <array>
+
+namespace Yuki {
+
+	enum class GeometryBufferType
+	{
+		// Pulled through the buffer address in the vertex shader
+		Vertices,
+		Indices,
+	};
+
+	// Hands out the vertex and index ranges of geometry batches from two TLSF BufferPools, so batches that are re-uploaded every
+	// frame share a few large buffers instead of creating and destroying their own. Released ranges are only freed once the
+	// GPU has finished every frame that could've used them.
+	class GeometryBufferPool
+	{
+	public:
+		GeometryBufferPool() = default;
+		explicit GeometryBufferPool(RHIContext context);
+
+		// The GPU has to be done with every range, including the ones that are still acquired
+		void Destroy();
+
+		// The range is at least size bytes large
+		BufferAllocation Acquire(GeometryBufferType type, uint32_t size);
+		void Release(GeometryBufferType type, const BufferAllocation& allocation);
+
+		// Called once per frame before any ranges are acquired. Ranges released since the last call are freed once fence
+		// has reached the value it was last signalled with, without a fence they're freed right away.
+		// NOTE(Peter): Every call that passes a fence has to pass the same one
+		void NextFrame(Fence fence = {});
+
+		uint32_t GetBlockCount() const;
+		uint64_t GetAllocatedBytes() const;
+
+	private:
+		static constexpr uint32_t BlockSize = 4 * 1024 * 1024;
+
+		struct ReleasedAllocation
+		{
+			GeometryBufferType Type;
+			BufferAllocation Allocation;
+		};
+
+		struct RetiredAllocation
+		{
+			GeometryBufferType Type;
+			BufferAllocation Allocation;
+			uint64_t FenceValue;
+		};
+
+	private:
+		// NOTE(Peter): Vertices and indices never share a block, a render graph pass can then read every
+		//              imported block with a single access
+		std::array<BufferPool, 2> m_Pools;
+
+		std::vector<ReleasedAllocation> m_ReleasedAllocations;
+		std::vector<RetiredAllocation> m_RetiredAllocations;
+		Fence m_RetireFence;
+	};
+
+}
@@ -1,44 +1,164 @@
 #include "ImageProcessor.hpp"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
 namespace Yuki {
 
-	Image ImageProcessor::CreateFromFile(RHIContext context, const std::filesystem::path& filepath) const
+	static Image CreateTexture(RHIContext context, ImageFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, ImageUsage usage = ImageUsage::TransferDst)
+	{
+		return Image::Create(context, {
+			.Width = width,
+			.Height = height,
+			.Format = format,
+			.Usage = ImageUsage::Sampled | usage,
+			.MipLevels = mipLevels,
+			.CreateDefaultView = true,
+			.Category = MemoryCategory::Textures
+		});
+	}
+
+	static Image CreateTexture(RHIContext context, const TextureData& texture, ImageUsage usage = ImageUsage::TransferDst)
+	{
+		return CreateTexture(context, texture.Format, texture.Width, texture.Height, static_cast<uint32_t>(texture.Mips.size()), usage);
+	}
+
+	static Image WriteTextureFromHost(RHIContext context, const TextureData& texture)
 	{
-		if (!std::filesystem::exists(filepath))
+		auto image = CreateTexture(context, texture, ImageUsage::HostTransfer);
+
+		for (uint32_t mip = 0; mip < texture.Mips.size(); mip++)
 		{
-			WriteLine("Can't load image {}, failed to find the file.", filepath.string());
-			return {};
+			const auto& mipInfo = texture.Mips[mip];
+			image.WriteFromHost(texture.GetPixels() + mipInfo.Offset, mipInfo.Size, mip);
 		}
 
-		auto filepathStr = filepath.string();
+		return image;
+	}
 
-		int32_t width, height;
-		stbi_uc* data = stbi_load(filepathStr.c_str(), &width, &height, nullptr, STBI_rgb_alpha);
+	// The staging buffer holds every mip level of the texture starting at offset
+	static void RecordTextureUpload(CommandList cmd, Image image, Buffer staging, uint32_t offset, const TextureData& texture)
+	{
+		cmd.TransitionImage(image, ImageLayout::TransferDst);
+
+		for (uint32_t mip = 0; mip < texture.Mips.size(); mip++)
+		{
+			const auto& mipInfo = texture.Mips[mip];
+			cmd.CopyBufferToImage(image, staging, static_cast<uint32_t>(mipInfo.Size), offset + static_cast<uint32_t>(mipInfo.Offset), mip);
+		}
 
-		YukiAssert(width > 0 && height > 0);
+		cmd.TransitionImage(image, ImageLayout::ShaderReadOnlyOptimal);
+	}
+
+	static TextureImportSettings ResolveImportSettings(RHIContext context, TextureImportSettings settings)
+	{
+		if (IsBlockCompressed(settings.Format) && !context.IsImageFormatSupported(settings.Format))
+		{
+			settings.Format = ImageFormat::RGBA8Unorm;
+		}
 
-		auto image = Image::Create(context, {
-			.Width = static_cast<uint32_t>(width),
-			.Height = static_cast<uint32_t>(height),
-			.Format = ImageFormat::RGBA8Unorm,
-			.Usage = ImageUsage::Sampled | ImageUsage::TransferDst,
-			.CreateDefaultView = true
+		return settings;
+	}
+
+	ImageProcessor::ImageProcessor(RHIContext context, uint64_t maxUploadBytesPerFrame, std::filesystem::path cacheDirectory)
+		: m_Context(context), m_MaxUploadBytesPerFrame(maxUploadBytesPerFrame), m_Importer(std::move(cacheDirectory))
+	{
+		m_TransferQueue = context.RequestQueue(QueueType::Transfer);
+		m_UploadFence = Fence::Create(context);
+
+		m_StagingPool = BufferPool(context, {
+			.Usage = BufferUsage::TransferSrc | BufferUsage::Mapped,
+			.Category = MemoryCategory::Staging,
+			.Mode = BufferPoolMode::TLSF,
 		});
 
+		m_ThreadPool = Aura::Unique<ThreadPool>::New();
+
+		uint32_t grey = 0xFF808080;
+
+		if (context.IsHostImageCopySupported(ImageFormat::RGBA8Unorm))
+		{
+			m_Placeholder = WriteTextureFromHost(context, TextureImporter::Build(reinterpret_cast<std::byte*>(&grey), 1, 1, {}));
+			return;
+		}
+
+		// NOTE(Peter): The only upload we ever wait for, it's a single pixel and happens before anything could sample it
+		m_Placeholder = CreateTexture(context, ImageFormat::RGBA8Unorm, 1, 1, 1);
+
+		auto staging = m_StagingPool.Allocate(sizeof(grey));
+		staging.Resource.SetData(reinterpret_cast<std::byte*>(&grey), staging.Offset, sizeof(grey));
+
+		auto pool = CommandPool::Create(context, m_TransferQueue);
+		auto cmd = pool.NewList();
+		cmd.TransitionImage(m_Placeholder, ImageLayout::TransferDst);
+		cmd.CopyBufferToImage(m_Placeholder, staging.Resource, sizeof(grey), staging.Offset);
+		cmd.TransitionImage(m_Placeholder, ImageLayout::ShaderReadOnlyOptimal);
+		cmd.End();
+
+		m_TransferQueue.SubmitCommandLists({ cmd }, {}, { m_UploadFence });
+		m_UploadFence.Wait();
+
+		m_StagingPool.Free(staging);
+		m_FreeCommandPools.push_back(pool);
+	}
+
+	void ImageProcessor::Destroy()
+	{
+		if (m_ThreadPool)
+		{
+			m_ThreadPool->WaitIdle();
+		}
+
+		m_UploadFence.Wait();
+		FinishUploads(m_UploadFence.GetValue());
+
+		for (auto& decoded : m_DecodedImages)
+		{
+			if (decoded.Resource)
+			{
+				decoded.Resource.Destroy();
+			}
+
+			FailLoad(decoded.State, decoded.OnLoaded);
+		}
+
+		m_DecodedImages.clear();
+
+		for (auto pool : m_FreeCommandPools)
+		{
+			pool.Destroy();
+		}
+
+		m_FreeCommandPools.clear();
+
+		m_Placeholder.Destroy();
+		m_StagingPool.Destroy();
+		m_UploadFence.Destroy();
+	}
+
+	Image ImageProcessor::CreateFromFile(RHIContext context, const std::filesystem::path& filepath, const TextureImportSettings& settings) const
+	{
+		auto texture = m_Importer.Import(filepath, ResolveImportSettings(context, settings), m_ThreadPool ? &*m_ThreadPool : nullptr);
+
+		if (!texture.IsValid())
+		{
+			return {};
+		}
+
+		if (CanWriteFromHost(context, texture))
+		{
+			return WriteTextureFromHost(context, texture);
+		}
+
+		auto image = CreateTexture(context, texture);
+
 		auto uploadFence = Fence::Create(context);
 
-		auto stagingBuffer = Buffer::Create(context, width * height * 4, BufferUsage::TransferSrc | BufferUsage::Mapped);
-		stagingBuffer.SetData(reinterpret_cast<std::byte*>(data), 0, width * height * 4);
+		auto stagingBuffer = Buffer::Create(context, texture.GetPixelsSize(), BufferUsage::TransferSrc | BufferUsage::Mapped, MemoryCategory::Staging);
+		stagingBuffer.SetData(texture.GetPixels(), 0, texture.GetPixelsSize());
 
 		auto queue = context.RequestQueue(QueueType::Transfer);
 		auto pool = CommandPool::Create(context, queue);
 		auto cmd = pool.NewList();
-		cmd.TransitionImage(image, ImageLayout::TransferDst);
-		cmd.CopyBufferToImage(image, stagingBuffer, width * height * 4);
-		cmd.TransitionImage(image, ImageLayout::ShaderReadOnlyOptimal);
+		RecordTextureUpload(cmd, image, stagingBuffer, 0, texture);
+		cmd.End();
 
 		queue.SubmitCommandLists({ cmd }, {}, { uploadFence });
 
@@ -48,9 +168,265 @@ namespace Yuki {
 		stagingBuffer.Destroy();
 		uploadFence.Destroy();
 
-		stbi_image_free(data);
-
 		return image;
 	}
 
+	std::vector<Image> ImageProcessor::CreateFromFiles(RHIContext context, Aura::Span<std::filesystem::path> filepaths, const TextureImportSettings& settings) const
+	{
+		auto resolvedSettings = ResolveImportSettings(context, settings);
+
+		std::vector<TextureData> textures;
+
+		if (m_ThreadPool)
+		{
+			textures = m_Importer.ImportBatch(filepaths, resolvedSettings, *m_ThreadPool);
+		}
+		else
+		{
+			for (const auto& filepath : filepaths)
+			{
+				textures.push_back(m_Importer.Import(filepath, resolvedSettings));
+			}
+		}
+
+		return CreateFromTextures(context, { textures.data(), static_cast<uint32_t>(textures.size()) });
+	}
+
+	std::vector<Image> ImageProcessor::CreateFromTextures(RHIContext context, Aura::Span<TextureData> textures)
+	{
+		std::vector<Image> images(textures.Count());
+		uint64_t stagingSize = 0;
+
+		for (uint32_t i = 0; i < textures.Count(); i++)
+		{
+			if (!textures[i].IsValid())
+			{
+				continue;
+			}
+
+			if (CanWriteFromHost(context, textures[i]))
+			{
+				images[i] = WriteTextureFromHost(context, textures[i]);
+				continue;
+			}
+
+			stagingSize += textures[i].GetPixelsSize();
+		}
+
+		if (stagingSize == 0)
+		{
+			return images;
+		}
+
+		auto uploadFence = Fence::Create(context);
+		auto stagingBuffer = Buffer::Create(context, stagingSize, BufferUsage::TransferSrc | BufferUsage::Mapped, MemoryCategory::Staging);
+
+		auto queue = context.RequestQueue(QueueType::Transfer);
+		auto pool = CommandPool::Create(context, queue);
+		auto cmd = pool.NewList();
+
+		uint32_t offset = 0;
+
+		for (uint32_t i = 0; i < textures.Count(); i++)
+		{
+			const auto& texture = textures[i];
+
+			if (!texture.IsValid() || images[i])
+			{
+				continue;
+			}
+
+			images[i] = CreateTexture(context, texture);
+			stagingBuffer.SetData(texture.GetPixels(), offset, texture.GetPixelsSize());
+			RecordTextureUpload(cmd, images[i], stagingBuffer, offset, texture);
+			offset += static_cast<uint32_t>(texture.GetPixelsSize());
+		}
+
+		cmd.End();
+
+		queue.SubmitCommandLists({ cmd }, {}, { uploadFence });
+
+		uploadFence.Wait();
+
+		pool.Destroy();
+		stagingBuffer.Destroy();
+		uploadFence.Destroy();
+
+		return images;
+	}
+
+	StreamedImage ImageProcessor::LoadAsync(const std::filesystem::path& filepath, const TextureImportSettings& settings, LoadCallback onLoaded)
+	{
+		YukiAssert(m_ThreadPool);
+
+		StreamedImage result;
+		result.m_State = std::make_shared<StreamedImage::State>();
+		result.m_State->FilePath = filepath;
+		result.m_State->Placeholder = m_Placeholder;
+
+		m_PendingLoadCount++;
+
+		m_ThreadPool->Submit([this, state = result.m_State, settings = ResolveImportSettings(m_Context, settings), onLoaded = std::move(onLoaded)]() mutable
+		{
+			DecodedImage decoded = { .State = std::move(state), .OnLoaded = std::move(onLoaded) };
+			decoded.Texture = m_Importer.Import(decoded.State->FilePath, settings, &*m_ThreadPool);
+
+			if (CanWriteFromHost(m_Context, decoded.Texture))
+			{
+				decoded.Resource = WriteTextureFromHost(m_Context, decoded.Texture);
+				decoded.Texture = {};
+			}
+
+			std::scoped_lock lock(m_DecodedMutex);
+			m_DecodedImages.push_back(std::move(decoded));
+		});
+
+		return result;
+	}
+
+	void ImageProcessor::Update()
+	{
+		FinishUploads(m_UploadFence.GetCurrentValue());
+
+		std::vector<DecodedImage> decodedImages;
+
+		{
+			std::scoped_lock lock(m_DecodedMutex);
+
+			// Always takes at least one image, even if it's larger than the budget on its own. Images that
+			// were written from the host don't have any pixels left, so they never count towards the budget
+			uint64_t uploadBytes = 0;
+			while (!m_DecodedImages.empty() && (decodedImages.empty() || uploadBytes < m_MaxUploadBytesPerFrame))
+			{
+				uploadBytes += m_DecodedImages.front().Texture.GetPixelsSize();
+				decodedImages.push_back(std::move(m_DecodedImages.front()));
+				m_DecodedImages.pop_front();
+			}
+		}
+
+		// Already written, no need for a command list
+		std::erase_if(decodedImages, [&](const DecodedImage& decoded)
+		{
+			if (!decoded.Resource)
+			{
+				return false;
+			}
+
+			FinishLoad(decoded.State, decoded.OnLoaded, decoded.Resource);
+			return true;
+		});
+
+		if (decodedImages.empty())
+		{
+			return;
+		}
+
+		UploadBatch batch;
+
+		if (m_FreeCommandPools.empty())
+		{
+			batch.Pool = CommandPool::Create(m_Context, m_TransferQueue);
+		}
+		else
+		{
+			batch.Pool = m_FreeCommandPools.back();
+			m_FreeCommandPools.pop_back();
+		}
+
+		batch.Pool.Reset();
+		auto cmd = batch.Pool.NewList();
+
+		for (auto& decoded : decodedImages)
+		{
+			const auto& texture = decoded.Texture;
+
+			if (!texture.IsValid())
+			{
+				FailLoad(decoded.State, decoded.OnLoaded);
+				continue;
+			}
+
+			uint32_t size = static_cast<uint32_t>(texture.GetPixelsSize());
+
+			PendingUpload upload =
+			{
+				.State = std::move(decoded.State),
+				.OnLoaded = std::move(decoded.OnLoaded),
+				.Resource = CreateTexture(m_Context, texture),
+				.Staging = m_StagingPool.Allocate(size),
+			};
+
+			upload.Staging.Resource.SetData(texture.GetPixels(), upload.Staging.Offset, size);
+			RecordTextureUpload(cmd, upload.Resource, upload.Staging.Resource, upload.Staging.Offset, texture);
+
+			batch.Uploads.push_back(std::move(upload));
+		}
+
+		cmd.End();
+
+		if (batch.Uploads.empty())
+		{
+			m_FreeCommandPools.push_back(batch.Pool);
+			return;
+		}
+
+		m_TransferQueue.SubmitCommandLists({ cmd }, {}, { m_UploadFence });
+		batch.FenceValue = m_UploadFence.GetValue();
+		m_UploadBatches.push_back(std::move(batch));
+	}
+
+	void ImageProcessor::FinishUploads(uint64_t completedValue)
+	{
+		// Batches complete in submission order
+		auto firstPending = std::ranges::find_if(m_UploadBatches, [&](const UploadBatch& batch) { return batch.FenceValue > completedValue; });
+
+		std::vector<UploadBatch> finishedBatches(std::make_move_iterator(m_UploadBatches.begin()), std::make_move_iterator(firstPending));
+		m_UploadBatches.erase(m_UploadBatches.begin(), firstPending);
+
+		// NOTE(Peter): Callbacks are allowed to start new loads, so they're only called once the batches are out of the list
+		for (auto& batch : finishedBatches)
+		{
+			for (auto& upload : batch.Uploads)
+			{
+				m_StagingPool.Free(upload.Staging);
+				FinishLoad(upload.State, upload.OnLoaded, upload.Resource);
+			}
+
+			m_FreeCommandPools.push_back(batch.Pool);
+		}
+	}
+
+	bool ImageProcessor::CanWriteFromHost(RHIContext context, const TextureData& texture)
+	{
+		// NOTE(Peter): Block compressed formats often can't be copied from the host, those go through a staging buffer
+		return texture.IsValid() && texture.GetPixelsSize() <= MaxHostCopyBytes && context.IsHostImageCopySupported(texture.Format);
+	}
+
+	void ImageProcessor::FinishLoad(const std::shared_ptr<StreamedImage::State>& state, const LoadCallback& onLoaded, Image image)
+	{
+		state->Loaded = image;
+		state->IsReady = true;
+		m_PendingLoadCount--;
+
+		if (onLoaded)
+		{
+			StreamedImage streamedImage;
+			streamedImage.m_State = state;
+			onLoaded(streamedImage);
+		}
+	}
+
+	void ImageProcessor::FailLoad(const std::shared_ptr<StreamedImage::State>& state, const LoadCallback& onLoaded)
+	{
+		state->HasFailed = true;
+		m_PendingLoadCount--;
+
+		if (onLoaded)
+		{
+			StreamedImage image;
+			image.m_State = state;
+			onLoaded(image);
+		}
+	}
+
 }
@@ -1,15 +1,144 @@
 #pragma once
 
 #include "Engine/RHI/RHI.hpp"
+#include "Engine/RHI/BufferPool.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+#include "Engine/Rendering/TextureImporter.hpp"
+
+#include <Aura/Unique.hpp>
 
 #include <filesystem>
+#include <memory>
 
 namespace Yuki {
 
+	// Returned by ImageProcessor::LoadAsync, stands in for the image until it has been uploaded.
+	// NOTE(Peter): Only ImageProcessor::Update changes the state, so it should only be queried from the thread calling Update
+	class StreamedImage
+	{
+	public:
+		// The placeholder until the image is ready, and forever if loading it failed
+		Image GetImage() const { return m_State->IsReady ? m_State->Loaded : m_State->Placeholder; }
+
+		bool IsReady() const { return m_State->IsReady; }
+		bool HasFailed() const { return m_State->HasFailed; }
+
+	private:
+		struct State
+		{
+			std::filesystem::path FilePath;
+			Image Placeholder;
+			Image Loaded;
+			bool IsReady = false;
+			bool HasFailed = false;
+		};
+
+		std::shared_ptr<State> m_State;
+
+		friend class ImageProcessor;
+	};
+
 	class ImageProcessor
 	{
 	public:
-		Image CreateFromFile(RHIContext context, const std::filesystem::path& filepath) const;
+		// Called from Update once the image is ready or has failed to load
+		using LoadCallback = std::function<void(const StreamedImage&)>;
+
+		// Only CreateFromFile can be used without a context
+		ImageProcessor() = default;
+
+		// Decodes on its own worker threads and uploads at most maxUploadBytesPerFrame of decoded images every Update.
+		// Small textures are written straight from the worker threads if the device supports host image copies.
+		// Imported textures are cached in cacheDirectory, nothing is cached if it's empty.
+		explicit ImageProcessor(RHIContext context, uint64_t maxUploadBytesPerFrame = 32 * 1024 * 1024, std::filesystem::path cacheDirectory = {});
+
+		// Waits for the decodes and uploads in flight, images that haven't been uploaded yet fail to load
+		void Destroy();
+
+		// NOTE(Peter): Block compressed formats fall back to RGBA8Unorm on devices that can't sample them
+
+		// Blocks until the image has been uploaded
+		Image CreateFromFile(RHIContext context, const std::filesystem::path& filepath, const TextureImportSettings& settings = {}) const;
+
+		// Blocks until every image has been uploaded, the files are decoded concurrently on the worker threads and uploaded in a
+		// single submit. Images that failed to load are invalid. Decodes one file at a time if the processor has no context.
+		std::vector<Image> CreateFromFiles(RHIContext context, Aura::Span<std::filesystem::path> filepaths, const TextureImportSettings& settings = {}) const;
+
+		// Uploads textures that have already been imported in a single submit and blocks until they're done, invalid textures
+		// result in invalid images. The textures have to be in a format the device supports.
+		static std::vector<Image> CreateFromTextures(RHIContext context, Aura::Span<TextureData> textures);
+
+		// Mips are generated and compressed on the worker threads as well, large images are split up across all of them
+		StreamedImage LoadAsync(const std::filesystem::path& filepath, const TextureImportSettings& settings = {}, LoadCallback onLoaded = {});
+
+		// Called once per frame. Finishes the uploads the GPU is done with, calling their callbacks, and submits the uploads
+		// of the images decoded since the last call on the transfer queue. Uploads are never waited for on the CPU.
+		void Update();
+
+		// 1x1 grey image every streamed image uses until its own is ready
+		Image GetPlaceholder() const { return m_Placeholder; }
+
+		// Loads that haven't finished or failed yet
+		uint32_t GetPendingLoadCount() const { return m_PendingLoadCount; }
+
+	private:
+		struct DecodedImage
+		{
+			std::shared_ptr<StreamedImage::State> State;
+			LoadCallback OnLoaded;
+
+			// Invalid if decoding failed
+			TextureData Texture;
+
+			// Set if the worker already wrote the texture from the host, it only has to be handed out
+			Image Resource;
+		};
+
+		struct PendingUpload
+		{
+			std::shared_ptr<StreamedImage::State> State;
+			LoadCallback OnLoaded;
+			Image Resource;
+			BufferAllocation Staging;
+		};
+
+		struct UploadBatch
+		{
+			CommandPool Pool;
+			uint64_t FenceValue;
+			std::vector<PendingUpload> Uploads;
+		};
+
+		// NOTE(Peter): Larger textures still go through the transfer queue, the copy engine beats the CPU writing into device memory
+		static constexpr uint64_t MaxHostCopyBytes = 4 * 1024 * 1024;
+
+	private:
+		static bool CanWriteFromHost(RHIContext context, const TextureData& texture);
+
+		void FinishUploads(uint64_t completedValue);
+		void FinishLoad(const std::shared_ptr<StreamedImage::State>& state, const LoadCallback& onLoaded, Image image);
+		void FailLoad(const std::shared_ptr<StreamedImage::State>& state, const LoadCallback& onLoaded);
+
+	private:
+		RHIContext m_Context;
+		Queue m_TransferQueue;
+		Fence m_UploadFence;
+		BufferPool m_StagingPool;
+		Image m_Placeholder;
+		uint64_t m_MaxUploadBytesPerFrame = 0;
+
+		TextureImporter m_Importer;
+
+		Aura::Unique<ThreadPool> m_ThreadPool;
+
+		// Written by the workers, in the order they finished decoding
+		std::mutex m_DecodedMutex;
+		std::deque<DecodedImage> m_DecodedImages;
+
+		std::vector<UploadBatch> m_UploadBatches;
+		std::vector<CommandPool> m_FreeCommandPools;
+
+		uint32_t m_PendingLoadCount = 0;
 	};
 
 }
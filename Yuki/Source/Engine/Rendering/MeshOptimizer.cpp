@@ -0,0 +1,449 @@
+#include "MeshOptimizer.hpp"
+#include "VertexPacking.hpp"
+
+#include "Engine/Core/Hash.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace Yuki::MeshOptimizer {
+
+	// NOTE(Peter): Forsyth's parameters, the cache he scores against is bigger than the one the result is measured with
+	static constexpr uint32_t s_ScoringCacheSize = 32;
+	static constexpr float32_t s_LastTriangleScore = 0.75f;
+	static constexpr float32_t s_CacheDecayPower = 1.5f;
+	static constexpr float32_t s_ValenceBoostScale = 2.0f;
+	static constexpr float32_t s_ValenceBoostPower = 0.5f;
+
+	struct VertexHasher
+	{
+		size_t operator()(const MeshVertex* vertex) const { return static_cast<size_t>(HashBytes(vertex, sizeof(MeshVertex))); }
+	};
+
+	struct VertexComparer
+	{
+		bool operator()(const MeshVertex* lhs, const MeshVertex* rhs) const { return memcmp(lhs, rhs, sizeof(MeshVertex)) == 0; }
+	};
+
+	void DeduplicateVertices(std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		std::unordered_map<const MeshVertex*, uint32_t, VertexHasher, VertexComparer> uniqueVertices;
+		uniqueVertices.reserve(vertices.size());
+
+		std::vector<uint32_t> remap(vertices.size());
+		std::vector<MeshVertex> result;
+		result.reserve(vertices.size());
+
+		for (uint32_t i = 0; i < vertices.size(); i++)
+		{
+			auto [it, inserted] = uniqueVertices.try_emplace(&vertices[i], static_cast<uint32_t>(result.size()));
+
+			if (inserted)
+			{
+				result.push_back(vertices[i]);
+			}
+
+			remap[i] = it->second;
+		}
+
+		for (auto& index : indices)
+		{
+			index = remap[index];
+		}
+
+		vertices = std::move(result);
+	}
+
+	static float32_t ScoreVertex(int32_t cachePosition, uint32_t remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+		{
+			return -1.0f;
+		}
+
+		float32_t score = 0.0f;
+
+		if (cachePosition >= 0)
+		{
+			// The vertices of the last triangle score a bit lower, so the order doesn't just turn into one long strip
+			if (cachePosition < 3)
+			{
+				score = s_LastTriangleScore;
+			}
+			else
+			{
+				float32_t scale = 1.0f / (s_ScoringCacheSize - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scale, s_CacheDecayPower);
+			}
+		}
+
+		// Vertices with few triangles left are finished first, so they stop taking up space in the cache
+		score += s_ValenceBoostScale * std::pow(static_cast<float32_t>(remainingTriangles), -s_ValenceBoostPower);
+		return score;
+	}
+
+	void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+	{
+		auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// Triangles that use every vertex, the ones that have been emitted are swapped past the vertex's remaining count
+		std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+		{
+			remainingTriangles[indices[i]]++;
+		}
+
+		std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			triangleOffsets[i + 1] = triangleOffsets[i] + remainingTriangles[i];
+		}
+
+		std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+		std::vector<uint32_t> writeOffsets(triangleOffsets.begin(), triangleOffsets.end() - 1);
+
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+		{
+			vertexTriangles[writeOffsets[indices[i]]++] = i / 3;
+		}
+
+		std::vector<int32_t> cachePositions(vertexCount, -1);
+		std::vector<float32_t> vertexScores(vertexCount);
+
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			vertexScores[i] = ScoreVertex(-1, remainingTriangles[i]);
+		}
+
+		std::vector<bool> emitted(triangleCount, false);
+
+		std::vector<uint32_t> result;
+		result.reserve(triangleCount * 3);
+
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> nextCache;
+		cache.reserve(s_ScoringCacheSize + 3);
+		nextCache.reserve(s_ScoringCacheSize + 3);
+
+		int64_t bestTriangle = -1;
+		uint32_t inputCursor = 0;
+
+		for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+		{
+			// Nothing in the cache has triangles left, carry on with the next one in input order
+			if (bestTriangle < 0)
+			{
+				while (emitted[inputCursor])
+				{
+					inputCursor++;
+				}
+
+				bestTriangle = inputCursor;
+			}
+
+			auto triangle = static_cast<uint32_t>(bestTriangle);
+			const uint32_t* corners = &indices[triangle * 3];
+
+			emitted[triangle] = true;
+			result.insert(result.end(), corners, corners + 3);
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				uint32_t vertex = corners[i];
+				uint32_t* triangles = &vertexTriangles[triangleOffsets[vertex]];
+				uint32_t& remaining = remainingTriangles[vertex];
+
+				for (uint32_t j = 0; j < remaining; j++)
+				{
+					if (triangles[j] == triangle)
+					{
+						std::swap(triangles[j], triangles[remaining - 1]);
+						remaining--;
+						break;
+					}
+				}
+			}
+
+			// The triangle's vertices move to the front, everything else is pushed back
+			nextCache.clear();
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				if (std::find(nextCache.begin(), nextCache.end(), corners[i]) == nextCache.end())
+				{
+					nextCache.push_back(corners[i]);
+				}
+			}
+
+			for (uint32_t vertex : cache)
+			{
+				if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+				{
+					nextCache.push_back(vertex);
+				}
+			}
+
+			for (uint32_t i = 0; i < nextCache.size(); i++)
+			{
+				uint32_t vertex = nextCache[i];
+				cachePositions[vertex] = i < s_ScoringCacheSize ? static_cast<int32_t>(i) : -1;
+				vertexScores[vertex] = ScoreVertex(cachePositions[vertex], remainingTriangles[vertex]);
+			}
+
+			// Only triangles that touch the cache changed their score, the best one that's still in the cache is next
+			bestTriangle = -1;
+			float32_t bestScore = -1.0f;
+
+			for (uint32_t vertex : nextCache)
+			{
+				const uint32_t* triangles = &vertexTriangles[triangleOffsets[vertex]];
+
+				for (uint32_t j = 0; j < remainingTriangles[vertex]; j++)
+				{
+					uint32_t candidate = triangles[j];
+					const uint32_t* candidateCorners = &indices[candidate * 3];
+
+					float32_t score = vertexScores[candidateCorners[0]] + vertexScores[candidateCorners[1]] + vertexScores[candidateCorners[2]];
+
+					if (cachePositions[vertex] >= 0 && score > bestScore)
+					{
+						bestScore = score;
+						bestTriangle = candidate;
+					}
+				}
+			}
+
+			if (nextCache.size() > s_ScoringCacheSize)
+			{
+				nextCache.resize(s_ScoringCacheSize);
+			}
+
+			std::swap(cache, nextCache);
+		}
+
+		// NOTE(Peter): Leftover indices that don't make up a whole triangle are dropped, they never drew anything
+		indices = std::move(result);
+	}
+
+	void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices)
+	{
+		auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// A cluster starts wherever a triangle misses the cache with all three vertices, so reordering clusters
+		// costs (almost) nothing in vertex cache efficiency
+		std::vector<uint32_t> clusterStarts;
+		std::vector<uint32_t> cacheTimestamps(vertices.size(), 0);
+		uint32_t time = VertexCacheSize + 1;
+
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			uint32_t misses = 0;
+
+			for (uint32_t j = 0; j < 3; j++)
+			{
+				uint32_t vertex = indices[i * 3 + j];
+
+				if (time - cacheTimestamps[vertex] > VertexCacheSize)
+				{
+					cacheTimestamps[vertex] = time++;
+					misses++;
+				}
+			}
+
+			if (i == 0 || misses == 3)
+			{
+				clusterStarts.push_back(i);
+			}
+		}
+
+		clusterStarts.push_back(triangleCount);
+
+		auto clusterCount = static_cast<uint32_t>(clusterStarts.size() - 1);
+
+		if (clusterCount < 2)
+		{
+			return;
+		}
+
+		struct Cluster
+		{
+			uint32_t FirstTriangle;
+			uint32_t TriangleCount;
+			float32_t Centroid[3];
+			float32_t Normal[3];
+			float32_t Area;
+			float32_t SortKey;
+		};
+
+		std::vector<Cluster> clusters(clusterCount);
+		float32_t meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+		float32_t meshArea = 0.0f;
+
+		for (uint32_t i = 0; i < clusterCount; i++)
+		{
+			auto& cluster = clusters[i];
+			cluster = { .FirstTriangle = clusterStarts[i], .TriangleCount = clusterStarts[i + 1] - clusterStarts[i] };
+
+			for (uint32_t triangle = cluster.FirstTriangle; triangle < cluster.FirstTriangle + cluster.TriangleCount; triangle++)
+			{
+				const auto& a = vertices[indices[triangle * 3]].Position;
+				const auto& b = vertices[indices[triangle * 3 + 1]].Position;
+				const auto& c = vertices[indices[triangle * 3 + 2]].Position;
+
+				float32_t ab[3] = { b.X - a.X, b.Y - a.Y, b.Z - a.Z };
+				float32_t ac[3] = { c.X - a.X, c.Y - a.Y, c.Z - a.Z };
+				float32_t normal[3] =
+				{
+					ab[1] * ac[2] - ab[2] * ac[1],
+					ab[2] * ac[0] - ab[0] * ac[2],
+					ab[0] * ac[1] - ab[1] * ac[0],
+				};
+
+				// The cross product is twice the area along the normal, so summing it weighs every triangle by its area
+				float32_t area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+				float32_t center[3] = { (a.X + b.X + c.X) / 3.0f, (a.Y + b.Y + c.Y) / 3.0f, (a.Z + b.Z + c.Z) / 3.0f };
+
+				for (uint32_t j = 0; j < 3; j++)
+				{
+					cluster.Centroid[j] += center[j] * area;
+					cluster.Normal[j] += normal[j];
+				}
+
+				cluster.Area += area;
+			}
+
+			for (uint32_t j = 0; j < 3; j++)
+			{
+				meshCentroid[j] += cluster.Centroid[j];
+			}
+
+			meshArea += cluster.Area;
+
+			if (cluster.Area > 0.0f)
+			{
+				for (uint32_t j = 0; j < 3; j++)
+				{
+					cluster.Centroid[j] /= cluster.Area;
+				}
+			}
+		}
+
+		if (meshArea > 0.0f)
+		{
+			for (uint32_t j = 0; j < 3; j++)
+			{
+				meshCentroid[j] /= meshArea;
+			}
+		}
+
+		for (auto& cluster : clusters)
+		{
+			float32_t normalLength = std::sqrt(cluster.Normal[0] * cluster.Normal[0] + cluster.Normal[1] * cluster.Normal[1] + cluster.Normal[2] * cluster.Normal[2]);
+
+			if (normalLength == 0.0f)
+			{
+				continue;
+			}
+
+			for (uint32_t j = 0; j < 3; j++)
+			{
+				cluster.SortKey += (cluster.Centroid[j] - meshCentroid[j]) * cluster.Normal[j] / normalLength;
+			}
+		}
+
+		// Clusters on the outside facing outwards are the ones that'll cover the others
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& lhs, const Cluster& rhs)
+		{
+			return lhs.SortKey > rhs.SortKey;
+		});
+
+		std::vector<uint32_t> result;
+		result.reserve(triangleCount * 3);
+
+		for (const auto& cluster : clusters)
+		{
+			auto first = indices.begin() + cluster.FirstTriangle * 3;
+			result.insert(result.end(), first, first + cluster.TriangleCount * 3);
+		}
+
+		indices = std::move(result);
+	}
+
+	void OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		std::vector<uint32_t> remap(vertices.size(), std::numeric_limits<uint32_t>::max());
+		std::vector<MeshVertex> result;
+		result.reserve(vertices.size());
+
+		for (auto& index : indices)
+		{
+			if (remap[index] == std::numeric_limits<uint32_t>::max())
+			{
+				remap[index] = static_cast<uint32_t>(result.size());
+				result.push_back(vertices[index]);
+			}
+
+			index = remap[index];
+		}
+
+		vertices = std::move(result);
+	}
+
+	float32_t CalculateACMR(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+	{
+		if (indices.size() < 3)
+		{
+			return 0.0f;
+		}
+
+		// A vertex is in the FIFO as long as fewer than VertexCacheSize misses happened since it was added
+		std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+		uint32_t time = VertexCacheSize + 1;
+		uint32_t misses = 0;
+
+		for (uint32_t index : indices)
+		{
+			if (time - cacheTimestamps[index] > VertexCacheSize)
+			{
+				cacheTimestamps[index] = time++;
+				misses++;
+			}
+		}
+
+		return static_cast<float32_t>(misses) / static_cast<float32_t>(indices.size() / 3);
+	}
+
+	QuantizedMeshVertex QuantizeVertex(const MeshVertex& vertex, rtmcpp::PackedVec3 positionMin, rtmcpp::PackedVec3 positionScale)
+	{
+		auto quantize = [](float32_t value, float32_t min, float32_t scale)
+		{
+			return scale > 0.0f ? FloatToUnorm16((value - min) / scale) : uint16_t(0);
+		};
+
+		return
+		{
+			.Position =
+			{
+				quantize(vertex.Position.X, positionMin.X, positionScale.X),
+				quantize(vertex.Position.Y, positionMin.Y, positionScale.Y),
+				quantize(vertex.Position.Z, positionMin.Z, positionScale.Z),
+				0,
+			},
+			.Normal = PackSnorm10x3(vertex.Normal.X, vertex.Normal.Y, vertex.Normal.Z),
+			.UV = { FloatToHalf(vertex.UV.X), FloatToHalf(vertex.UV.Y) },
+		};
+	}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Engine/Core/Core.hpp"
+
+#include <rtmcpp/PackedVector.hpp>
+
+namespace Yuki {
+
+	struct MeshVertex
+	{
+		rtmcpp::PackedVec3 Position;
+		rtmcpp::PackedVec3 Normal;
+		rtmcpp::PackedVec2 UV;
+	};
+	static_assert(sizeof(MeshVertex) == 32);
+
+	// Half the size of MeshVertex. Positions are unorm16 within the bounds of the model, normals snorm 10:10:10:2 and UVs halfs.
+	struct QuantizedMeshVertex
+	{
+		uint16_t Position[4];
+		uint32_t Normal;
+		uint16_t UV[2];
+	};
+	static_assert(sizeof(QuantizedMeshVertex) == 16);
+
+	// Reorders triangle lists so they're cheaper to draw. Meant to be run at import time, in this order:
+	// DeduplicateVertices, OptimizeVertexCache, OptimizeOverdraw and OptimizeVertexFetch. None of them change what's drawn.
+	namespace MeshOptimizer {
+
+		// The post-transform cache the optimizations assume, smaller than what most GPUs have so the results hold up everywhere
+		inline constexpr uint32_t VertexCacheSize = 16;
+
+		// Merges vertices that are bit-for-bit identical and points the indices at the remaining ones
+		void DeduplicateVertices(std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices);
+
+		// Orders the triangles so vertices are reused while they're still in the post-transform cache (Forsyth's algorithm)
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+		// Splits the triangles into clusters wherever the vertex cache order starts over, and draws the clusters that face
+		// away from the center of the mesh first since they're the most likely to occlude the rest. Keeps the order within
+		// every cluster, so it should run after OptimizeVertexCache.
+		void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices);
+
+		// Stores the vertices in the order they're first used, so fetching them walks memory linearly. Drops unused vertices.
+		void OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices);
+
+		// Average vertex cache misses per triangle with a FIFO cache of VertexCacheSize, between 0.5 and 3. Lower is better.
+		float32_t CalculateACMR(const std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+		// positionMin and positionScale have to cover every position, Position = positionMin + unorm16 * positionScale
+		QuantizedMeshVertex QuantizeVertex(const MeshVertex& vertex, rtmcpp::PackedVec3 positionMin, rtmcpp::PackedVec3 positionScale);
+
+	}
+
+}
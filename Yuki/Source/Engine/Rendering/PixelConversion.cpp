@@ -0,0 +1,271 @@
+#include "PixelConversion.hpp"
+
+#include "Engine/Core/CPUFeatures.hpp"
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+	#include <arm_neon.h>
+#endif
+
+#include <cmath>
+
+namespace Yuki::PixelConversion {
+
+	static void ExpandRGBToRGBAScalar(const uint8_t* rgb, uint8_t* rgba, uint64_t count)
+	{
+		for (uint64_t i = 0; i < count; i++)
+		{
+			rgba[i * 4 + 0] = rgb[i * 3 + 0];
+			rgba[i * 4 + 1] = rgb[i * 3 + 1];
+			rgba[i * 4 + 2] = rgb[i * 3 + 2];
+			rgba[i * 4 + 3] = 255;
+		}
+	}
+
+	static void ExpandGreyToRGBAScalar(const uint8_t* grey, uint8_t* rgba, uint64_t count)
+	{
+		for (uint64_t i = 0; i < count; i++)
+		{
+			rgba[i * 4 + 0] = grey[i];
+			rgba[i * 4 + 1] = grey[i];
+			rgba[i * 4 + 2] = grey[i];
+			rgba[i * 4 + 3] = 255;
+		}
+	}
+
+	static void ExpandGreyAlphaToRGBAScalar(const uint8_t* greyAlpha, uint8_t* rgba, uint64_t count)
+	{
+		for (uint64_t i = 0; i < count; i++)
+		{
+			rgba[i * 4 + 0] = greyAlpha[i * 2];
+			rgba[i * 4 + 1] = greyAlpha[i * 2];
+			rgba[i * 4 + 2] = greyAlpha[i * 2];
+			rgba[i * 4 + 3] = greyAlpha[i * 2 + 1];
+		}
+	}
+
+	static void SwapRedBlueScalar(const uint8_t* source, uint8_t* dest, uint64_t count)
+	{
+		for (uint64_t i = 0; i < count; i++)
+		{
+			uint8_t red = source[i * 4 + 0];
+			dest[i * 4 + 0] = source[i * 4 + 2];
+			dest[i * 4 + 1] = source[i * 4 + 1];
+			dest[i * 4 + 2] = red;
+			dest[i * 4 + 3] = source[i * 4 + 3];
+		}
+	}
+
+	static void PremultiplyAlphaScalar(uint8_t* rgba, uint64_t count)
+	{
+		for (uint64_t i = 0; i < count; i++)
+		{
+			uint32_t alpha = rgba[i * 4 + 3];
+
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				// Exact round(color * alpha / 255), the same trick the SIMD kernels use
+				uint32_t product = rgba[i * 4 + c] * alpha + 128;
+				rgba[i * 4 + c] = static_cast<uint8_t>((product + (product >> 8)) >> 8);
+			}
+		}
+	}
+
+	static void LinearizeSRGBScalar(const uint8_t* rgba, float32_t* linear, uint64_t count)
+	{
+		const float32_t* table = GetSRGBToLinearTable();
+
+		for (uint64_t i = 0; i < count; i++)
+		{
+			linear[i * 4 + 0] = table[rgba[i * 4 + 0]];
+			linear[i * 4 + 1] = table[rgba[i * 4 + 1]];
+			linear[i * 4 + 2] = table[rgba[i * 4 + 2]];
+			linear[i * 4 + 3] = rgba[i * 4 + 3] * (1.0f / 255.0f);
+		}
+	}
+
+	static void EncodeSRGBScalar(const float32_t* linear, uint8_t* rgba, uint64_t count)
+	{
+		const uint8_t* table = GetLinearToSRGBTable();
+
+		// NOTE(Peter): Truncating after adding 0.5 rounds the same way the SIMD kernels do
+		for (uint64_t i = 0; i < count; i++)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				float32_t value = std::min(std::max(linear[i * 4 + c], 0.0f), 1.0f);
+				rgba[i * 4 + c] = table[static_cast<uint32_t>(value * float32_t(LinearToSRGBTableSize - 1) + 0.5f)];
+			}
+
+			float32_t alpha = std::min(std::max(linear[i * 4 + 3], 0.0f), 1.0f);
+			rgba[i * 4 + 3] = static_cast<uint8_t>(alpha * 255.0f + 0.5f);
+		}
+	}
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+	static void ExpandRGBToRGBANEON(const uint8_t* rgb, uint8_t* rgba, uint64_t count)
+	{
+		uint64_t i = 0;
+
+		for (; i + 16 <= count; i += 16)
+		{
+			uint8x16x3_t source = vld3q_u8(rgb + i * 3);
+			vst4q_u8(rgba + i * 4, { source.val[0], source.val[1], source.val[2], vdupq_n_u8(255) });
+		}
+
+		ExpandRGBToRGBAScalar(rgb + i * 3, rgba + i * 4, count - i);
+	}
+
+	static void ExpandGreyToRGBANEON(const uint8_t* grey, uint8_t* rgba, uint64_t count)
+	{
+		uint64_t i = 0;
+
+		for (; i + 16 <= count; i += 16)
+		{
+			uint8x16_t source = vld1q_u8(grey + i);
+			vst4q_u8(rgba + i * 4, { source, source, source, vdupq_n_u8(255) });
+		}
+
+		ExpandGreyToRGBAScalar(grey + i, rgba + i * 4, count - i);
+	}
+
+	static void ExpandGreyAlphaToRGBANEON(const uint8_t* greyAlpha, uint8_t* rgba, uint64_t count)
+	{
+		uint64_t i = 0;
+
+		for (; i + 16 <= count; i += 16)
+		{
+			uint8x16x2_t source = vld2q_u8(greyAlpha + i * 2);
+			vst4q_u8(rgba + i * 4, { source.val[0], source.val[0], source.val[0], source.val[1] });
+		}
+
+		ExpandGreyAlphaToRGBAScalar(greyAlpha + i * 2, rgba + i * 4, count - i);
+	}
+
+	static void SwapRedBlueNEON(const uint8_t* source, uint8_t* dest, uint64_t count)
+	{
+		uint64_t i = 0;
+
+		for (; i + 16 <= count; i += 16)
+		{
+			uint8x16x4_t pixels = vld4q_u8(source + i * 4);
+			vst4q_u8(dest + i * 4, { pixels.val[2], pixels.val[1], pixels.val[0], pixels.val[3] });
+		}
+
+		SwapRedBlueScalar(source + i * 4, dest + i * 4, count - i);
+	}
+
+	static void PremultiplyAlphaNEON(uint8_t* rgba, uint64_t count)
+	{
+		uint64_t i = 0;
+
+		for (; i + 8 <= count; i += 8)
+		{
+			uint8x8x4_t pixels = vld4_u8(rgba + i * 4);
+
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				uint16x8_t product = vaddq_u16(vmull_u8(pixels.val[c], pixels.val[3]), vdupq_n_u16(128));
+				pixels.val[c] = vshrn_n_u16(vsraq_n_u16(product, product, 8), 8);
+			}
+
+			vst4_u8(rgba + i * 4, pixels);
+		}
+
+		PremultiplyAlphaScalar(rgba + i * 4, count - i);
+	}
+#endif
+
+	static Kernels SelectKernels()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		if (IsAVX2Supported())
+		{
+			return GetAVX2Kernels();
+		}
+#endif
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+		// NOTE(Peter): The sRGB conversions are table lookups, NEON doesn't have a gather to speed them up
+		return
+		{
+			.ExpandRGBToRGBA = ExpandRGBToRGBANEON,
+			.ExpandGreyToRGBA = ExpandGreyToRGBANEON,
+			.ExpandGreyAlphaToRGBA = ExpandGreyAlphaToRGBANEON,
+			.SwapRedBlue = SwapRedBlueNEON,
+			.PremultiplyAlpha = PremultiplyAlphaNEON,
+			.LinearizeSRGB = LinearizeSRGBScalar,
+			.EncodeSRGB = EncodeSRGBScalar,
+		};
+#else
+		return GetScalarKernels();
+#endif
+	}
+
+	static const Kernels& GetKernels()
+	{
+		static const Kernels s_Kernels = SelectKernels();
+		return s_Kernels;
+	}
+
+	const Kernels& GetScalarKernels()
+	{
+		static const Kernels s_Kernels =
+		{
+			.ExpandRGBToRGBA = ExpandRGBToRGBAScalar,
+			.ExpandGreyToRGBA = ExpandGreyToRGBAScalar,
+			.ExpandGreyAlphaToRGBA = ExpandGreyAlphaToRGBAScalar,
+			.SwapRedBlue = SwapRedBlueScalar,
+			.PremultiplyAlpha = PremultiplyAlphaScalar,
+			.LinearizeSRGB = LinearizeSRGBScalar,
+			.EncodeSRGB = EncodeSRGBScalar,
+		};
+
+		return s_Kernels;
+	}
+
+	const float32_t* GetSRGBToLinearTable()
+	{
+		static const auto s_Table = []()
+		{
+			std::array<float32_t, 256> table;
+
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				float64_t value = i / 255.0;
+				table[i] = static_cast<float32_t>(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+			}
+
+			return table;
+		}();
+
+		return s_Table.data();
+	}
+
+	const uint8_t* GetLinearToSRGBTable()
+	{
+		static const auto s_Table = []()
+		{
+			std::vector<uint8_t> table(LinearToSRGBTableSize + 3);
+
+			for (uint32_t i = 0; i < LinearToSRGBTableSize; i++)
+			{
+				float64_t value = i / float64_t(LinearToSRGBTableSize - 1);
+				float64_t encoded = value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+				table[i] = static_cast<uint8_t>(std::min(encoded * 255.0 + 0.5, 255.0));
+			}
+
+			return table;
+		}();
+
+		return s_Table.data();
+	}
+
+	void ExpandRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, uint64_t count) { GetKernels().ExpandRGBToRGBA(rgb, rgba, count); }
+	void ExpandGreyToRGBA(const uint8_t* grey, uint8_t* rgba, uint64_t count) { GetKernels().ExpandGreyToRGBA(grey, rgba, count); }
+	void ExpandGreyAlphaToRGBA(const uint8_t* greyAlpha, uint8_t* rgba, uint64_t count) { GetKernels().ExpandGreyAlphaToRGBA(greyAlpha, rgba, count); }
+	void SwapRedBlue(const uint8_t* source, uint8_t* dest, uint64_t count) { GetKernels().SwapRedBlue(source, dest, count); }
+	void PremultiplyAlpha(uint8_t* rgba, uint64_t count) { GetKernels().PremultiplyAlpha(rgba, count); }
+	void LinearizeSRGB(const uint8_t* rgba, float32_t* linear, uint64_t count) { GetKernels().LinearizeSRGB(rgba, linear, count); }
+	void EncodeSRGB(const float32_t* linear, uint8_t* rgba, uint64_t count) { GetKernels().EncodeSRGB(linear, rgba, count); }
+
+}
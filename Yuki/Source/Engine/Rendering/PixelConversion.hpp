@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Engine/Core/Core.hpp"
+
+namespace Yuki {
+
+	// Converts rows of pixels between the layouts images are decoded in and the ones they're uploaded in. Every function
+	// converts count tightly packed pixels with 8 bits per channel, and runs the widest implementation the CPU supports.
+	namespace PixelConversion {
+
+		// Alpha is set to 255
+		void ExpandRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, uint64_t count);
+		void ExpandGreyToRGBA(const uint8_t* grey, uint8_t* rgba, uint64_t count);
+		void ExpandGreyAlphaToRGBA(const uint8_t* greyAlpha, uint8_t* rgba, uint64_t count);
+
+		// Swaps red and blue, turning RGBA into BGRA and back. source and dest can be the same.
+		void SwapRedBlue(const uint8_t* source, uint8_t* dest, uint64_t count);
+
+		// In place, every color channel becomes round(color * alpha / 255)
+		void PremultiplyAlpha(uint8_t* rgba, uint64_t count);
+
+		// sRGB encoded color into linear floats, alpha is only normalized. linear holds four floats per pixel.
+		void LinearizeSRGB(const uint8_t* rgba, float32_t* linear, uint64_t count);
+
+		// Back from linear floats, clamping to [0, 1] and rounding to the nearest sRGB value
+		void EncodeSRGB(const float32_t* linear, uint8_t* rgba, uint64_t count);
+
+		// NOTE(Peter): Everything below is only meant for the implementations
+
+		struct Kernels
+		{
+			void(*ExpandRGBToRGBA)(const uint8_t* rgb, uint8_t* rgba, uint64_t count);
+			void(*ExpandGreyToRGBA)(const uint8_t* grey, uint8_t* rgba, uint64_t count);
+			void(*ExpandGreyAlphaToRGBA)(const uint8_t* greyAlpha, uint8_t* rgba, uint64_t count);
+			void(*SwapRedBlue)(const uint8_t* source, uint8_t* dest, uint64_t count);
+			void(*PremultiplyAlpha)(uint8_t* rgba, uint64_t count);
+			void(*LinearizeSRGB)(const uint8_t* rgba, float32_t* linear, uint64_t count);
+			void(*EncodeSRGB)(const float32_t* linear, uint8_t* rgba, uint64_t count);
+		};
+
+		// The SIMD kernels hand the pixels that don't fill a whole register to these
+		const Kernels& GetScalarKernels();
+
+#if defined(_M_X64) || defined(__x86_64__)
+		Kernels GetAVX2Kernels();
+#endif
+
+		// 256 entries, indexed by the sRGB value
+		const float32_t* GetSRGBToLinearTable();
+
+		// Linear values quantized to 16 bits map to their sRGB value. Has a few bytes of padding at the end so it can be
+		// read 32 bits at a time.
+		static constexpr uint32_t LinearToSRGBTableSize = 65536;
+		const uint8_t* GetLinearToSRGBTable();
+
+	}
+
+}
@@ -0,0 +1,201 @@
+#include "PixelConversion.hpp"
+
+// NOTE(Peter): This file is compiled with AVX2 enabled, nothing in here may be called
+//				unless PixelConversion has verified that the CPU supports it
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace Yuki::PixelConversion {
+
+	static void ExpandRGBToRGBAAVX2(const uint8_t* rgb, uint8_t* rgba, uint64_t count)
+	{
+		// Both 128-bit lanes turn the first 12 bytes they hold into 4 pixels
+		const __m256i shuffle = _mm256_setr_epi8(
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+		);
+		const __m256i alpha = _mm256_set1_epi32(static_cast<int32_t>(0xFF000000));
+
+		uint64_t i = 0;
+
+		// The second load reads 4 bytes past the 8th pixel
+		for (; i + 10 <= count; i += 8)
+		{
+			__m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+			__m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3 + 12));
+
+			__m256i pixels = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1), shuffle);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_or_si256(pixels, alpha));
+		}
+
+		GetScalarKernels().ExpandRGBToRGBA(rgb + i * 3, rgba + i * 4, count - i);
+	}
+
+	static void ExpandGreyToRGBAAVX2(const uint8_t* grey, uint8_t* rgba, uint64_t count)
+	{
+		const __m256i shuffle = _mm256_setr_epi8(
+			0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1,
+			4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1
+		);
+		const __m256i alpha = _mm256_set1_epi32(static_cast<int32_t>(0xFF000000));
+
+		uint64_t i = 0;
+
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i source = _mm256_broadcastsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(grey + i)));
+			__m256i pixels = _mm256_shuffle_epi8(source, shuffle);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_or_si256(pixels, alpha));
+		}
+
+		GetScalarKernels().ExpandGreyToRGBA(grey + i, rgba + i * 4, count - i);
+	}
+
+	static void ExpandGreyAlphaToRGBAAVX2(const uint8_t* greyAlpha, uint8_t* rgba, uint64_t count)
+	{
+		const __m256i shuffle = _mm256_setr_epi8(
+			0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7,
+			8, 8, 8, 9, 10, 10, 10, 11, 12, 12, 12, 13, 14, 14, 14, 15
+		);
+
+		uint64_t i = 0;
+
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i source = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(greyAlpha + i * 2)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_shuffle_epi8(source, shuffle));
+		}
+
+		GetScalarKernels().ExpandGreyAlphaToRGBA(greyAlpha + i * 2, rgba + i * 4, count - i);
+	}
+
+	static void SwapRedBlueAVX2(const uint8_t* source, uint8_t* dest, uint64_t count)
+	{
+		const __m256i shuffle = _mm256_setr_epi8(
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+		);
+
+		uint64_t i = 0;
+
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 4));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+		}
+
+		GetScalarKernels().SwapRedBlue(source + i * 4, dest + i * 4, count - i);
+	}
+
+	// Every 16-bit lane times the alpha of its pixel, alpha itself is multiplied by 255 so it comes out unchanged
+	static __m256i PremultiplyChannels(__m256i channels)
+	{
+		const __m256i alphaShuffle = _mm256_setr_epi8(
+			6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1,
+			6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1
+		);
+		const __m256i alphaLanes = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+
+		__m256i alpha = _mm256_or_si256(_mm256_shuffle_epi8(channels, alphaShuffle), alphaLanes);
+		__m256i product = _mm256_add_epi16(_mm256_mullo_epi16(channels, alpha), _mm256_set1_epi16(128));
+		return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+	}
+
+	static void PremultiplyAlphaAVX2(uint8_t* rgba, uint64_t count)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+
+		uint64_t i = 0;
+
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + i * 4));
+
+			// NOTE(Peter): Unpacking and packing both work within 128-bit lanes, so the pixels end up back where they started
+			__m256i low = PremultiplyChannels(_mm256_unpacklo_epi8(pixels, zero));
+			__m256i high = PremultiplyChannels(_mm256_unpackhi_epi8(pixels, zero));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_packus_epi16(low, high));
+		}
+
+		GetScalarKernels().PremultiplyAlpha(rgba + i * 4, count - i);
+	}
+
+	static void LinearizeSRGBAVX2(const uint8_t* rgba, float32_t* linear, uint64_t count)
+	{
+		const float32_t* table = GetSRGBToLinearTable();
+		const __m256 alphaScale = _mm256_set1_ps(1.0f / 255.0f);
+
+		uint64_t i = 0;
+
+		for (; i + 2 <= count; i += 2)
+		{
+			__m256i values = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rgba + i * 4)));
+
+			__m256 color = _mm256_i32gather_ps(table, values, 4);
+			__m256 alpha = _mm256_mul_ps(_mm256_cvtepi32_ps(values), alphaScale);
+
+			_mm256_storeu_ps(linear + i * 4, _mm256_blend_ps(color, alpha, 0b10001000));
+		}
+
+		GetScalarKernels().LinearizeSRGB(rgba + i * 4, linear + i * 4, count - i);
+	}
+
+	// Two pixels worth of channels into 32-bit integers
+	static __m256i EncodeChannels(const float32_t* linear, const uint8_t* table)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 half = _mm256_set1_ps(0.5f);
+
+		__m256 values = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(linear), zero), one);
+
+		__m256i indices = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(values, _mm256_set1_ps(float32_t(LinearToSRGBTableSize - 1))), half));
+		__m256i color = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int32_t*>(table), indices, 1), _mm256_set1_epi32(0xFF));
+		__m256i alpha = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(values, _mm256_set1_ps(255.0f)), half));
+
+		return _mm256_blend_epi32(color, alpha, 0b10001000);
+	}
+
+	static void EncodeSRGBAVX2(const float32_t* linear, uint8_t* rgba, uint64_t count)
+	{
+		const uint8_t* table = GetLinearToSRGBTable();
+
+		// The packs interleave the two 128-bit lanes, this puts the four pixels back in order
+		const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+		uint64_t i = 0;
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256i first = EncodeChannels(linear + i * 4, table);
+			__m256i second = EncodeChannels(linear + i * 4 + 8, table);
+
+			__m256i words = _mm256_packus_epi32(first, second);
+			__m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(words, words), order);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), _mm256_castsi256_si128(bytes));
+		}
+
+		GetScalarKernels().EncodeSRGB(linear + i * 4, rgba + i * 4, count - i);
+	}
+
+	Kernels GetAVX2Kernels()
+	{
+		return
+		{
+			.ExpandRGBToRGBA = ExpandRGBToRGBAAVX2,
+			.ExpandGreyToRGBA = ExpandGreyToRGBAAVX2,
+			.ExpandGreyAlphaToRGBA = ExpandGreyAlphaToRGBAAVX2,
+			.SwapRedBlue = SwapRedBlueAVX2,
+			.PremultiplyAlpha = PremultiplyAlphaAVX2,
+			.LinearizeSRGB = LinearizeSRGBAVX2,
+			.EncodeSRGB = EncodeSRGBAVX2,
+		};
+	}
+
+}
+
+#endif
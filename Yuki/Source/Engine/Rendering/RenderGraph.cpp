@@ -0,0 +1,467 @@
+#include "RenderGraph.hpp"
+
+#include <Aura/Stack.hpp>
+
+namespace Yuki {
+
+	static ImageUsage ResourceAccessToImageUsage(ResourceAccess access)
+	{
+		switch (access)
+		{
+		case ResourceAccess::ColorAttachmentWrite: return ImageUsage::ColorAttachment;
+		case ResourceAccess::DepthAttachmentWrite: return ImageUsage::DepthStencilAttachment;
+		case ResourceAccess::TransferRead: return ImageUsage::TransferSrc;
+		case ResourceAccess::TransferWrite: return ImageUsage::TransferDst;
+		case ResourceAccess::ShaderRead: return ImageUsage::Sampled;
+		default: return {};
+		}
+	}
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	void RenderGraphPassBuilder::Read(RenderGraphImage image, ResourceAccess access)
+	{
+		YukiAssert(image.IsValid());
+		m_Graph.m_Passes[m_PassIndex].ImageUses.push_back({ image.Index, access, false });
+	}
+
+	void RenderGraphPassBuilder::Write(RenderGraphImage image, ResourceAccess access)
+	{
+		YukiAssert(image.IsValid());
+		m_Graph.m_Passes[m_PassIndex].ImageUses.push_back({ image.Index, access, true });
+	}
+
+	void RenderGraphPassBuilder::Read(RenderGraphBuffer buffer, ResourceAccess access)
+	{
+		YukiAssert(buffer.IsValid());
+		m_Graph.m_Passes[m_PassIndex].BufferUses.push_back({ buffer.Index, access, false });
+	}
+
+	void RenderGraphPassBuilder::Write(RenderGraphBuffer buffer, ResourceAccess access)
+	{
+		YukiAssert(buffer.IsValid());
+		m_Graph.m_Passes[m_PassIndex].BufferUses.push_back({ buffer.Index, access, true });
+	}
+
+	void RenderGraphPassBuilder::SetSideEffects()
+	{
+		m_Graph.m_Passes[m_PassIndex].HasSideEffects = true;
+	}
+
+	RenderGraph::RenderGraph(RHIContext context)
+		: m_Context(context)
+	{
+	}
+
+	void RenderGraph::Destroy()
+	{
+		for (auto& transient : m_TransientImages)
+		{
+			transient.Resource.Destroy();
+		}
+
+		for (auto& retired : m_RetiredResources)
+		{
+			for (auto image : retired.Images)
+			{
+				image.Destroy();
+			}
+
+			if (retired.Memory)
+			{
+				retired.Memory.Destroy();
+			}
+		}
+
+		if (m_Memory)
+		{
+			m_Memory.Destroy();
+		}
+
+		m_TransientImages.clear();
+		m_RetiredResources.clear();
+		m_Memory = {};
+		m_MemorySize = 0;
+	}
+
+	RenderGraphImage RenderGraph::ImportImage(Image image, ResourceAccess finalAccess)
+	{
+		m_Images.push_back({
+			.Physical = image,
+			.IsImported = true,
+			.FinalAccess = finalAccess,
+		});
+
+		return { static_cast<uint32_t>(m_Images.size() - 1) };
+	}
+
+	RenderGraphBuffer RenderGraph::ImportBuffer(Buffer buffer)
+	{
+		m_Buffers.push_back(buffer);
+		return { static_cast<uint32_t>(m_Buffers.size() - 1) };
+	}
+
+	RenderGraphImage RenderGraph::CreateImage(const RenderGraphImageConfig& config)
+	{
+		m_Images.push_back({
+			.IsImported = false,
+			.Config = config,
+		});
+
+		return { static_cast<uint32_t>(m_Images.size() - 1) };
+	}
+
+	void RenderGraph::AddPass(std::string_view name, const SetupFunc& setup, ExecuteFunc execute)
+	{
+		uint32_t passIndex = static_cast<uint32_t>(m_Passes.size());
+		m_Passes.push_back({ .Name = std::string(name), .Execute = std::move(execute) });
+
+		RenderGraphPassBuilder builder(*this, passIndex);
+		setup(builder);
+	}
+
+	Image RenderGraph::GetImage(RenderGraphImage image) const
+	{
+		return m_Images[image.Index].Physical;
+	}
+
+	Buffer RenderGraph::GetBuffer(RenderGraphBuffer buffer) const
+	{
+		return m_Buffers[buffer.Index];
+	}
+
+	void RenderGraph::CullPasses()
+	{
+		std::vector<bool> imageNeeded(m_Images.size(), false);
+		m_CulledPassCount = 0;
+
+		// NOTE(Peter): Walking backwards means every pass that reads a resource has been visited before the passes writing it,
+		//              buffers are always imported so writing any of them keeps the pass alive
+		for (uint32_t i = static_cast<uint32_t>(m_Passes.size()); i-- > 0;)
+		{
+			auto& pass = m_Passes[i];
+			bool keep = pass.HasSideEffects;
+
+			for (const auto& use : pass.ImageUses)
+			{
+				keep |= use.IsWrite && (m_Images[use.Index].IsImported || imageNeeded[use.Index]);
+			}
+
+			for (const auto& use : pass.BufferUses)
+			{
+				keep |= use.IsWrite;
+			}
+
+			pass.IsCulled = !keep;
+
+			if (pass.IsCulled)
+			{
+				m_CulledPassCount++;
+				continue;
+			}
+
+			for (const auto& use : pass.ImageUses)
+			{
+				if (!use.IsWrite)
+				{
+					imageNeeded[use.Index] = true;
+				}
+			}
+		}
+	}
+
+	void RenderGraph::AllocateTransientImages(Fence fence)
+	{
+		std::vector<uint32_t> transients;
+
+		for (uint32_t passIndex = 0; passIndex < m_Passes.size(); passIndex++)
+		{
+			const auto& pass = m_Passes[passIndex];
+
+			if (pass.IsCulled)
+			{
+				continue;
+			}
+
+			for (const auto& use : pass.ImageUses)
+			{
+				auto& image = m_Images[use.Index];
+
+				if (image.IsImported)
+				{
+					continue;
+				}
+
+				if (image.FirstPass == ~0u)
+				{
+					image.FirstPass = passIndex;
+					transients.push_back(use.Index);
+				}
+
+				image.LastPass = passIndex;
+				image.Usage |= ResourceAccessToImageUsage(use.Access);
+			}
+		}
+
+		// Place the largest images first, each image goes at the lowest offset that doesn't overlap
+		// an already placed image that's alive at the same time
+		for (uint32_t index : transients)
+		{
+			auto& image = m_Images[index];
+			image.Requirements = Image::GetMemoryRequirements(m_Context, { image.Config.Width, image.Config.Height, image.Config.Format, image.Usage });
+		}
+
+		std::ranges::stable_sort(transients, std::greater{}, [&](uint32_t index) { return m_Images[index].Requirements.Size; });
+
+		uint64_t memorySize = 0;
+		uint32_t memoryTypeBits = ~0u;
+		m_UnaliasedMemorySize = 0;
+
+		std::vector<uint32_t> placed;
+		std::vector<uint32_t> conflicts;
+
+		for (uint32_t index : transients)
+		{
+			auto& image = m_Images[index];
+
+			conflicts.clear();
+			for (uint32_t other : placed)
+			{
+				const auto& otherImage = m_Images[other];
+
+				if (otherImage.FirstPass <= image.LastPass && image.FirstPass <= otherImage.LastPass)
+				{
+					conflicts.push_back(other);
+				}
+			}
+
+			std::ranges::sort(conflicts, {}, [&](uint32_t other) { return m_Images[other].Offset; });
+
+			uint64_t offset = 0;
+			for (uint32_t other : conflicts)
+			{
+				const auto& otherImage = m_Images[other];
+
+				if (offset + image.Requirements.Size <= otherImage.Offset)
+				{
+					break;
+				}
+
+				offset = std::max(offset, AlignUp(otherImage.Offset + otherImage.Requirements.Size, image.Requirements.Alignment));
+			}
+
+			image.Offset = offset;
+			memorySize = std::max(memorySize, offset + image.Requirements.Size);
+			memoryTypeBits &= image.Requirements.MemoryTypeBits;
+			m_UnaliasedMemorySize += image.Requirements.Size;
+
+			placed.push_back(index);
+		}
+
+		// The image that used the memory last within the frame has to be done with it before the next image takes over
+		for (uint32_t index : transients)
+		{
+			auto& image = m_Images[index];
+			uint32_t previousLastPass = 0;
+
+			for (uint32_t other : transients)
+			{
+				const auto& otherImage = m_Images[other];
+
+				bool overlapsMemory = otherImage.Offset < image.Offset + image.Requirements.Size && image.Offset < otherImage.Offset + otherImage.Requirements.Size;
+
+				if (overlapsMemory && otherImage.LastPass < image.FirstPass && otherImage.LastPass >= previousLastPass)
+				{
+					image.AliasedFrom = other;
+					previousLastPass = otherImage.LastPass;
+				}
+			}
+		}
+
+		if (transients.empty())
+		{
+			return;
+		}
+
+		// Growing the memory invalidates every image placed in it, they're destroyed once the GPU is done with the last frame
+		if (!m_Memory || memorySize > m_MemorySize || (memoryTypeBits & m_MemoryTypeBits) != m_MemoryTypeBits)
+		{
+			RetiredResources retired = { .FenceValue = fence.GetValue(), .Memory = m_Memory };
+
+			for (auto& transient : m_TransientImages)
+			{
+				retired.Images.push_back(transient.Resource);
+			}
+
+			if (retired.Memory || !retired.Images.empty())
+			{
+				m_RetiredResources.push_back(std::move(retired));
+			}
+
+			m_TransientImages.clear();
+
+			m_Memory = AliasingMemory::Create(m_Context, memorySize, memoryTypeBits);
+			m_MemorySize = memorySize;
+			m_MemoryTypeBits = memoryTypeBits;
+		}
+
+		for (auto& transient : m_TransientImages)
+		{
+			transient.IsUsed = false;
+		}
+
+		for (uint32_t index : transients)
+		{
+			auto& image = m_Images[index];
+
+			auto it = std::ranges::find_if(m_TransientImages, [&](const TransientImage& transient)
+			{
+				return !transient.IsUsed &&
+					   transient.Offset == image.Offset &&
+					   transient.Usage == image.Usage &&
+					   transient.Config.Width == image.Config.Width &&
+					   transient.Config.Height == image.Config.Height &&
+					   transient.Config.Format == image.Config.Format;
+			});
+
+			if (it != m_TransientImages.end())
+			{
+				it->IsUsed = true;
+				image.Physical = it->Resource;
+				continue;
+			}
+
+			image.Physical = Image::CreateAliased(m_Context, {
+				.Width = image.Config.Width,
+				.Height = image.Config.Height,
+				.Format = image.Config.Format,
+				.Usage = image.Usage,
+				.CreateDefaultView = true,
+				.Category = MemoryCategory::RenderTargets,
+			}, m_Memory, image.Offset);
+
+			m_TransientImages.push_back({ image.Config, image.Usage, image.Offset, image.Physical, true });
+		}
+
+		// Images the graph stopped using may still be in use by the last frame
+		RetiredResources retired = { .FenceValue = fence.GetValue() };
+
+		std::erase_if(m_TransientImages, [&](const TransientImage& transient)
+		{
+			if (!transient.IsUsed)
+			{
+				retired.Images.push_back(transient.Resource);
+			}
+
+			return !transient.IsUsed;
+		});
+
+		if (!retired.Images.empty())
+		{
+			m_RetiredResources.push_back(std::move(retired));
+		}
+	}
+
+	void RenderGraph::Execute(CommandList commandList, Fence fence)
+	{
+		DestroyRetiredResources(fence);
+
+		CullPasses();
+		AllocateTransientImages(fence);
+
+		for (uint32_t passIndex = 0; passIndex < m_Passes.size(); passIndex++)
+		{
+			const auto& pass = m_Passes[passIndex];
+
+			if (pass.IsCulled)
+			{
+				continue;
+			}
+
+			AuraStackPoint();
+
+			uint32_t imageBarrierCount = static_cast<uint32_t>(pass.ImageUses.size());
+			auto imageBarriers = Aura::StackAlloc<ImageBarrier>(imageBarrierCount);
+			for (uint32_t i = 0; i < imageBarrierCount; i++)
+			{
+				const auto& use = pass.ImageUses[i];
+				const auto& image = m_Images[use.Index];
+
+				// Transients never carry anything over from the previous frame
+				bool firstUse = !image.IsImported && image.FirstPass == passIndex;
+
+				imageBarriers[i] = {
+					.Target = image.Physical,
+					.Access = use.Access,
+					.Discard = firstUse,
+					.AliasedFrom = firstUse && image.AliasedFrom != ~0u ? m_Images[image.AliasedFrom].Physical : Image{},
+				};
+			}
+
+			uint32_t bufferBarrierCount = static_cast<uint32_t>(pass.BufferUses.size());
+			auto bufferBarriers = Aura::StackAlloc<BufferBarrier>(bufferBarrierCount);
+			for (uint32_t i = 0; i < bufferBarrierCount; i++)
+			{
+				const auto& use = pass.BufferUses[i];
+				bufferBarriers[i] = { m_Buffers[use.Index], use.Access };
+			}
+
+			GPUProfileScope scope(m_Profiler, commandList, pass.Name);
+			commandList.Barrier({ imageBarriers.Data(), imageBarrierCount }, { bufferBarriers.Data(), bufferBarrierCount });
+			pass.Execute(commandList, *this);
+		}
+
+		{
+			AuraStackPoint();
+
+			auto finalBarriers = Aura::StackAlloc<ImageBarrier>(static_cast<uint32_t>(m_Images.size()));
+			uint32_t finalBarrierCount = 0;
+
+			for (const auto& image : m_Images)
+			{
+				if (image.IsImported && image.FinalAccess != ResourceAccess::None)
+				{
+					finalBarriers[finalBarrierCount++] = { image.Physical, image.FinalAccess };
+				}
+			}
+
+			if (finalBarrierCount > 0)
+			{
+				commandList.Barrier({ finalBarriers.Data(), finalBarrierCount });
+			}
+		}
+
+		m_Passes.clear();
+		m_Images.clear();
+		m_Buffers.clear();
+	}
+
+	void RenderGraph::DestroyRetiredResources(Fence fence)
+	{
+		uint64_t completedValue = fence.GetCurrentValue();
+
+		std::erase_if(m_RetiredResources, [&](RetiredResources& retired)
+		{
+			if (retired.FenceValue > completedValue)
+			{
+				return false;
+			}
+
+			for (auto image : retired.Images)
+			{
+				image.Destroy();
+			}
+
+			if (retired.Memory)
+			{
+				retired.Memory.Destroy();
+			}
+
+			return true;
+		});
+	}
+
+}
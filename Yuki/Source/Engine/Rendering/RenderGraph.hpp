@@ -0,0 +1,183 @@
+#pragma once
+
+#include "GPUProfiler.hpp"
+
+#include "Engine/RHI/RHI.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Yuki {
+
+	// NOTE(Peter): Graph resource handles are only valid until the next call to RenderGraph::Execute
+	struct RenderGraphImage
+	{
+		uint32_t Index = ~0u;
+
+		bool IsValid() const { return Index != ~0u; }
+	};
+
+	struct RenderGraphBuffer
+	{
+		uint32_t Index = ~0u;
+
+		bool IsValid() const { return Index != ~0u; }
+	};
+
+	// The usage of transient images is inferred from how passes access them
+	struct RenderGraphImageConfig
+	{
+		uint32_t Width;
+		uint32_t Height;
+		ImageFormat Format;
+	};
+
+	class RenderGraph;
+
+	class RenderGraphPassBuilder
+	{
+	public:
+		// A write doesn't preserve what earlier passes wrote, passes that build on the previous contents have to read the resource as well
+		void Read(RenderGraphImage image, ResourceAccess access);
+		void Write(RenderGraphImage image, ResourceAccess access);
+		void Read(RenderGraphBuffer buffer, ResourceAccess access);
+		void Write(RenderGraphBuffer buffer, ResourceAccess access);
+
+		// Keeps the pass even if no other pass reads what it writes
+		void SetSideEffects();
+
+	private:
+		RenderGraphPassBuilder(RenderGraph& graph, uint32_t passIndex)
+			: m_Graph(graph), m_PassIndex(passIndex) {}
+
+	private:
+		RenderGraph& m_Graph;
+		uint32_t m_PassIndex;
+
+		friend class RenderGraph;
+	};
+
+	// Passes are added every frame and declare which images and buffers they use. Executing the graph culls passes
+	// whose results are never used, inserts the barriers between passes and places transient images whose lifetimes
+	// don't overlap in the same memory. Imported resources are visible outside of the graph, so passes writing them are never culled.
+	class RenderGraph
+	{
+	public:
+		using SetupFunc = std::function<void(RenderGraphPassBuilder&)>;
+		using ExecuteFunc = std::function<void(CommandList, const RenderGraph&)>;
+
+		RenderGraph() = default;
+		explicit RenderGraph(RHIContext context);
+
+		// The GPU has to be done with every command list the graph recorded
+		void Destroy();
+
+		// finalAccess is the access the image is left in after the graph has executed, None leaves it in whatever the last pass used
+		RenderGraphImage ImportImage(Image image, ResourceAccess finalAccess = ResourceAccess::None);
+		RenderGraphBuffer ImportBuffer(Buffer buffer);
+
+		RenderGraphImage CreateImage(const RenderGraphImageConfig& config);
+
+		// setup is called immediately, execute is called from Execute if the pass wasn't culled
+		void AddPass(std::string_view name, const SetupFunc& setup, ExecuteFunc execute);
+
+		// Records every pass added since the last call into commandList and starts a new frame. Transient images the graph
+		// stopped using are destroyed once fence has reached its current value, so the command list of the previous call
+		// has to have been submitted signalling fence before this is called again.
+		void Execute(CommandList commandList, Fence fence);
+
+		// Only valid from inside a pass
+		Image GetImage(RenderGraphImage image) const;
+		Buffer GetBuffer(RenderGraphBuffer buffer) const;
+
+		// Every executed pass is recorded in a scope named after it
+		void SetProfiler(GPUProfiler* profiler) { m_Profiler = profiler; }
+
+		uint32_t GetCulledPassCount() const { return m_CulledPassCount; }
+
+		// Size of the memory the transient images are placed in, and what they would've needed without aliasing
+		uint64_t GetTransientMemorySize() const { return m_MemorySize; }
+		uint64_t GetUnaliasedTransientMemorySize() const { return m_UnaliasedMemorySize; }
+
+	private:
+		struct ResourceUse
+		{
+			uint32_t Index;
+			ResourceAccess Access;
+			bool IsWrite;
+		};
+
+		struct Pass
+		{
+			std::string Name;
+			ExecuteFunc Execute;
+			std::vector<ResourceUse> ImageUses;
+			std::vector<ResourceUse> BufferUses;
+			bool HasSideEffects = false;
+			bool IsCulled = false;
+		};
+
+		struct ImageResource
+		{
+			Image Physical;
+			bool IsImported;
+			ResourceAccess FinalAccess = ResourceAccess::None;
+
+			// Transient images only
+			RenderGraphImageConfig Config;
+			ImageUsage Usage{};
+			ImageMemoryRequirements Requirements;
+			uint32_t FirstPass = ~0u;
+			uint32_t LastPass = 0;
+			uint64_t Offset = 0;
+
+			// The transient image that last used this image's memory earlier in the frame
+			uint32_t AliasedFrom = ~0u;
+		};
+
+		struct TransientImage
+		{
+			RenderGraphImageConfig Config;
+			ImageUsage Usage;
+			uint64_t Offset;
+			Image Resource;
+			bool IsUsed;
+		};
+
+		struct RetiredResources
+		{
+			uint64_t FenceValue;
+			AliasingMemory Memory;
+			std::vector<Image> Images;
+		};
+
+	private:
+		void CullPasses();
+		void AllocateTransientImages(Fence fence);
+		void DestroyRetiredResources(Fence fence);
+
+	private:
+		RHIContext m_Context;
+
+		std::vector<Pass> m_Passes;
+		std::vector<ImageResource> m_Images;
+		std::vector<Buffer> m_Buffers;
+
+		AliasingMemory m_Memory;
+		uint64_t m_MemorySize = 0;
+		uint64_t m_UnaliasedMemorySize = 0;
+		uint32_t m_MemoryTypeBits = 0;
+
+		// Kept between frames so a graph with the same shape doesn't create any images
+		std::vector<TransientImage> m_TransientImages;
+		std::vector<RetiredResources> m_RetiredResources;
+
+		uint32_t m_CulledPassCount = 0;
+
+		GPUProfiler* m_Profiler = nullptr;
+
+		friend class RenderGraphPassBuilder;
+	};
+
+}
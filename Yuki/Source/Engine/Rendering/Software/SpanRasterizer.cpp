@@ -0,0 +1,126 @@
+#include "SpanRasterizer.hpp"
+
+#include "Engine/Core/CPUFeatures.hpp"
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+	#include <arm_neon.h>
+#endif
+
+namespace Yuki {
+
+	void RasterizeSpanScalar(const RasterTriangle& triangle, int32_t y, int32_t xBegin, int32_t xEnd, uint32_t* colorRow, float32_t* depthRow)
+	{
+		float32_t pixelY = triangle.GetPixelY(y);
+
+		for (int32_t x = xBegin; x < xEnd; x++)
+		{
+			float32_t pixelX = triangle.GetPixelX(x);
+
+			if (!triangle.Covers(pixelX, pixelY))
+			{
+				continue;
+			}
+
+			float32_t depth = triangle.Depth.Evaluate(pixelX, pixelY);
+
+			if (depth < 0.0f || depth > depthRow[x])
+			{
+				continue;
+			}
+
+			depthRow[x] = depth;
+			colorRow[x] = triangle.Shade(pixelX, pixelY);
+		}
+	}
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+	void RasterizeSpanNEON(const RasterTriangle& triangle, int32_t y, int32_t xBegin, int32_t xEnd, uint32_t* colorRow, float32_t* depthRow)
+	{
+		static constexpr float32_t LaneOffsets[] = { 0.5f, 1.5f, 2.5f, 3.5f };
+
+		float32_t pixelY = triangle.GetPixelY(y);
+
+		const float32x4_t laneOffsets = vld1q_f32(LaneOffsets);
+		const float32x4_t zero = vdupq_n_f32(0.0f);
+		const float32x4_t originX = vdupq_n_f32(triangle.OriginX);
+
+		float32x4_t edgeA[3];
+		float32x4_t edgeRow[3];
+		uint32x4_t topLeft[3];
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			edgeA[i] = vdupq_n_f32(triangle.Edges[i].A);
+			edgeRow[i] = vdupq_n_f32(triangle.Edges[i].B * pixelY + triangle.Edges[i].C);
+			topLeft[i] = vdupq_n_u32(triangle.IsTopLeft[i] ? ~0u : 0u);
+		}
+
+		const float32x4_t depthA = vdupq_n_f32(triangle.Depth.A);
+		const float32x4_t depthRowBase = vdupq_n_f32(triangle.Depth.B * pixelY + triangle.Depth.C);
+		const uint32x4_t color = vdupq_n_u32(triangle.Color);
+
+		int32_t x = xBegin;
+
+		for (; x + 4 <= xEnd; x += 4)
+		{
+			float32x4_t pixelX = vsubq_f32(vaddq_f32(vdupq_n_f32(static_cast<float32_t>(x)), laneOffsets), originX);
+
+			uint32x4_t mask = vdupq_n_u32(~0u);
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				float32x4_t edge = vaddq_f32(vmulq_f32(edgeA[i], pixelX), edgeRow[i]);
+				uint32x4_t covered = vorrq_u32(vcgtq_f32(edge, zero), vandq_u32(vceqq_f32(edge, zero), topLeft[i]));
+				mask = vandq_u32(mask, covered);
+			}
+
+			float32x4_t depth = vaddq_f32(vmulq_f32(depthA, pixelX), depthRowBase);
+			float32x4_t storedDepth = vld1q_f32(depthRow + x);
+			mask = vandq_u32(mask, vandq_u32(vcleq_f32(depth, storedDepth), vcgeq_f32(depth, zero)));
+
+			if (vmaxvq_u32(mask) == 0)
+			{
+				continue;
+			}
+
+			vst1q_f32(depthRow + x, vbslq_f32(mask, depth, storedDepth));
+
+			if (!triangle.Texture)
+			{
+				vst1q_u32(colorRow + x, vbslq_u32(mask, color, vld1q_u32(colorRow + x)));
+				continue;
+			}
+
+			alignas(16) uint32_t laneMask[4];
+			vst1q_u32(laneMask, mask);
+
+			for (int32_t lane = 0; lane < 4; lane++)
+			{
+				if (laneMask[lane])
+				{
+					colorRow[x + lane] = triangle.Shade(triangle.GetPixelX(x + lane), pixelY);
+				}
+			}
+		}
+
+		RasterizeSpanScalar(triangle, y, x, xEnd, colorRow, depthRow);
+	}
+#endif
+
+	SpanRasterizerFunc SelectSpanRasterizer()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		if (IsAVX2Supported())
+		{
+			return RasterizeSpanAVX2;
+		}
+#endif
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+		return RasterizeSpanNEON;
+#else
+		return RasterizeSpanScalar;
+#endif
+	}
+
+}
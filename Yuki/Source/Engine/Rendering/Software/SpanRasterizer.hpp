@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Engine/Core/Core.hpp"
+
+namespace Yuki {
+
+	struct SoftwareTexture
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+
+		// RGBA8, row-major
+		std::vector<uint32_t> Pixels;
+	};
+
+	// Screen-space plane equation, evaluated relative to the triangles origin
+	struct RasterPlane
+	{
+		float32_t A = 0.0f;
+		float32_t B = 0.0f;
+		float32_t C = 0.0f;
+
+		// NOTE(Peter): The SIMD rasterizers compute (B * y + C) once per row, keep this in sync with that
+		float32_t Evaluate(float32_t x, float32_t y) const { return A * x + (B * y + C); }
+	};
+
+	struct RasterTriangle
+	{
+		// All planes are evaluated at (pixelX + 0.5 - OriginX, pixelY + 0.5 - OriginY), keeping the values small
+		// enough that axis-aligned edges are evaluated exactly
+		float32_t OriginX;
+		float32_t OriginY;
+
+		// A pixel is covered if all three edges are > 0, or == 0 for top-left edges (matching the Vulkan fill rule)
+		RasterPlane Edges[3];
+		bool IsTopLeft[3];
+
+		RasterPlane Depth;
+
+		// Perspective-correct texture coordinates
+		RasterPlane UOverW;
+		RasterPlane VOverW;
+		RasterPlane OneOverW;
+
+		uint32_t Color;
+		const SoftwareTexture* Texture = nullptr;
+
+		// Inclusive pixel bounds, already clamped to the framebuffer
+		int32_t MinX, MinY;
+		int32_t MaxX, MaxY;
+
+		float32_t GetPixelX(int32_t x) const { return (static_cast<float32_t>(x) + 0.5f) - OriginX; }
+		float32_t GetPixelY(int32_t y) const { return (static_cast<float32_t>(y) + 0.5f) - OriginY; }
+
+		bool Covers(float32_t x, float32_t y) const
+		{
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				float32_t edge = Edges[i].Evaluate(x, y);
+
+				if (edge < 0.0f || (edge == 0.0f && !IsTopLeft[i]))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Nearest filtering with repeat wrapping, same as the BatchRenderer's default sampler
+		uint32_t Shade(float32_t x, float32_t y) const
+		{
+			if (!Texture)
+			{
+				return Color;
+			}
+
+			if (Texture->Pixels.empty())
+			{
+				// Missing texture data, make it stand out
+				return 0xFFFF00FF;
+			}
+
+			float32_t w = 1.0f / OneOverW.Evaluate(x, y);
+			float32_t u = UOverW.Evaluate(x, y) * w;
+			float32_t v = VOverW.Evaluate(x, y) * w;
+
+			u -= std::floor(u);
+			v -= std::floor(v);
+
+			uint32_t texelX = std::min(static_cast<uint32_t>(u * Texture->Width), Texture->Width - 1);
+			uint32_t texelY = std::min(static_cast<uint32_t>(v * Texture->Height), Texture->Height - 1);
+			return Texture->Pixels[texelY * Texture->Width + texelX];
+		}
+	};
+
+	// Rasterizes the pixels in [xBegin, xEnd) of row y, depth testing (less or equal, clear value 1) and writing color and depth
+	using SpanRasterizerFunc = void(*)(const RasterTriangle& triangle, int32_t y, int32_t xBegin, int32_t xEnd, uint32_t* colorRow, float32_t* depthRow);
+
+	void RasterizeSpanScalar(const RasterTriangle& triangle, int32_t y, int32_t xBegin, int32_t xEnd, uint32_t* colorRow, float32_t* depthRow);
+
+#if defined(_M_X64) || defined(__x86_64__)
+	void RasterizeSpanAVX2(const RasterTriangle& triangle, int32_t y, int32_t xBegin, int32_t xEnd, uint32_t* colorRow, float32_t* depthRow);
+#endif
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+	void RasterizeSpanNEON(const RasterTriangle& triangle, int32_t y, int32_t xBegin, int32_t xEnd, uint32_t* colorRow, float32_t* depthRow);
+#endif
+
+	// Picks the widest implementation the current CPU supports
+	SpanRasterizerFunc SelectSpanRasterizer();
+
+}
@@ -0,0 +1,88 @@
+#include "SpanRasterizer.hpp"
+
+// NOTE(Peter): This file is compiled with AVX2 enabled, nothing in here may be called
+//				unless SelectSpanRasterizer has verified that the CPU supports it
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+namespace Yuki {
+
+	void RasterizeSpanAVX2(const RasterTriangle& triangle, int32_t y, int32_t xBegin, int32_t xEnd, uint32_t* colorRow, float32_t* depthRow)
+	{
+		float32_t pixelY = triangle.GetPixelY(y);
+
+		const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 originX = _mm256_set1_ps(triangle.OriginX);
+
+		__m256 edgeA[3];
+		__m256 edgeRow[3];
+		__m256 topLeft[3];
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			edgeA[i] = _mm256_set1_ps(triangle.Edges[i].A);
+			edgeRow[i] = _mm256_set1_ps(triangle.Edges[i].B * pixelY + triangle.Edges[i].C);
+			topLeft[i] = _mm256_castsi256_ps(_mm256_set1_epi32(triangle.IsTopLeft[i] ? -1 : 0));
+		}
+
+		const __m256 depthA = _mm256_set1_ps(triangle.Depth.A);
+		const __m256 depthRowBase = _mm256_set1_ps(triangle.Depth.B * pixelY + triangle.Depth.C);
+		const __m256 color = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int32_t>(triangle.Color)));
+
+		int32_t x = xBegin;
+
+		for (; x + 8 <= xEnd; x += 8)
+		{
+			// NOTE(Peter): No FMA here, the results have to match the scalar path exactly
+			__m256 pixelX = _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float32_t>(x)), laneOffsets), originX);
+
+			__m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				__m256 edge = _mm256_add_ps(_mm256_mul_ps(edgeA[i], pixelX), edgeRow[i]);
+				__m256 covered = _mm256_or_ps(
+					_mm256_cmp_ps(edge, zero, _CMP_GT_OQ),
+					_mm256_and_ps(_mm256_cmp_ps(edge, zero, _CMP_EQ_OQ), topLeft[i])
+				);
+				mask = _mm256_and_ps(mask, covered);
+			}
+
+			__m256 depth = _mm256_add_ps(_mm256_mul_ps(depthA, pixelX), depthRowBase);
+			__m256 storedDepth = _mm256_loadu_ps(depthRow + x);
+			mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(depth, storedDepth, _CMP_LE_OQ), _mm256_cmp_ps(depth, zero, _CMP_GE_OQ)));
+
+			int32_t laneMask = _mm256_movemask_ps(mask);
+
+			if (laneMask == 0)
+			{
+				continue;
+			}
+
+			_mm256_storeu_ps(depthRow + x, _mm256_blendv_ps(storedDepth, depth, mask));
+
+			if (!triangle.Texture)
+			{
+				auto* colorPtr = reinterpret_cast<float32_t*>(colorRow + x);
+				_mm256_storeu_ps(colorPtr, _mm256_blendv_ps(_mm256_loadu_ps(colorPtr), color, mask));
+				continue;
+			}
+
+			for (int32_t lane = 0; lane < 8; lane++)
+			{
+				if (laneMask & (1 << lane))
+				{
+					colorRow[x + lane] = triangle.Shade(triangle.GetPixelX(x + lane), pixelY);
+				}
+			}
+		}
+
+		RasterizeSpanScalar(triangle, y, x, xEnd, colorRow, depthRow);
+	}
+
+}
+
+#endif
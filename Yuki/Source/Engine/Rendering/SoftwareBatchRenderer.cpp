@@ -0,0 +1,300 @@
+#include "SoftwareBatchRenderer.hpp"
+#include "GeometryBatchImpl.hpp"
+
+#include <rtmcpp/PackedMatrix.hpp>
+#include <cstring>
+
+namespace Yuki {
+
+	static constexpr uint32_t TileSize = 64;
+
+	// PackUnorm4x8(0.1, 0.1, 0.1, 1.0), same as the clear color used by CommandList::BeginRendering
+	static constexpr uint32_t ClearColor = 0xFF1A1A1A;
+
+	// Vertices are snapped to 1/256th of a pixel, same as the sub-pixel precision of most GPUs
+	static constexpr float32_t SubPixelScale = 256.0f;
+
+	struct ScreenVertex
+	{
+		float32_t X;
+		float32_t Y;
+		float32_t Z;
+		float32_t InvW;
+		float32_t UOverW;
+		float32_t VOverW;
+	};
+
+	static RasterPlane MakeAttributePlane(const ScreenVertex (&vertices)[3], float32_t a0, float32_t a1, float32_t a2, float32_t invDeterminant)
+	{
+		float32_t dx1 = vertices[1].X - vertices[0].X;
+		float32_t dy1 = vertices[1].Y - vertices[0].Y;
+		float32_t dx2 = vertices[2].X - vertices[0].X;
+		float32_t dy2 = vertices[2].Y - vertices[0].Y;
+
+		float32_t da1 = a1 - a0;
+		float32_t da2 = a2 - a0;
+
+		return {
+			.A = (da1 * dy2 - da2 * dy1) * invDeterminant,
+			.B = (da2 * dx1 - da1 * dx2) * invDeterminant,
+			.C = a0
+		};
+	}
+
+	static bool SetupTriangle(const ScreenVertex (&vertices)[3], uint32_t width, uint32_t height, RasterTriangle& triangle)
+	{
+		float32_t determinant = (vertices[1].X - vertices[0].X) * (vertices[2].Y - vertices[0].Y) - (vertices[2].X - vertices[0].X) * (vertices[1].Y - vertices[0].Y);
+
+		if (determinant == 0.0f)
+		{
+			return false;
+		}
+
+		float32_t minX = std::min({ vertices[0].X, vertices[1].X, vertices[2].X });
+		float32_t minY = std::min({ vertices[0].Y, vertices[1].Y, vertices[2].Y });
+		float32_t maxX = std::max({ vertices[0].X, vertices[1].X, vertices[2].X });
+		float32_t maxY = std::max({ vertices[0].Y, vertices[1].Y, vertices[2].Y });
+
+		// Only pixels whose centre lies within the bounds can be covered
+		triangle.MinX = std::max(static_cast<int32_t>(std::ceil(minX - 0.5f)), 0);
+		triangle.MinY = std::max(static_cast<int32_t>(std::ceil(minY - 0.5f)), 0);
+		triangle.MaxX = std::min(static_cast<int32_t>(std::floor(maxX - 0.5f)), static_cast<int32_t>(width) - 1);
+		triangle.MaxY = std::min(static_cast<int32_t>(std::floor(maxY - 0.5f)), static_cast<int32_t>(height) - 1);
+
+		if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+		{
+			return false;
+		}
+
+		triangle.OriginX = vertices[0].X;
+		triangle.OriginY = vertices[0].Y;
+
+		// Cull mode is none, so flip the edges of clockwise triangles to keep the interior positive
+		float32_t orientation = determinant > 0.0f ? -1.0f : 1.0f;
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			const auto& from = vertices[i];
+			const auto& to = vertices[(i + 1) % 3];
+
+			auto& edge = triangle.Edges[i];
+			edge.A = (to.Y - from.Y) * orientation;
+			edge.B = (from.X - to.X) * orientation;
+			edge.C = edge.A * (triangle.OriginX - from.X) + edge.B * (triangle.OriginY - from.Y);
+
+			triangle.IsTopLeft[i] = edge.A > 0.0f || (edge.A == 0.0f && edge.B > 0.0f);
+		}
+
+		float32_t invDeterminant = 1.0f / determinant;
+		triangle.Depth = MakeAttributePlane(vertices, vertices[0].Z, vertices[1].Z, vertices[2].Z, invDeterminant);
+		triangle.OneOverW = MakeAttributePlane(vertices, vertices[0].InvW, vertices[1].InvW, vertices[2].InvW, invDeterminant);
+		triangle.UOverW = MakeAttributePlane(vertices, vertices[0].UOverW, vertices[1].UOverW, vertices[2].UOverW, invDeterminant);
+		triangle.VOverW = MakeAttributePlane(vertices, vertices[0].VOverW, vertices[1].VOverW, vertices[2].VOverW, invDeterminant);
+
+		return true;
+	}
+
+	SoftwareBatchRenderer::SoftwareBatchRenderer()
+	{
+		m_RasterizeSpan = SelectSpanRasterizer();
+	}
+
+	GeometryBatch SoftwareBatchRenderer::NewBatch()
+	{
+		auto* batch = new GeometryBatch::Impl();
+		m_Batches.push_back({ batch });
+		return { batch };
+	}
+
+	void SoftwareBatchRenderer::Render(const rtmcpp::Mat4& viewProjection)
+	{
+		if (m_Width == 0 || m_Height == 0)
+		{
+			return;
+		}
+
+		SetupTriangles(viewProjection);
+		BinTriangles();
+
+		m_ThreadPool.ParallelFor(m_TilesX * m_TilesY, [this](uint32_t tileIndex)
+		{
+			RasterizeTile(tileIndex);
+		});
+	}
+
+	void SoftwareBatchRenderer::SetSize(uint32_t width, uint32_t height)
+	{
+		m_Width = width;
+		m_Height = height;
+
+		m_ColorBuffer.assign(static_cast<size_t>(width) * height, ClearColor);
+		m_DepthBuffer.assign(static_cast<size_t>(width) * height, 1.0f);
+
+		m_TilesX = (width + TileSize - 1) / TileSize;
+		m_TilesY = (height + TileSize - 1) / TileSize;
+		m_TileBins.resize(static_cast<size_t>(m_TilesX) * m_TilesY);
+	}
+
+	void SoftwareBatchRenderer::SetTextureData(Image image, uint32_t width, uint32_t height, std::vector<uint32_t> pixels)
+	{
+		YukiAssert(pixels.size() == static_cast<size_t>(width) * height);
+
+		m_Textures[image.GetID()] = {
+			.Width = width,
+			.Height = height,
+			.Pixels = std::move(pixels)
+		};
+	}
+
+	void SoftwareBatchRenderer::SetupTriangles(const rtmcpp::Mat4& viewProjection)
+	{
+		// Read the matrix the same way the shaders do (column-major)
+		rtmcpp::PackedMat4 packedMatrix = viewProjection;
+		float32_t matrix[4][4];
+		static_assert(sizeof(packedMatrix) == sizeof(matrix));
+		memcpy(matrix, &packedMatrix, sizeof(matrix));
+
+		m_Triangles.clear();
+
+		// Same draw order as the BatchRenderer, front-to-back
+		for (auto batch : m_Batches)
+		{
+			if (batch->IsDirty)
+			{
+				batch->SortQuadsFrontToBack();
+				batch->IsDirty = false;
+			}
+		}
+
+		std::vector<GeometryBatch> drawOrder = m_Batches;
+		std::ranges::stable_sort(drawOrder, {}, [](const GeometryBatch& batch) { return batch->GetNearestDepth(); });
+
+		std::vector<const SoftwareTexture*> batchTextures;
+
+		for (auto batch : drawOrder)
+		{
+			batchTextures.clear();
+
+			for (auto image : batch->Images)
+			{
+				auto it = m_Textures.find(image.GetID());
+				batchTextures.push_back(it != m_Textures.end() ? &it->second : &m_MissingTexture);
+			}
+
+			for (size_t i = 0; i + 2 < batch->Indices.size(); i += 3)
+			{
+				ScreenVertex screenVertices[3];
+				bool behindCamera = false;
+
+				for (uint32_t j = 0; j < 3; j++)
+				{
+					const auto& vertex = batch->Vertices[batch->Indices[i + j]];
+
+					float32_t clip[4];
+					for (uint32_t row = 0; row < 4; row++)
+					{
+						clip[row] = matrix[0][row] * vertex.Position.X + matrix[1][row] * vertex.Position.Y + matrix[3][row];
+					}
+
+					// NOTE(Peter): We don't clip against the near plane, the batch renderer only deals with 2D projections
+					if (clip[3] <= 0.0f)
+					{
+						behindCamera = true;
+						break;
+					}
+
+					float32_t invW = 1.0f / clip[3];
+					float32_t screenX = (clip[0] * invW * 0.5f + 0.5f) * static_cast<float32_t>(m_Width);
+					float32_t screenY = (clip[1] * invW * 0.5f + 0.5f) * static_cast<float32_t>(m_Height);
+
+					screenVertices[j] = {
+						.X = std::round(screenX * SubPixelScale) / SubPixelScale,
+						.Y = std::round(screenY * SubPixelScale) / SubPixelScale,
+						.Z = vertex.Depth,
+						.InvW = invW,
+						.UOverW = vertex.UV.X * invW,
+						.VOverW = vertex.UV.Y * invW,
+					};
+				}
+
+				if (behindCamera)
+				{
+					continue;
+				}
+
+				RasterTriangle triangle;
+
+				if (!SetupTriangle(screenVertices, m_Width, m_Height, triangle))
+				{
+					continue;
+				}
+
+				// Quads are uniformly colored / textured, so we can take everything from the provoking vertex
+				const auto& provokingVertex = batch->Vertices[batch->Indices[i]];
+				triangle.Color = provokingVertex.Color;
+				triangle.Texture = provokingVertex.Texture != ~0u ? batchTextures[provokingVertex.Texture] : nullptr;
+
+				m_Triangles.push_back(triangle);
+			}
+		}
+	}
+
+	void SoftwareBatchRenderer::BinTriangles()
+	{
+		for (auto& bin : m_TileBins)
+		{
+			bin.clear();
+		}
+
+		for (uint32_t i = 0; i < m_Triangles.size(); i++)
+		{
+			const auto& triangle = m_Triangles[i];
+
+			uint32_t firstTileX = static_cast<uint32_t>(triangle.MinX) / TileSize;
+			uint32_t firstTileY = static_cast<uint32_t>(triangle.MinY) / TileSize;
+			uint32_t lastTileX = static_cast<uint32_t>(triangle.MaxX) / TileSize;
+			uint32_t lastTileY = static_cast<uint32_t>(triangle.MaxY) / TileSize;
+
+			for (uint32_t tileY = firstTileY; tileY <= lastTileY; tileY++)
+			{
+				for (uint32_t tileX = firstTileX; tileX <= lastTileX; tileX++)
+				{
+					m_TileBins[tileY * m_TilesX + tileX].push_back(i);
+				}
+			}
+		}
+	}
+
+	void SoftwareBatchRenderer::RasterizeTile(uint32_t tileIndex)
+	{
+		auto tileMinX = static_cast<int32_t>((tileIndex % m_TilesX) * TileSize);
+		auto tileMinY = static_cast<int32_t>((tileIndex / m_TilesX) * TileSize);
+		auto tileMaxX = std::min(tileMinX + static_cast<int32_t>(TileSize), static_cast<int32_t>(m_Width)) - 1;
+		auto tileMaxY = std::min(tileMinY + static_cast<int32_t>(TileSize), static_cast<int32_t>(m_Height)) - 1;
+
+		for (int32_t y = tileMinY; y <= tileMaxY; y++)
+		{
+			size_t rowOffset = static_cast<size_t>(y) * m_Width;
+			std::fill_n(m_ColorBuffer.data() + rowOffset + tileMinX, tileMaxX - tileMinX + 1, ClearColor);
+			std::fill_n(m_DepthBuffer.data() + rowOffset + tileMinX, tileMaxX - tileMinX + 1, 1.0f);
+		}
+
+		// Triangles were binned in draw order, so depth ties resolve the same way they do on the GPU
+		for (uint32_t triangleIndex : m_TileBins[tileIndex])
+		{
+			const auto& triangle = m_Triangles[triangleIndex];
+
+			int32_t minX = std::max(tileMinX, triangle.MinX);
+			int32_t maxX = std::min(tileMaxX, triangle.MaxX);
+			int32_t minY = std::max(tileMinY, triangle.MinY);
+			int32_t maxY = std::min(tileMaxY, triangle.MaxY);
+
+			for (int32_t y = minY; y <= maxY; y++)
+			{
+				size_t rowOffset = static_cast<size_t>(y) * m_Width;
+				m_RasterizeSpan(triangle, y, minX, maxX + 1, m_ColorBuffer.data() + rowOffset, m_DepthBuffer.data() + rowOffset);
+			}
+		}
+	}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "GeometryBatch.hpp"
+#include "Software/SpanRasterizer.hpp"
+
+#include "Engine/Core/ThreadPool.hpp"
+
+#include <rtmcpp/Matrix.hpp>
+
+namespace Yuki {
+
+	// CPU implementation of the BatchRenderer, rasterizes batches straight into a RGBA8 framebuffer.
+	// Follows the same conventions as the batch shaders: clip = ViewProjection * vec4(Position, 0, 1) with
+	// clip.z = Depth * clip.w, less or equal depth test against a cleared value of 1, and nearest / repeat texture sampling.
+	class SoftwareBatchRenderer
+	{
+	public:
+		SoftwareBatchRenderer();
+
+		GeometryBatch NewBatch();
+
+		void Render(const rtmcpp::Mat4& viewProjection);
+
+		void SetSize(uint32_t width, uint32_t height);
+
+		// Textured quads look up their pixels (RGBA8, row-major) by image, the GPU image itself is never touched
+		void SetTextureData(Image image, uint32_t width, uint32_t height, std::vector<uint32_t> pixels);
+
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+
+		// RGBA8, row-major, GetWidth() * GetHeight() pixels
+		const std::vector<uint32_t>& GetFramebuffer() const { return m_ColorBuffer; }
+
+	private:
+		void SetupTriangles(const rtmcpp::Mat4& viewProjection);
+		void BinTriangles();
+		void RasterizeTile(uint32_t tileIndex);
+
+	private:
+		ThreadPool m_ThreadPool;
+		SpanRasterizerFunc m_RasterizeSpan = nullptr;
+
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+
+		std::vector<uint32_t> m_ColorBuffer;
+		std::vector<float32_t> m_DepthBuffer;
+
+		uint32_t m_TilesX = 0;
+		uint32_t m_TilesY = 0;
+		std::vector<std::vector<uint32_t>> m_TileBins;
+
+		std::vector<RasterTriangle> m_Triangles;
+		std::unordered_map<Image::ID, SoftwareTexture> m_Textures;
+		SoftwareTexture m_MissingTexture;
+
+		std::vector<GeometryBatch> m_Batches;
+	};
+
+}
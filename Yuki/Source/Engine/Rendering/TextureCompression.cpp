@@ -0,0 +1,481 @@
+#include "TextureCompression.hpp"
+
+#include <cstring>
+#include <numeric>
+
+namespace Yuki::TextureCompression {
+
+	// Fits a line through the pixels selected by mask and returns the points on it that the pixels project onto at the ends.
+	// inset pulls the ends towards each other by a fraction of their distance, trading the extremes for the colors in between
+	static void FitEndpoints(const uint8_t* block, uint32_t channels, uint32_t mask, float inset, float* start, float* end)
+	{
+		float mean[4] = {};
+		float minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+		float maximum[4] = {};
+		uint32_t count = 0;
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if ((mask & (1 << i)) == 0)
+			{
+				continue;
+			}
+
+			for (uint32_t c = 0; c < channels; c++)
+			{
+				float value = block[i * 4 + c];
+				mean[c] += value;
+				minimum[c] = std::min(minimum[c], value);
+				maximum[c] = std::max(maximum[c], value);
+			}
+
+			count++;
+		}
+
+		float axis[4] = {};
+		float axisLengthSq = 0.0f;
+
+		for (uint32_t c = 0; c < channels; c++)
+		{
+			mean[c] /= float(count);
+			axis[c] = maximum[c] - minimum[c];
+			axisLengthSq += axis[c] * axis[c];
+		}
+
+		// Every pixel has the same color
+		if (axisLengthSq == 0.0f)
+		{
+			std::copy_n(mean, channels, start);
+			std::copy_n(mean, channels, end);
+			return;
+		}
+
+		float covariance[4][4] = {};
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if ((mask & (1 << i)) == 0)
+			{
+				continue;
+			}
+
+			for (uint32_t row = 0; row < channels; row++)
+			{
+				for (uint32_t column = 0; column < channels; column++)
+				{
+					covariance[row][column] += (block[i * 4 + row] - mean[row]) * (block[i * 4 + column] - mean[column]);
+				}
+			}
+		}
+
+		// NOTE(Peter): A few rounds of power iteration starting from the bounding box diagonal is plenty to find the principal axis of 16 pixels
+		for (uint32_t iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float nextLengthSq = 0.0f;
+
+			for (uint32_t row = 0; row < channels; row++)
+			{
+				for (uint32_t column = 0; column < channels; column++)
+				{
+					next[row] += covariance[row][column] * axis[column];
+				}
+
+				nextLengthSq += next[row] * next[row];
+			}
+
+			if (nextLengthSq < 1e-12f)
+			{
+				break;
+			}
+
+			float scale = 1.0f / std::sqrt(nextLengthSq);
+			for (uint32_t c = 0; c < channels; c++)
+			{
+				axis[c] = next[c] * scale;
+			}
+		}
+
+		float length = std::sqrt(std::inner_product(axis, axis + channels, axis, 0.0f));
+		for (uint32_t c = 0; c < channels; c++)
+		{
+			axis[c] /= length;
+		}
+
+		float minT = std::numeric_limits<float>::max();
+		float maxT = std::numeric_limits<float>::lowest();
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if ((mask & (1 << i)) == 0)
+			{
+				continue;
+			}
+
+			float t = 0.0f;
+			for (uint32_t c = 0; c < channels; c++)
+			{
+				t += (block[i * 4 + c] - mean[c]) * axis[c];
+			}
+
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		float insetT = (maxT - minT) * inset;
+		minT += insetT;
+		maxT -= insetT;
+
+		for (uint32_t c = 0; c < channels; c++)
+		{
+			start[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+			end[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+		}
+	}
+
+	static uint16_t PackRGB565(const float* color)
+	{
+		uint32_t r = static_cast<uint32_t>(color[0] * (31.0f / 255.0f) + 0.5f);
+		uint32_t g = static_cast<uint32_t>(color[1] * (63.0f / 255.0f) + 0.5f);
+		uint32_t b = static_cast<uint32_t>(color[2] * (31.0f / 255.0f) + 0.5f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	static void UnpackRGB565(uint16_t packed, int32_t* color)
+	{
+		int32_t r = (packed >> 11) & 31;
+		int32_t g = (packed >> 5) & 63;
+		int32_t b = packed & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	// The color half of BC1 and BC3. BC3 always decodes the four color mode, so only BC1 can use the
+	// three color mode to mark pixels with less than half alpha as transparent
+	static void EncodeColorBlock(const uint8_t* block, bool allowTransparency, std::byte* dest)
+	{
+		uint32_t opaqueMask = 0;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (!allowTransparency || block[i * 4 + 3] >= 128)
+			{
+				opaqueMask |= 1 << i;
+			}
+		}
+
+		uint16_t endpoints[2] = { 0, 0 };
+		uint32_t indices = 0;
+
+		if (opaqueMask == 0)
+		{
+			// Equal endpoints select the three color mode, index 3 is transparent
+			indices = ~0u;
+		}
+		else
+		{
+			bool hasTransparency = opaqueMask != 0xFFFF;
+
+			float start[4], end[4];
+			FitEndpoints(block, 3, opaqueMask, 1.0f / 16.0f, start, end);
+
+			endpoints[0] = PackRGB565(end);
+			endpoints[1] = PackRGB565(start);
+
+			// The order of the endpoints selects the mode, the first one has to be larger for four colors
+			if (hasTransparency ? endpoints[0] > endpoints[1] : endpoints[0] < endpoints[1])
+			{
+				std::swap(endpoints[0], endpoints[1]);
+			}
+
+			int32_t palette[4][3];
+			UnpackRGB565(endpoints[0], palette[0]);
+			UnpackRGB565(endpoints[1], palette[1]);
+
+			uint32_t paletteSize = 4;
+
+			if (hasTransparency)
+			{
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				}
+
+				paletteSize = 3;
+			}
+			else if (endpoints[0] == endpoints[1])
+			{
+				// NOTE(Peter): BC1 would decode this as the three color mode, so index 3 has to be avoided
+				paletteSize = 1;
+			}
+			else
+			{
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+					palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+				}
+			}
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint32_t index = 3;
+
+				if (opaqueMask & (1 << i))
+				{
+					int32_t bestError = std::numeric_limits<int32_t>::max();
+
+					for (uint32_t entry = 0; entry < paletteSize; entry++)
+					{
+						int32_t error = 0;
+						for (uint32_t c = 0; c < 3; c++)
+						{
+							int32_t difference = block[i * 4 + c] - palette[entry][c];
+							error += difference * difference;
+						}
+
+						if (error < bestError)
+						{
+							bestError = error;
+							index = entry;
+						}
+					}
+				}
+
+				indices |= index << (i * 2);
+			}
+		}
+
+		memcpy(dest, endpoints, sizeof(endpoints));
+		memcpy(dest + 4, &indices, sizeof(indices));
+	}
+
+	static void EncodeSingleChannelBlock(const uint8_t* block, uint32_t channel, std::byte* dest)
+	{
+		uint8_t minimum = 255;
+		uint8_t maximum = 0;
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			minimum = std::min(minimum, block[i * 4 + channel]);
+			maximum = std::max(maximum, block[i * 4 + channel]);
+		}
+
+		// NOTE(Peter): The first endpoint being larger selects the mode with eight values between the endpoints,
+		//              using the exact extremes of the block means they never lose any precision
+		uint64_t bits = uint64_t(maximum) | (uint64_t(minimum) << 8);
+
+		if (maximum != minimum)
+		{
+			int32_t palette[8];
+			palette[0] = maximum;
+			palette[1] = minimum;
+
+			for (int32_t i = 2; i < 8; i++)
+			{
+				palette[i] = ((8 - i) * maximum + (i - 1) * minimum + 3) / 7;
+			}
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint64_t index = 0;
+				int32_t bestError = std::numeric_limits<int32_t>::max();
+
+				for (uint32_t entry = 0; entry < 8; entry++)
+				{
+					int32_t error = std::abs(block[i * 4 + channel] - palette[entry]);
+
+					if (error < bestError)
+					{
+						bestError = error;
+						index = entry;
+					}
+				}
+
+				bits |= index << (16 + i * 3);
+			}
+		}
+
+		memcpy(dest, &bits, 8);
+	}
+
+	void CompressBC1Block(const uint8_t* block, std::byte* dest)
+	{
+		EncodeColorBlock(block, true, dest);
+	}
+
+	void CompressBC3Block(const uint8_t* block, std::byte* dest)
+	{
+		EncodeSingleChannelBlock(block, 3, dest);
+		EncodeColorBlock(block, false, dest + 8);
+	}
+
+	void CompressBC4Block(const uint8_t* block, std::byte* dest)
+	{
+		EncodeSingleChannelBlock(block, 0, dest);
+	}
+
+	void CompressBC5Block(const uint8_t* block, std::byte* dest)
+	{
+		EncodeSingleChannelBlock(block, 0, dest);
+		EncodeSingleChannelBlock(block, 1, dest + 8);
+	}
+
+	// Mode 6 endpoints are 7 bits per channel plus a low bit shared by the whole endpoint, picks whichever shared bit fits better
+	static void QuantizeBC7Endpoint(const float* color, uint32_t* quantized, uint32_t& sharedBit)
+	{
+		float bestError = std::numeric_limits<float>::max();
+
+		for (uint32_t bit = 0; bit < 2; bit++)
+		{
+			uint32_t candidate[4];
+			float error = 0.0f;
+
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				candidate[c] = static_cast<uint32_t>(std::clamp((color[c] - float(bit)) * 0.5f + 0.5f, 0.0f, 127.0f));
+				float difference = float((candidate[c] << 1) | bit) - color[c];
+				error += difference * difference;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				sharedBit = bit;
+				std::copy_n(candidate, 4, quantized);
+			}
+		}
+	}
+
+	void CompressBC7Block(const uint8_t* block, std::byte* dest)
+	{
+		static constexpr int32_t s_Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		// NOTE(Peter): No inset, sixteen values between the endpoints is fine grained enough and insetting would keep sprite edges from ever reaching zero alpha
+		float start[4], end[4];
+		FitEndpoints(block, 4, 0xFFFF, 0.0f, start, end);
+
+		uint32_t endpoints[2][4];
+		uint32_t sharedBits[2];
+		QuantizeBC7Endpoint(start, endpoints[0], sharedBits[0]);
+		QuantizeBC7Endpoint(end, endpoints[1], sharedBits[1]);
+
+		int32_t palette[16][4];
+		for (uint32_t entry = 0; entry < 16; entry++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				int32_t e0 = int32_t((endpoints[0][c] << 1) | sharedBits[0]);
+				int32_t e1 = int32_t((endpoints[1][c] << 1) | sharedBits[1]);
+				palette[entry][c] = ((64 - s_Weights[entry]) * e0 + s_Weights[entry] * e1 + 32) >> 6;
+			}
+		}
+
+		uint32_t indices[16];
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			int32_t bestError = std::numeric_limits<int32_t>::max();
+
+			for (uint32_t entry = 0; entry < 16; entry++)
+			{
+				int32_t error = 0;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					int32_t difference = block[i * 4 + c] - palette[entry][c];
+					error += difference * difference;
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = entry;
+				}
+			}
+		}
+
+		// The first index is stored without its top bit, swapping the endpoints flips every index
+		if (indices[0] & 8)
+		{
+			std::swap(endpoints[0], endpoints[1]);
+			std::swap(sharedBits[0], sharedBits[1]);
+
+			for (auto& index : indices)
+			{
+				index = 15 - index;
+			}
+		}
+
+		uint64_t bits[2] = {};
+		uint32_t bitOffset = 0;
+
+		auto write = [&](uint64_t value, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; i++, bitOffset++)
+			{
+				bits[bitOffset / 64] |= ((value >> i) & 1) << (bitOffset % 64);
+			}
+		};
+
+		write(1 << 6, 7);
+
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			write(endpoints[0][c], 7);
+			write(endpoints[1][c], 7);
+		}
+
+		write(sharedBits[0], 1);
+		write(sharedBits[1], 1);
+
+		write(indices[0], 3);
+		for (uint32_t i = 1; i < 16; i++)
+		{
+			write(indices[i], 4);
+		}
+
+		memcpy(dest, bits, sizeof(bits));
+	}
+
+	void CompressImage(ImageFormat format, const std::byte* rgba, uint32_t width, uint32_t height, std::byte* dest)
+	{
+		YukiAssert(IsBlockCompressed(format));
+
+		void(*compressBlock)(const uint8_t*, std::byte*) = nullptr;
+		uint32_t blockSize = 16;
+
+		switch (format)
+		{
+		case ImageFormat::BC1RGBAUnorm: compressBlock = CompressBC1Block; blockSize = 8; break;
+		case ImageFormat::BC3RGBAUnorm: compressBlock = CompressBC3Block; break;
+		case ImageFormat::BC4RUnorm: compressBlock = CompressBC4Block; blockSize = 8; break;
+		case ImageFormat::BC5RGUnorm: compressBlock = CompressBC5Block; break;
+		case ImageFormat::BC7RGBAUnorm: compressBlock = CompressBC7Block; break;
+		default: return;
+		}
+
+		const auto* pixels = reinterpret_cast<const uint8_t*>(rgba);
+
+		for (uint32_t blockY = 0; blockY < height; blockY += 4)
+		{
+			for (uint32_t blockX = 0; blockX < width; blockX += 4)
+			{
+				uint8_t block[64];
+
+				for (uint32_t y = 0; y < 4; y++)
+				{
+					uint32_t sourceY = std::min(blockY + y, height - 1);
+
+					for (uint32_t x = 0; x < 4; x++)
+					{
+						uint32_t sourceX = std::min(blockX + x, width - 1);
+						memcpy(&block[(y * 4 + x) * 4], &pixels[(uint64_t(sourceY) * width + sourceX) * 4], 4);
+					}
+				}
+
+				compressBlock(block, dest);
+				dest += blockSize;
+			}
+		}
+	}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Engine/RHI/RHI.hpp"
+
+namespace Yuki {
+
+	// CPU block compression for the BC formats. Favours speed over quality, every block gets a single pass of endpoint
+	// fitting along the principal axis of its colors instead of an exhaustive search. BC7 only uses mode 6.
+	namespace TextureCompression {
+
+		// Compresses a tightly packed RGBA8 image into format, dest has to hold CalculateImageSize(format, width, height) bytes.
+		// Blocks along the right and bottom edges repeat the last row / column of pixels if the size isn't a multiple of 4.
+		void CompressImage(ImageFormat format, const std::byte* rgba, uint32_t width, uint32_t height, std::byte* dest);
+
+		void CompressBC1Block(const uint8_t* block, std::byte* dest);
+		void CompressBC3Block(const uint8_t* block, std::byte* dest);
+		void CompressBC4Block(const uint8_t* block, std::byte* dest);
+		void CompressBC5Block(const uint8_t* block, std::byte* dest);
+		void CompressBC7Block(const uint8_t* block, std::byte* dest);
+
+	}
+
+}
@@ -0,0 +1,560 @@
+#include "TextureImporter.hpp"
+#include "TextureCompression.hpp"
+#include "PixelConversion.hpp"
+
+#include "Engine/Core/Hash.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <cstddef>
+#include <cstring>
+
+namespace Yuki {
+
+	static constexpr uint32_t s_CacheMagic = 0x58455459; // YTEX
+	static constexpr uint32_t s_CacheVersion = 3;
+
+	// The pixels start on a cache line, they're copied straight out of the mapped file
+	static constexpr uint64_t s_CachePixelsAlignment = 64;
+
+	// Followed by the mip table and the pixels of every level, exactly as they're laid out in TextureData
+	struct TextureCacheHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+
+		// What the texture was imported from, the cache is stale once any of it changes
+		uint64_t SourceHash;
+		uint64_t SourceSize;
+		int64_t SourceWriteTime;
+		ImageFormat Format;
+		uint32_t Flags;
+
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t MipCount;
+		uint32_t Reserved;
+		uint64_t PixelsOffset;
+	};
+
+	// Large images are processed in bands of full rows of roughly this many pixels, small images are processed in one go
+	static constexpr uint64_t s_BandPixels = 256 * 256;
+
+	static uint32_t GetSettingsFlags(const TextureImportSettings& settings)
+	{
+		return uint32_t(settings.GenerateMips) | (uint32_t(settings.IsSRGB) << 1) | (uint32_t(settings.PremultiplyAlpha) << 2);
+	}
+
+	// Calls func(firstRow, endRow) for every band of rows, spread across the thread pool if there's more than one.
+	// Every band except the last one has a multiple of rowAlignment rows.
+	static void ForEachBand(ThreadPool* threadPool, uint32_t width, uint32_t height, uint32_t rowAlignment, const std::function<void(uint32_t, uint32_t)>& func)
+	{
+		uint32_t rowsPerBand = static_cast<uint32_t>(std::max(s_BandPixels / width, uint64_t(1)));
+		rowsPerBand = (rowsPerBand + rowAlignment - 1) / rowAlignment * rowAlignment;
+
+		uint32_t bandCount = (height + rowsPerBand - 1) / rowsPerBand;
+
+		if (!threadPool || bandCount <= 1)
+		{
+			func(0, height);
+			return;
+		}
+
+		threadPool->ParallelFor(bandCount, [&](uint32_t band)
+		{
+			uint32_t firstRow = band * rowsPerBand;
+			func(firstRow, std::min(firstRow + rowsPerBand, height));
+		});
+	}
+
+	// 2x2 box filter, color is weighted by alpha so fully transparent pixels don't bleed into the edges of sprites.
+	// Only writes the rows in [firstRow, endRow) of dest.
+	static void DownsampleMip(const uint8_t* source, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t* dest, uint32_t width, uint32_t firstRow, uint32_t endRow)
+	{
+		for (uint32_t y = firstRow; y < endRow; y++)
+		{
+			uint32_t sourceRows[2] = { std::min(y * 2, sourceHeight - 1), std::min(y * 2 + 1, sourceHeight - 1) };
+
+			for (uint32_t x = 0; x < width; x++)
+			{
+				uint32_t sourceColumns[2] = { std::min(x * 2, sourceWidth - 1), std::min(x * 2 + 1, sourceWidth - 1) };
+
+				uint32_t weightedColor[3] = {};
+				uint32_t color[3] = {};
+				uint32_t alpha = 0;
+
+				for (uint32_t row : sourceRows)
+				{
+					for (uint32_t column : sourceColumns)
+					{
+						const uint8_t* pixel = &source[(uint64_t(row) * sourceWidth + column) * 4];
+
+						for (uint32_t c = 0; c < 3; c++)
+						{
+							weightedColor[c] += pixel[c] * pixel[3];
+							color[c] += pixel[c];
+						}
+
+						alpha += pixel[3];
+					}
+				}
+
+				uint8_t* result = &dest[(uint64_t(y) * width + x) * 4];
+
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					result[c] = static_cast<uint8_t>(alpha > 0 ? (weightedColor[c] + alpha / 2) / alpha : (color[c] + 2) / 4);
+				}
+
+				result[3] = static_cast<uint8_t>((alpha + 2) / 4);
+			}
+		}
+	}
+
+	// Same filter on linear color
+	static void DownsampleMipLinear(const float32_t* source, uint32_t sourceWidth, uint32_t sourceHeight, float32_t* dest, uint32_t width, uint32_t firstRow, uint32_t endRow)
+	{
+		for (uint32_t y = firstRow; y < endRow; y++)
+		{
+			uint32_t sourceRows[2] = { std::min(y * 2, sourceHeight - 1), std::min(y * 2 + 1, sourceHeight - 1) };
+
+			for (uint32_t x = 0; x < width; x++)
+			{
+				uint32_t sourceColumns[2] = { std::min(x * 2, sourceWidth - 1), std::min(x * 2 + 1, sourceWidth - 1) };
+
+				float32_t weightedColor[3] = {};
+				float32_t color[3] = {};
+				float32_t alpha = 0.0f;
+
+				for (uint32_t row : sourceRows)
+				{
+					for (uint32_t column : sourceColumns)
+					{
+						const float32_t* pixel = &source[(uint64_t(row) * sourceWidth + column) * 4];
+
+						for (uint32_t c = 0; c < 3; c++)
+						{
+							weightedColor[c] += pixel[c] * pixel[3];
+							color[c] += pixel[c];
+						}
+
+						alpha += pixel[3];
+					}
+				}
+
+				float32_t* result = &dest[(uint64_t(y) * width + x) * 4];
+
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					result[c] = alpha > 0.0f ? weightedColor[c] / alpha : color[c] * 0.25f;
+				}
+
+				result[3] = alpha * 0.25f;
+			}
+		}
+	}
+
+	// Converts an RGBA8 level into the texture format. Bands of block compressed levels start on a row of blocks,
+	// so every band is compressed on its own.
+	static void WriteMip(const uint8_t* rgba, uint32_t width, uint32_t height, const TextureImportSettings& settings, std::byte* dest, ThreadPool* threadPool)
+	{
+		bool isCompressed = IsBlockCompressed(settings.Format);
+
+		ForEachBand(threadPool, width, height, isCompressed ? 4 : 1, [&](uint32_t firstRow, uint32_t endRow)
+		{
+			uint64_t firstPixel = uint64_t(firstRow) * width;
+			uint64_t pixelCount = uint64_t(endRow - firstRow) * width;
+			const uint8_t* source = rgba + firstPixel * 4;
+
+			if (!isCompressed)
+			{
+				uint8_t* target = reinterpret_cast<uint8_t*>(dest) + firstPixel * 4;
+
+				if (settings.Format == ImageFormat::BGRA8Unorm)
+				{
+					PixelConversion::SwapRedBlue(source, target, pixelCount);
+				}
+				else
+				{
+					memcpy(target, source, pixelCount * 4);
+				}
+
+				if (settings.PremultiplyAlpha)
+				{
+					PixelConversion::PremultiplyAlpha(target, pixelCount);
+				}
+
+				return;
+			}
+
+			std::vector<uint8_t> premultiplied;
+
+			if (settings.PremultiplyAlpha)
+			{
+				premultiplied.assign(source, source + pixelCount * 4);
+				PixelConversion::PremultiplyAlpha(premultiplied.data(), pixelCount);
+				source = premultiplied.data();
+			}
+
+			TextureCompression::CompressImage(
+				settings.Format, reinterpret_cast<const std::byte*>(source), width, endRow - firstRow,
+				dest + CalculateImageSize(settings.Format, width, firstRow)
+			);
+		});
+	}
+
+	TextureImporter::TextureImporter(std::filesystem::path cacheDirectory)
+		: m_CacheDirectory(std::move(cacheDirectory))
+	{
+	}
+
+	uint64_t TextureImporter::SourceInfo::GetHash()
+	{
+		if (!Hash)
+		{
+			Hash = HashBytes(File.GetBytes().data(), File.GetBytes().size());
+		}
+
+		return *Hash;
+	}
+
+	TextureData TextureImporter::Import(const std::filesystem::path& filepath, const TextureImportSettings& settings, ThreadPool* threadPool) const
+	{
+		SourceInfo source = { .File = LoadAsset(m_AssetPack, filepath) };
+
+		if (!source.File.IsValid())
+		{
+			WriteLine("Can't load image {}, failed to open the file.", filepath.string());
+			return {};
+		}
+
+		// Images read from a pack don't have a write time of their own
+		if (!m_AssetPack || !m_AssetPack->Contains(filepath.lexically_normal().generic_string()))
+		{
+			std::error_code error;
+			source.WriteTime = std::filesystem::last_write_time(filepath, error).time_since_epoch().count();
+		}
+
+		std::filesystem::path cachePath;
+
+		if (!m_CacheDirectory.empty())
+		{
+			cachePath = GetCachePath(filepath, settings);
+
+			auto texture = ReadCache(cachePath, source, settings);
+
+			if (texture.IsValid())
+			{
+				return texture;
+			}
+		}
+
+		auto image = Decode(source.File.GetBytes().data(), source.File.GetBytes().size(), filepath.string(), threadPool);
+
+		if (image.Pixels.empty())
+		{
+			return {};
+		}
+
+		auto texture = Build(image.Pixels.data(), image.Width, image.Height, settings, threadPool);
+
+		if (!cachePath.empty())
+		{
+			WriteCache(cachePath, source, settings, texture);
+		}
+
+		return texture;
+	}
+
+	TextureData TextureImporter::ImportFromMemory(const std::byte* data, uint64_t size, const TextureImportSettings& settings, ThreadPool* threadPool)
+	{
+		auto image = Decode(data, size, "from memory", threadPool);
+
+		if (image.Pixels.empty())
+		{
+			return {};
+		}
+
+		return Build(image.Pixels.data(), image.Width, image.Height, settings, threadPool);
+	}
+
+	std::vector<TextureData> TextureImporter::ImportBatch(Aura::Span<std::filesystem::path> filepaths, const TextureImportSettings& settings, ThreadPool& threadPool) const
+	{
+		std::vector<TextureData> textures(filepaths.Count());
+
+		// NOTE(Peter): The bands of large images go on the same thread pool, whichever thread is free picks them up
+		threadPool.ParallelFor(filepaths.Count(), [&](uint32_t index)
+		{
+			textures[index] = Import(filepaths[index], settings, &threadPool);
+		});
+
+		return textures;
+	}
+
+	TextureData TextureImporter::Build(const std::byte* rgba, uint32_t width, uint32_t height, const TextureImportSettings& settings, ThreadPool* threadPool)
+	{
+		YukiAssert(settings.Format == ImageFormat::RGBA8Unorm || settings.Format == ImageFormat::BGRA8Unorm || IsBlockCompressed(settings.Format));
+
+		TextureData texture =
+		{
+			.Format = settings.IsSRGB ? GetSrgbFormat(settings.Format) : settings.Format,
+			.Width = width,
+			.Height = height,
+		};
+
+		uint32_t mipCount = settings.GenerateMips ? CalculateMipLevelCount(width, height) : 1;
+		uint64_t size = 0;
+
+		for (uint32_t mip = 0; mip < mipCount; mip++)
+		{
+			uint32_t mipWidth = CalculateMipExtent(width, mip);
+			uint32_t mipHeight = CalculateMipExtent(height, mip);
+			uint64_t mipSize = CalculateImageSize(settings.Format, mipWidth, mipHeight);
+
+			texture.Mips.push_back({ mipWidth, mipHeight, size, mipSize });
+			size += mipSize;
+		}
+
+		texture.Pixels.resize(size);
+
+		// Each level is downsampled from the level above it, only the level that was just generated is kept around.
+		// sRGB levels are downsampled from the linear color of the level above and encoded again afterwards.
+		std::vector<std::byte> previousLevel;
+		std::vector<std::byte> currentLevel;
+		std::vector<float32_t> previousLinear;
+		std::vector<float32_t> currentLinear;
+
+		bool isLinearFiltered = settings.IsSRGB && mipCount > 1;
+
+		if (isLinearFiltered)
+		{
+			previousLinear.resize(uint64_t(width) * height * 4);
+
+			ForEachBand(threadPool, width, height, 1, [&](uint32_t firstRow, uint32_t endRow)
+			{
+				uint64_t firstPixel = uint64_t(firstRow) * width;
+				PixelConversion::LinearizeSRGB(reinterpret_cast<const uint8_t*>(rgba) + firstPixel * 4, previousLinear.data() + firstPixel * 4, uint64_t(endRow - firstRow) * width);
+			});
+		}
+
+		for (uint32_t mip = 0; mip < mipCount; mip++)
+		{
+			const auto& mipInfo = texture.Mips[mip];
+			const std::byte* pixels = rgba;
+
+			if (mip > 0)
+			{
+				const auto& parentInfo = texture.Mips[mip - 1];
+				const std::byte* parentPixels = mip == 1 ? rgba : previousLevel.data();
+
+				currentLevel.resize(uint64_t(mipInfo.Width) * mipInfo.Height * 4);
+
+				if (isLinearFiltered)
+				{
+					currentLinear.resize(currentLevel.size());
+				}
+
+				ForEachBand(threadPool, mipInfo.Width, mipInfo.Height, 1, [&](uint32_t firstRow, uint32_t endRow)
+				{
+					auto* dest = reinterpret_cast<uint8_t*>(currentLevel.data());
+
+					if (!isLinearFiltered)
+					{
+						DownsampleMip(reinterpret_cast<const uint8_t*>(parentPixels), parentInfo.Width, parentInfo.Height, dest, mipInfo.Width, firstRow, endRow);
+						return;
+					}
+
+					uint64_t firstPixel = uint64_t(firstRow) * mipInfo.Width;
+					DownsampleMipLinear(previousLinear.data(), parentInfo.Width, parentInfo.Height, currentLinear.data(), mipInfo.Width, firstRow, endRow);
+					PixelConversion::EncodeSRGB(currentLinear.data() + firstPixel * 4, dest + firstPixel * 4, uint64_t(endRow - firstRow) * mipInfo.Width);
+				});
+
+				std::swap(previousLevel, currentLevel);
+				std::swap(previousLinear, currentLinear);
+				pixels = previousLevel.data();
+			}
+
+			WriteMip(reinterpret_cast<const uint8_t*>(pixels), mipInfo.Width, mipInfo.Height, settings, texture.Pixels.data() + mipInfo.Offset, threadPool);
+		}
+
+		return texture;
+	}
+
+	TextureImporter::SourceImage TextureImporter::Decode(const std::byte* data, uint64_t size, std::string_view name, ThreadPool* threadPool)
+	{
+		// NOTE(Peter): Decoded with as many channels as the file has, expanding to RGBA8 is done in bands afterwards
+		//              which is a lot faster than letting stb_image do it one pixel at a time
+		int32_t width, height, channels;
+		stbi_uc* pixels = stbi_load_from_memory(
+			reinterpret_cast<const stbi_uc*>(data),
+			static_cast<int32_t>(size),
+			&width, &height, &channels, 0
+		);
+
+		if (!pixels)
+		{
+			WriteLine("Can't load image {}, {}.", LogLevel::Warn, name, stbi_failure_reason());
+			return {};
+		}
+
+		YukiAssert(width > 0 && height > 0 && channels >= 1 && channels <= 4);
+
+		SourceImage image =
+		{
+			.Width = static_cast<uint32_t>(width),
+			.Height = static_cast<uint32_t>(height),
+		};
+
+		image.Pixels.resize(uint64_t(image.Width) * image.Height * 4);
+
+		ForEachBand(threadPool, image.Width, image.Height, 1, [&](uint32_t firstRow, uint32_t endRow)
+		{
+			uint64_t firstPixel = uint64_t(firstRow) * image.Width;
+			uint64_t pixelCount = uint64_t(endRow - firstRow) * image.Width;
+
+			const uint8_t* source = pixels + firstPixel * channels;
+			auto* dest = reinterpret_cast<uint8_t*>(image.Pixels.data()) + firstPixel * 4;
+
+			switch (channels)
+			{
+			case 1: PixelConversion::ExpandGreyToRGBA(source, dest, pixelCount); break;
+			case 2: PixelConversion::ExpandGreyAlphaToRGBA(source, dest, pixelCount); break;
+			case 3: PixelConversion::ExpandRGBToRGBA(source, dest, pixelCount); break;
+			case 4: memcpy(dest, source, pixelCount * 4); break;
+			}
+		});
+
+		stbi_image_free(pixels);
+		return image;
+	}
+
+	std::filesystem::path TextureImporter::GetCachePath(const std::filesystem::path& filepath, const TextureImportSettings& settings) const
+	{
+		auto sourcePath = std::filesystem::absolute(filepath).generic_string();
+		uint64_t settingsKey = (static_cast<uint64_t>(settings.Format) << 3) | GetSettingsFlags(settings);
+		uint64_t key = HashBytes(sourcePath.data(), sourcePath.size(), settingsKey);
+
+		return m_CacheDirectory / std::format("{}-{:016x}.ytex", filepath.stem().string(), key);
+	}
+
+	TextureData TextureImporter::ReadCache(const std::filesystem::path& cachePath, SourceInfo& source, const TextureImportSettings& settings)
+	{
+		TextureCacheHeader header;
+
+		if (!FileIO::ReadBinary(cachePath, 0, { reinterpret_cast<std::byte*>(&header), sizeof(header) }))
+		{
+			return {};
+		}
+
+		if (header.Magic != s_CacheMagic || header.Version != s_CacheVersion ||
+			header.Format != settings.Format || header.Flags != GetSettingsFlags(settings) ||
+			header.SourceSize != source.File.GetBytes().size())
+		{
+			return {};
+		}
+
+		// NOTE(Peter): Copying or checking out the source changes its write time but rarely its contents, so
+		//              the source is only hashed if its write time doesn't match anymore. The new write time is
+		//              stored after a hash hit, otherwise every launch would hash the source again.
+		//              The header is patched before the cache is mapped, Windows won't open a mapped file for writing.
+		if (header.SourceWriteTime != source.WriteTime)
+		{
+			if (header.SourceHash != source.GetHash())
+			{
+				return {};
+			}
+
+			if (source.WriteTime)
+			{
+				int64_t writeTime = *source.WriteTime;
+
+				std::fstream stream(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+				stream.seekp(offsetof(TextureCacheHeader, SourceWriteTime));
+				stream.write(reinterpret_cast<const char*>(&writeTime), sizeof(writeTime));
+				stream.close();
+
+				if (stream)
+				{
+					header.SourceWriteTime = writeTime;
+				}
+				else
+				{
+					WriteLine("Failed to update the source write time in texture cache {}.", LogLevel::Warn, cachePath.string());
+				}
+			}
+		}
+
+		auto file = FileIO::MapFile(cachePath);
+
+		// NOTE(Peter): Another import may have replaced the cache in between, only the header that was checked above is trusted
+		if (!file.IsValid() || file.GetSize() < sizeof(TextureCacheHeader) || memcmp(&header, file.GetData(), sizeof(header)) != 0)
+		{
+			return {};
+		}
+
+		uint64_t mipTableEnd = sizeof(header) + uint64_t(header.MipCount) * sizeof(TextureMip);
+
+		if (header.MipCount == 0 || mipTableEnd > file.GetSize() || header.PixelsOffset < mipTableEnd)
+		{
+			return {};
+		}
+
+		TextureData texture =
+		{
+			.Format = settings.IsSRGB ? GetSrgbFormat(header.Format) : header.Format,
+			.Width = header.Width,
+			.Height = header.Height,
+		};
+
+		texture.Mips.resize(header.MipCount);
+		memcpy(texture.Mips.data(), file.GetData() + sizeof(header), texture.Mips.size() * sizeof(TextureMip));
+
+		if (header.PixelsOffset + texture.GetPixelsSize() > file.GetSize())
+		{
+			WriteLine("Texture cache {} is truncated, importing the texture again.", LogLevel::Warn, cachePath.string());
+			return {};
+		}
+
+		texture.CacheFile = std::move(file);
+		texture.CacheFileOffset = header.PixelsOffset;
+		return texture;
+	}
+
+	void TextureImporter::WriteCache(const std::filesystem::path& cachePath, SourceInfo& source, const TextureImportSettings& settings, const TextureData& texture)
+	{
+		uint64_t mipTableEnd = sizeof(TextureCacheHeader) + texture.Mips.size() * sizeof(TextureMip);
+		uint64_t pixelsOffset = (mipTableEnd + s_CachePixelsAlignment - 1) & ~(s_CachePixelsAlignment - 1);
+
+		TextureCacheHeader header =
+		{
+			.Magic = s_CacheMagic,
+			.Version = s_CacheVersion,
+			.SourceHash = source.GetHash(),
+			.SourceSize = source.File.GetBytes().size(),
+			.SourceWriteTime = source.WriteTime.value_or(0),
+			.Format = settings.Format,
+			.Flags = GetSettingsFlags(settings),
+			.Width = texture.Width,
+			.Height = texture.Height,
+			.MipCount = static_cast<uint32_t>(texture.Mips.size()),
+			.Reserved = 0,
+			.PixelsOffset = pixelsOffset,
+		};
+
+		// The padding between the mip table and the pixels stays zeroed
+		std::vector<std::byte> bytes(pixelsOffset + texture.GetPixelsSize());
+		memcpy(bytes.data(), &header, sizeof(header));
+		memcpy(bytes.data() + sizeof(header), texture.Mips.data(), texture.Mips.size() * sizeof(TextureMip));
+		memcpy(bytes.data() + pixelsOffset, texture.GetPixels(), texture.GetPixelsSize());
+
+		// NOTE(Peter): Replaced atomically so a concurrent import of the same texture never reads a partially written file.
+		//              Fails if another thread has the old cache file mapped on platforms that don't allow replacing it,
+		//              the next import tries again.
+		if (!FileIO::WriteFileAtomic(cachePath, bytes))
+		{
+			WriteLine("Failed to write texture cache {}.", LogLevel::Warn, cachePath.string());
+		}
+	}
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Engine/RHI/RHI.hpp"
+#include "Engine/IO/AssetPack.hpp"
+#include "Engine/IO/FileIO.hpp"
+#include "Engine/Core/ThreadPool.hpp"
+
+#include <filesystem>
+#include <optional>
+
+namespace Yuki {
+
+	struct TextureImportSettings
+	{
+		// RGBA8Unorm, BGRA8Unorm or one of the block compressed Unorm formats, the texture gets its sRGB variant if IsSRGB is set
+		ImageFormat Format = ImageFormat::RGBA8Unorm;
+
+		// Generates every level down to 1x1
+		bool GenerateMips = false;
+
+		// The color is sRGB encoded, mips are filtered in linear space so they don't get darker than the image they're made from
+		bool IsSRGB = false;
+
+		// Color is multiplied by alpha after the mips are generated, before the texture is compressed
+		bool PremultiplyAlpha = false;
+	};
+
+	struct TextureMip
+	{
+		uint32_t Width;
+		uint32_t Height;
+
+		// Into TextureData::GetPixels
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	// Pixels ready to be copied into an image, every mip level is tightly packed right after the previous one
+	struct TextureData
+	{
+		ImageFormat Format = ImageFormat::None;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<TextureMip> Mips;
+
+		// Empty if the texture was loaded from the cache, the pixels are read straight out of the mapped cache file instead
+		std::vector<std::byte> Pixels;
+		FileIO::MappedFile CacheFile;
+		uint64_t CacheFileOffset = 0;
+
+		bool IsValid() const { return !Mips.empty(); }
+
+		const std::byte* GetPixels() const { return CacheFile.IsValid() ? CacheFile.GetData() + CacheFileOffset : Pixels.data(); }
+		uint64_t GetPixelsSize() const { return IsValid() ? Mips.back().Offset + Mips.back().Size : 0; }
+	};
+
+	// Decodes image files and turns them into the format they'll be sampled in, generating mips and block compressing them
+	// if asked to. The results are cached on disk, loading a cached texture maps the cache file and does no work on the pixels.
+	// Large images are split into bands of rows that are converted, downsampled and compressed in parallel if there's a thread pool.
+	// NOTE(Peter): Import is thread safe, textures are meant to be imported on worker threads
+	class TextureImporter
+	{
+	public:
+		// Doesn't cache anything
+		TextureImporter() = default;
+
+		// Every source file and import settings combination gets a cache file in cacheDirectory. It's reused for as long as the
+		// source file has the same contents, the source file is only hashed again if its size or last write time changed.
+		explicit TextureImporter(std::filesystem::path cacheDirectory);
+
+		// Returns invalid texture data if the file couldn't be decoded. Can be called from a job running on threadPool.
+		TextureData Import(const std::filesystem::path& filepath, const TextureImportSettings& settings, ThreadPool* threadPool = nullptr) const;
+
+		// Decodes an image that's already in memory, e.g. one embedded in a model. Never cached.
+		static TextureData ImportFromMemory(const std::byte* data, uint64_t size, const TextureImportSettings& settings, ThreadPool* threadPool = nullptr);
+
+		// Imports every file concurrently, the results are in the same order as filepaths
+		std::vector<TextureData> ImportBatch(Aura::Span<std::filesystem::path> filepaths, const TextureImportSettings& settings, ThreadPool& threadPool) const;
+
+		// Builds the texture from tightly packed RGBA8 pixels
+		static TextureData Build(const std::byte* rgba, uint32_t width, uint32_t height, const TextureImportSettings& settings, ThreadPool* threadPool = nullptr);
+
+		const std::filesystem::path& GetCacheDirectory() const { return m_CacheDirectory; }
+
+		// Images are read from pack before the filesystem, the pack has to outlive the importer or be unset
+		void SetAssetPack(const AssetPack* pack) { m_AssetPack = pack; }
+
+	private:
+		struct SourceInfo
+		{
+			PackedAsset File;
+
+			// Unknown for images read from a pack, their cache is only reused if the hash matches
+			std::optional<int64_t> WriteTime;
+
+			// Only calculated once it's needed
+			std::optional<uint64_t> Hash;
+
+			uint64_t GetHash();
+		};
+
+		// Decoded and expanded to RGBA8, empty if decoding failed
+		struct SourceImage
+		{
+			std::vector<std::byte> Pixels;
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+		};
+
+	private:
+		std::filesystem::path GetCachePath(const std::filesystem::path& filepath, const TextureImportSettings& settings) const;
+
+		// name is only used for reporting errors
+		static SourceImage Decode(const std::byte* data, uint64_t size, std::string_view name, ThreadPool* threadPool);
+
+		static TextureData ReadCache(const std::filesystem::path& cachePath, SourceInfo& source, const TextureImportSettings& settings);
+		static void WriteCache(const std::filesystem::path& cachePath, SourceInfo& source, const TextureImportSettings& settings, const TextureData& texture);
+
+	private:
+		std::filesystem::path m_CacheDirectory;
+		const AssetPack* m_AssetPack = nullptr;
+	};
+
+}
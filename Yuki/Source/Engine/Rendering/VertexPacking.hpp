@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Engine/Core/Core.hpp"
+
+namespace Yuki {
+
+	// Conversions used to shrink vertex attributes before they're uploaded
+
+	inline uint16_t FloatToHalf(float32_t value)
+	{
+		uint32_t bits = std::bit_cast<uint32_t>(value);
+		uint32_t sign = (bits >> 16) & 0x8000;
+		int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFF;
+
+		if (exponent <= 0)
+		{
+			// Too small to be represented as a normal half, flush to (signed) zero
+			return static_cast<uint16_t>(sign);
+		}
+
+		if (((bits >> 23) & 0xFF) == 0xFF && mantissa != 0)
+		{
+			// NaN, keeps the top mantissa bits and sets the quiet bit so it doesn't turn into infinity
+			return static_cast<uint16_t>(sign | 0x7E00 | (mantissa >> 13));
+		}
+
+		if (exponent >= 31)
+		{
+			// Clamp to infinity
+			return static_cast<uint16_t>(sign | 0x7C00);
+		}
+
+		// Round to nearest, the carry can correctly overflow into the exponent
+		uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+		return static_cast<uint16_t>(half + ((mantissa >> 12) & 1));
+	}
+
+	inline uint16_t FloatToFixed12x4(float32_t value)
+	{
+		auto fixed = static_cast<int32_t>(std::round(value * 16.0f));
+		return static_cast<uint16_t>(static_cast<int16_t>(std::clamp(fixed, -32768, 32767)));
+	}
+
+	inline uint16_t FloatToUnorm16(float32_t value)
+	{
+		return static_cast<uint16_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+	}
+
+	inline uint32_t Pack2x16(uint16_t x, uint16_t y)
+	{
+		return static_cast<uint32_t>(x) | (static_cast<uint32_t>(y) << 16);
+	}
+
+	// Signed normalized 10:10:10:2, w is always 0
+	inline uint32_t PackSnorm10x3(float32_t x, float32_t y, float32_t z)
+	{
+		auto pack = [](float32_t value)
+		{
+			auto snorm = static_cast<int32_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 511.0f));
+			return static_cast<uint32_t>(snorm) & 0x3FF;
+		};
+
+		return pack(x) | (pack(y) << 10) | (pack(z) << 20);
+	}
+
+}
@@ -0,0 +1,209 @@
+#include "WindowsCommon.hpp"
+
+#include "Engine/IO/FileIO.hpp"
+
+#include <optional>
+
+namespace Yuki::FileIO {
+
+	MappedFile::Mapping::~Mapping()
+	{
+		if (Data)
+		{
+			UnmapViewOfFile(Data);
+		}
+
+		if (Section)
+		{
+			CloseHandle(Section);
+		}
+
+		if (File)
+		{
+			CloseHandle(File);
+		}
+	}
+
+	MappedFile MapFile(const std::filesystem::path& filepath)
+	{
+		// NOTE(Peter): Other processes can still read the file, and replace it once we're done with it
+		HANDLE file = CreateFileW(
+			filepath.c_str(),
+			GENERIC_READ,
+			FILE_SHARE_READ | FILE_SHARE_DELETE,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr
+		);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return {};
+		}
+
+		auto mapping = std::make_shared<MappedFile::Mapping>();
+		mapping->File = file;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			return {};
+		}
+
+		mapping->Size = static_cast<uint64_t>(size.QuadPart);
+
+		// Empty files can't be mapped
+		if (mapping->Size > 0)
+		{
+			mapping->Section = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+			if (!mapping->Section)
+			{
+				return {};
+			}
+
+			mapping->Data = static_cast<const std::byte*>(MapViewOfFile(mapping->Section, FILE_MAP_READ, 0, 0, 0));
+
+			if (!mapping->Data)
+			{
+				return {};
+			}
+		}
+
+		MappedFile result;
+		result.m_Data = mapping->Data;
+		result.m_Size = mapping->Size;
+		result.m_Mapping = std::move(mapping);
+		return result;
+	}
+
+	// Closes the handle when it goes out of scope
+	struct ScopedFileHandle
+	{
+		HANDLE Handle;
+
+		~ScopedFileHandle()
+		{
+			if (Handle != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(Handle);
+			}
+		}
+	};
+
+	static HANDLE OpenForReading(const std::filesystem::path& filepath)
+	{
+		return CreateFileW(
+			filepath.c_str(),
+			GENERIC_READ,
+			FILE_SHARE_READ | FILE_SHARE_DELETE,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+			nullptr
+		);
+	}
+
+	// Reads until size bytes have been read or the file ends, returns how many bytes were read or nothing if a read failed
+	static std::optional<uint64_t> ReadFully(HANDLE file, std::byte* dest, uint64_t size)
+	{
+		uint64_t total = 0;
+
+		while (total < size)
+		{
+			// ReadFile takes 32-bit sizes
+			auto chunkSize = static_cast<DWORD>(std::min<uint64_t>(size - total, 1ull << 30));
+			DWORD bytesRead = 0;
+
+			if (!ReadFile(file, dest + total, chunkSize, &bytesRead, nullptr))
+			{
+				return std::nullopt;
+			}
+
+			total += bytesRead;
+
+			// A short read means the end of the file, no need to make another call to find out
+			if (bytesRead < chunkSize)
+			{
+				break;
+			}
+		}
+
+		return total;
+	}
+
+	template<typename Container>
+	static bool ReadWholeFile(const std::filesystem::path& filepath, Container& outData)
+	{
+		ScopedFileHandle file = { OpenForReading(filepath) };
+
+		if (file.Handle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		uint64_t sizeHint = GetFileSizeEx(file.Handle, &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+
+		// NOTE(Peter): One byte more than the file claims to have, so the first read already hits the end of the file
+		outData.resize(sizeHint + 1);
+		uint64_t total = 0;
+
+		// Loops again if the file grew after its size was queried
+		do
+		{
+			if (total == outData.size())
+			{
+				outData.resize(outData.size() * 2);
+			}
+
+			auto bytesRead = ReadFully(file.Handle, reinterpret_cast<std::byte*>(outData.data()) + total, outData.size() - total);
+
+			// NOTE(Peter): A failed read isn't the end of the file, callers would silently use the partial contents otherwise
+			if (!bytesRead)
+			{
+				DWORD error = GetLastError();
+				WriteLine("Failed to read {}, error {}.", LogLevel::Warn, filepath.string(), error);
+				outData = {};
+				return false;
+			}
+
+			total += *bytesRead;
+		} while (total == outData.size());
+
+		outData.resize(total);
+		return true;
+	}
+
+	bool ReadText(const std::filesystem::path& filepath, std::string& outString)
+	{
+		return ReadWholeFile(filepath, outString);
+	}
+
+	bool ReadBinary(const std::filesystem::path& filepath, std::vector<std::byte>& outData)
+	{
+		return ReadWholeFile(filepath, outData);
+	}
+
+	bool ReadBinary(const std::filesystem::path& filepath, uint64_t offset, std::span<std::byte> outData)
+	{
+		ScopedFileHandle file = { OpenForReading(filepath) };
+
+		if (file.Handle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER distance;
+		distance.QuadPart = static_cast<LONGLONG>(offset);
+
+		if (offset > 0 && !SetFilePointerEx(file.Handle, distance, nullptr, FILE_BEGIN))
+		{
+			return false;
+		}
+
+		return ReadFully(file.Handle, outData.data(), outData.size()) == outData.size();
+	}
+
+}
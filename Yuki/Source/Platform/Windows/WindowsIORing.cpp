@@ -0,0 +1,239 @@
+#include "WindowsCommon.hpp"
+
+#include "Engine/IO/IOBackend.hpp"
+
+#include <ioringapi.h>
+
+namespace Yuki {
+
+	// NOTE(Peter): IoRing only exists since Windows 11, so it's loaded at runtime instead of linked against. Otherwise the
+	//              engine wouldn't start on Windows 10 at all.
+	struct IORingFunctions
+	{
+		decltype(&QueryIoRingCapabilities) QueryCapabilities = nullptr;
+		decltype(&CreateIoRing) Create = nullptr;
+		decltype(&CloseIoRing) Close = nullptr;
+		decltype(&BuildIoRingReadFile) BuildReadFile = nullptr;
+		decltype(&SubmitIoRing) Submit = nullptr;
+		decltype(&PopIoRingCompletion) PopCompletion = nullptr;
+
+		bool Load()
+		{
+			HMODULE module = GetModuleHandleW(L"kernelbase.dll");
+
+			if (!module)
+			{
+				return false;
+			}
+
+			QueryCapabilities = reinterpret_cast<decltype(QueryCapabilities)>(GetProcAddress(module, "QueryIoRingCapabilities"));
+			Create = reinterpret_cast<decltype(Create)>(GetProcAddress(module, "CreateIoRing"));
+			Close = reinterpret_cast<decltype(Close)>(GetProcAddress(module, "CloseIoRing"));
+			BuildReadFile = reinterpret_cast<decltype(BuildReadFile)>(GetProcAddress(module, "BuildIoRingReadFile"));
+			Submit = reinterpret_cast<decltype(Submit)>(GetProcAddress(module, "SubmitIoRing"));
+			PopCompletion = reinterpret_cast<decltype(PopCompletion)>(GetProcAddress(module, "PopIoRingCompletion"));
+
+			return QueryCapabilities && Create && Close && BuildReadFile && Submit && PopCompletion;
+		}
+	};
+
+	// Submits a whole batch of reads with a single call into the kernel and waits for all of them at once
+	class IORingBackend final : public IOBackend
+	{
+	public:
+		IORingBackend(const IORingFunctions& functions, IORING_VERSION version, uint32_t maxReadsInFlight)
+			: m_Functions(functions), m_Version(version), m_MaxReadsInFlight(maxReadsInFlight)
+		{
+			CreateRing();
+		}
+
+		~IORingBackend() override
+		{
+			if (m_Ring)
+			{
+				m_Functions.Close(m_Ring);
+			}
+		}
+
+		bool IsValid() const { return m_Ring != nullptr; }
+
+		std::string_view GetName() const override { return "IoRing"; }
+
+		void Read(std::span<IOReadOperation> operations) override
+		{
+			// Every read fails if the ring couldn't be replaced after a failed submit
+			if (!m_Ring)
+			{
+				return;
+			}
+
+			std::vector<HANDLE> files(operations.size(), INVALID_HANDLE_VALUE);
+			uint32_t submitCount = 0;
+
+			for (uint32_t i = 0; i < operations.size(); i++)
+			{
+				auto& operation = operations[i];
+
+				// NOTE(Peter): Reads are no larger than 4GB, larger ones fail rather than being split up
+				if (operation.Size > std::numeric_limits<UINT32>::max())
+				{
+					continue;
+				}
+
+				files[i] = CreateFileW(
+					operation.Filepath->c_str(),
+					GENERIC_READ,
+					FILE_SHARE_READ | FILE_SHARE_DELETE,
+					nullptr,
+					OPEN_EXISTING,
+					FILE_ATTRIBUTE_NORMAL,
+					nullptr
+				);
+
+				if (files[i] == INVALID_HANDLE_VALUE)
+				{
+					continue;
+				}
+
+				if (operation.Size == 0)
+				{
+					operation.Succeeded = true;
+					continue;
+				}
+
+				HRESULT result = m_Functions.BuildReadFile(
+					m_Ring,
+					IoRingHandleRefFromHandle(files[i]),
+					IoRingBufferRefFromPointer(operation.Destination),
+					static_cast<UINT32>(operation.Size),
+					operation.Offset,
+					i,
+					IOSQE_FLAGS_NONE
+				);
+
+				if (SUCCEEDED(result))
+				{
+					submitCount++;
+				}
+			}
+
+			if (submitCount > 0)
+			{
+				UINT32 submittedCount = 0;
+				HRESULT result = m_Functions.Submit(m_Ring, submitCount, INFINITE, &submittedCount);
+
+				uint32_t completedCount = 0;
+				auto popCompletions = [&]
+				{
+					IORING_CQE completion;
+
+					while (m_Functions.PopCompletion(m_Ring, &completion) == S_OK)
+					{
+						completedCount++;
+
+						if (completion.UserData >= operations.size())
+						{
+							continue;
+						}
+
+						auto& operation = operations[completion.UserData];
+						operation.BytesRead = completion.Information;
+						operation.Succeeded = SUCCEEDED(completion.ResultCode) && completion.Information == operation.Size;
+					}
+				};
+
+				if (FAILED(result))
+				{
+					WriteLine("Failed to submit {} reads to the IO ring, HRESULT {:#x}.", LogLevel::Error, submitCount, static_cast<uint32_t>(result));
+
+					// NOTE(Peter): The reads that did go out are still writing into their destinations and using the file handles,
+					//              so we wait for them. The ones that didn't are left in the submission queue and would go out with
+					//              the next batch, so the ring is replaced afterwards.
+					while (completedCount < submittedCount)
+					{
+						popCompletions();
+
+						if (completedCount < submittedCount)
+						{
+							Sleep(1);
+						}
+					}
+
+					m_Functions.Close(m_Ring);
+					m_Ring = nullptr;
+
+					if (!CreateRing())
+					{
+						WriteLine("Failed to replace the IO ring, every read from now on fails.", LogLevel::Error);
+					}
+				}
+				else
+				{
+					popCompletions();
+				}
+			}
+
+			for (HANDLE file : files)
+			{
+				if (file != INVALID_HANDLE_VALUE)
+				{
+					CloseHandle(file);
+				}
+			}
+		}
+
+	private:
+		bool CreateRing()
+		{
+			IORING_CREATE_FLAGS flags =
+			{
+				.Required = IORING_CREATE_REQUIRED_FLAGS_NONE,
+				.Advisory = IORING_CREATE_ADVISORY_FLAGS_NONE,
+			};
+
+			// NOTE(Peter): The completion queue has room for every read in a batch, so completions never have to be dropped
+			if (FAILED(m_Functions.Create(m_Version, flags, m_MaxReadsInFlight, m_MaxReadsInFlight * 2, &m_Ring)))
+			{
+				m_Ring = nullptr;
+				return false;
+			}
+
+			return true;
+		}
+
+	private:
+		IORingFunctions m_Functions;
+		IORING_VERSION m_Version;
+		uint32_t m_MaxReadsInFlight;
+		HIORING m_Ring = nullptr;
+	};
+
+	IOBackend* CreatePlatformIOBackend(uint32_t maxReadsInFlight)
+	{
+		IORingFunctions functions;
+
+		if (!functions.Load())
+		{
+			return nullptr;
+		}
+
+		IORING_CAPABILITIES capabilities;
+
+		if (FAILED(functions.QueryCapabilities(&capabilities)) || capabilities.MaxVersion < IORING_VERSION_1 ||
+			capabilities.MaxSubmissionQueueSize < maxReadsInFlight)
+		{
+			return nullptr;
+		}
+
+		auto* backend = new IORingBackend(functions, capabilities.MaxVersion, maxReadsInFlight);
+
+		if (!backend->IsValid())
+		{
+			delete backend;
+			return nullptr;
+		}
+
+		return backend;
+	}
+
+}
@@ -24,6 +24,8 @@ project "Yuki"
 		"../ThirdParty/rtmcpp/rtm/includes/",
 		"../ThirdParty/stb/",
 		"../ThirdParty/wooting/includes-cpp/",
+		"../ThirdParty/fastgltf/include/",
+		"../ThirdParty/simdjson/include/",
 	}
 
 	forceincludes {
@@ -40,9 +42,14 @@ project "Yuki"
     }
 
     links {
-        "wooting_analog_wrapper"
+        "wooting_analog_wrapper",
+        "fastgltf",
+        "simdjson",
     }
 
+	filter { "files:Source/Engine/Rendering/**AVX2.cpp" }
+		vectorextensions "AVX2"
+
     filter { "system:windows" }
 		defines {
 			"YUKI_PLATFORM_WINDOWS"
@@ -1,3 +1,14 @@
+newoption {
+	trigger = "rhi",
+	value = "Backend",
+	description = "RHI backend the applications link against",
+	default = "vulkan",
+	allowed = {
+		{ "vulkan", "Vulkan" },
+		{ "null", "Null (no GPU work, for measuring engine CPU overhead)" },
+	}
+}
+
 workspace "Yuki"
 	configurations { "RelWithDebug", "Debug", "Release" }
 	architecture "x86_64"
@@ -58,7 +69,10 @@ workspace "Yuki"
 
 include "Yuki/"
 include "Yuki-Vulkan/"
+include "Yuki-Null/"
 include "EngineTester/"
+include "AssetPacker/"
+include "FileIOBenchmark/"
 
 group "ThirdParty"
     include "ThirdParty/"